@@ -25,7 +25,11 @@ UndoManager::UndoManager(QObject *parent) :
 void UndoManager::addNewUndoStack()
 {
     undoStacks.emplace_back(new QUndoStack);
-    addStack(undoStacks.back().get());
+    QUndoStack *stack = undoStacks.back().get();
+    addStack(stack);
+
+    connect(stack, &QUndoStack::cleanChanged, this,
+            [=](bool clean) { emit stackCleanChanged(stack, clean); });
 }
 
 void UndoManager::setActiveStackIndex(int index)
@@ -51,17 +55,21 @@ void UndoManager::push(QUndoCommand *cmd, int affectedSystem)
 {
     beginMacro(cmd->actionText());
 
+    // The command can only be undone or redone on the stack that it is
+    // pushed to, even if another stack is active by then.
+    QUndoStack *stack = activeStack();
+
     auto onUndo = new SignalOnUndo();
     if (affectedSystem >= 0)
     {
         connect(onUndo, &SignalOnUndo::triggered, [=]() {
-            onSystemChanged(affectedSystem);
+            onSystemChanged(stack, affectedSystem);
         });
     }
     else
     {
-        connect(onUndo, &SignalOnUndo::triggered, this,
-                &UndoManager::fullRedrawNeeded);
+        connect(onUndo, &SignalOnUndo::triggered,
+                [=]() { onScoreChanged(stack); });
     }
 
     push(onUndo);
@@ -71,13 +79,13 @@ void UndoManager::push(QUndoCommand *cmd, int affectedSystem)
     if (affectedSystem >= 0)
     {
         connect(onRedo, &SignalOnRedo::triggered, [=]() {
-            onSystemChanged(affectedSystem);
+            onSystemChanged(stack, affectedSystem);
         });
     }
     else
     {
-        connect(onRedo, &SignalOnRedo::triggered, this,
-                &UndoManager::fullRedrawNeeded);
+        connect(onRedo, &SignalOnRedo::triggered,
+                [=]() { onScoreChanged(stack); });
     }
 
     push(onRedo);
@@ -89,9 +97,16 @@ void UndoManager::setClean()
     activeStack()->setClean();
 }
 
-void UndoManager::onSystemChanged(int affectedSystem)
+void UndoManager::onSystemChanged(QUndoStack *stack, int affectedSystem)
 {
     emit redrawNeeded(affectedSystem);
+    emit systemChanged(stack, affectedSystem);
+}
+
+void UndoManager::onScoreChanged(QUndoStack *stack)
+{
+    emit fullRedrawNeeded();
+    emit scoreChanged(stack);
 }
 
 void UndoManager::beginMacro(const QString &text)
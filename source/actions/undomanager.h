@@ -52,11 +52,22 @@ signals:
     void fullRedrawNeeded();
     void redrawNeeded(int);
 
+    /// Emitted when a command that modifies a system is done or undone on
+    /// the given stack.
+    void systemChanged(QUndoStack *stack, int system);
+    /// Emitted when a command that modifies the entire score is done or
+    /// undone on the given stack.
+    void scoreChanged(QUndoStack *stack);
+    /// Emitted when the clean state of any stack changes. Unlike
+    /// cleanChanged(), this isn't limited to the active stack.
+    void stackCleanChanged(QUndoStack *stack, bool clean);
+
 private:
     /// Pushes the QUndoCommand onto the active stack.
     void push(QUndoCommand *cmd);
 
-    void onSystemChanged(int affectedSystem);
+    void onSystemChanged(QUndoStack *stack, int affectedSystem);
+    void onScoreChanged(QUndoStack *stack);
 
     std::vector<std::unique_ptr<QUndoStack>> undoStacks;
 };
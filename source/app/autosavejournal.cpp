@@ -0,0 +1,506 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "autosavejournal.h"
+
+#include <algorithm>
+#include <array>
+#include <boost/crc.hpp>
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem/detail/utf8_codecvt_facet.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <score/score.h>
+#include <score/serialization.h>
+#include <sstream>
+#include <stdexcept>
+
+const int AutosaveJournal::CHECKPOINT_INTERVAL = 100;
+
+static const char *theLockFilename = "lock";
+static const char *theDocumentFilename = "document.txt";
+static const std::string theCheckpointPrefix = "checkpoint-";
+static const std::string theCheckpointExtension = ".json";
+static const std::string theSegmentPrefix = "journal-";
+static const std::string theSegmentExtension = ".log";
+
+/// Marks the start of a segment which cannot be replayed on top of the
+/// previous segment, since the score was changed in a way that was not
+/// journaled.
+static const int32_t theDiscontinuity = -1;
+
+/// Each record has a header containing the payload size, a checksum of the
+/// system index and payload, and the system index.
+static const size_t theRecordHeaderSize = 3 * sizeof(uint32_t);
+
+namespace
+{
+using path = boost::filesystem::path;
+
+path getCheckpointPath(const path &dir, int generation)
+{
+    return dir / (theCheckpointPrefix + std::to_string(generation) +
+                  theCheckpointExtension);
+}
+
+path getSegmentPath(const path &dir, int generation)
+{
+    return dir / (theSegmentPrefix + std::to_string(generation) +
+                  theSegmentExtension);
+}
+
+/// Returns the generation number from a checkpoint or segment filename.
+std::optional<int> parseGeneration(const path &filename,
+                                   const std::string &prefix,
+                                   const std::string &extension)
+{
+    const std::string name = filename.filename().string();
+    if (name.size() <= prefix.size() + extension.size() ||
+        name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - extension.size(), extension.size(),
+                     extension) != 0)
+    {
+        return std::nullopt;
+    }
+
+    const std::string number = name.substr(
+        prefix.size(), name.size() - prefix.size() - extension.size());
+    if (!std::all_of(number.begin(), number.end(), ::isdigit))
+        return std::nullopt;
+
+    return std::stoi(number);
+}
+
+/// Returns the generation of the most recent checkpoint in the journal.
+std::optional<int> findLatestCheckpoint(const path &journal_dir)
+{
+    std::optional<int> generation;
+    for (auto &entry : boost::filesystem::directory_iterator(journal_dir))
+    {
+        auto gen = parseGeneration(entry.path(), theCheckpointPrefix,
+                                   theCheckpointExtension);
+        if (gen && (!generation || *gen > *generation))
+            generation = gen;
+    }
+
+    return generation;
+}
+
+uint32_t computeChecksum(int32_t system_index, const std::string &data)
+{
+    const int32_t index = boost::endian::native_to_little(system_index);
+
+    boost::crc_32_type crc;
+    crc.process_bytes(&index, sizeof(index));
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+/// Replays the records in a journal segment.
+/// @return False if the remaining segments cannot be replayed.
+bool replaySegment(const path &filename, bool is_first_segment, Score &score)
+{
+    boost::filesystem::ifstream input(filename,
+                                      std::ios::in | std::ios::binary);
+
+    boost::system::error_code ec;
+    const uintmax_t file_size = boost::filesystem::file_size(filename, ec);
+    if (ec)
+        return false;
+
+    std::array<char, theRecordHeaderSize> header;
+    std::string data;
+    while (input.read(header.data(), header.size()))
+    {
+        uint32_t size, checksum;
+        int32_t system_index;
+        std::memcpy(&size, header.data(), sizeof(size));
+        std::memcpy(&checksum, header.data() + 4, sizeof(checksum));
+        std::memcpy(&system_index, header.data() + 8, sizeof(system_index));
+        boost::endian::little_to_native_inplace(size);
+        boost::endian::little_to_native_inplace(checksum);
+        boost::endian::little_to_native_inplace(system_index);
+
+        // Stop at a partially-written record. The size is checked before
+        // allocating, since a corrupted header could ask for up to 4 GB.
+        const auto offset = static_cast<uintmax_t>(input.tellg());
+        if (offset > file_size || size > file_size - offset)
+            return false;
+
+        data.resize(size);
+        if (!input.read(&data[0], size) ||
+            computeChecksum(system_index, data) != checksum)
+        {
+            return false;
+        }
+
+        if (system_index == theDiscontinuity)
+        {
+            // The checkpoint for this segment already includes the change.
+            if (is_first_segment)
+                continue;
+            else
+                return false;
+        }
+
+        if (system_index < 0 ||
+            system_index >= static_cast<int>(score.getSystems().size()))
+        {
+            return false;
+        }
+
+        std::istringstream system_input(data);
+        System system;
+        ScoreUtils::load(system_input, "system", system);
+        score.getSystems()[system_index] = system;
+    }
+
+    // Stop if there was a partial header.
+    return input.gcount() == 0;
+}
+} // namespace
+
+AutosaveJournal::AutosaveJournal(const path &autosave_dir)
+    : myDirectory(autosave_dir /
+                  boost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%")),
+      myGeneration(-1),
+      myHasCheckpoint(false),
+      myRecordCount(0)
+{
+    boost::filesystem::create_directories(myDirectory);
+
+    // Hold a lock on the journal for as long as it is in use, so that other
+    // instances of the program don't attempt to recover it.
+    const path lock_path = myDirectory / theLockFilename;
+    boost::filesystem::ofstream lock_file(lock_path);
+    lock_file.close();
+
+    myLock = boost::interprocess::file_lock(lock_path.string().c_str());
+    myLock.lock();
+}
+
+AutosaveJournal::~AutosaveJournal()
+{
+    try
+    {
+        waitForCheckpoint();
+        mySegment.close();
+
+        // Release the lock before deleting the file.
+        myLock = boost::interprocess::file_lock();
+
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(myDirectory, ec);
+    }
+    catch (const std::exception &)
+    {
+        // Leaving the journal behind is harmless, since it can be discarded
+        // during recovery.
+    }
+}
+
+void AutosaveJournal::setDocumentFilename(const path &filename)
+{
+    const path dest = myDirectory / theDocumentFilename;
+    path temp = dest;
+    temp += ".tmp";
+
+    {
+        boost::filesystem::detail::utf8_codecvt_facet utf8;
+        boost::filesystem::ofstream output(temp, std::ios::out |
+                                                     std::ios::binary);
+        output << filename.string(utf8);
+    }
+
+    boost::filesystem::rename(temp, dest);
+}
+
+void AutosaveJournal::recordSystemChange(const Score &score, int system_index)
+{
+    // Without a checkpoint, there's nothing to apply the change to.
+    if (!myHasCheckpoint)
+    {
+        checkpoint(score);
+        return;
+    }
+
+    std::ostringstream output;
+    ScoreUtils::save(output, "system", score.getSystems()[system_index]);
+    appendRecord(system_index, output.str());
+
+    if (myRecordCount >= CHECKPOINT_INTERVAL)
+        checkpoint(score);
+}
+
+void AutosaveJournal::recordScoreChange(const Score &score)
+{
+    writeCheckpoint(score, false);
+}
+
+void AutosaveJournal::checkpoint(const Score &score)
+{
+    writeCheckpoint(score, true);
+}
+
+void AutosaveJournal::writeCheckpoint(const Score &score, bool continuous)
+{
+    const bool previous_finished =
+        myCheckpointFuture.valid() &&
+        myCheckpointFuture.wait_for(std::chrono::seconds(0)) ==
+            std::future_status::ready;
+
+    std::optional<std::string> previous_error;
+    if (previous_finished)
+    {
+        try
+        {
+            myCheckpointFuture.get();
+        }
+        catch (const std::exception &e)
+        {
+            previous_error = e.what();
+        }
+    }
+
+    // The snapshot is taken before starting the new segment, so that the
+    // segment's records apply on top of the checkpoint.
+    // If the previous checkpoint has finished, its snapshot can be updated
+    // rather than copying the entire score again. Otherwise, don't wait for
+    // the worker thread to finish with it.
+    if (mySnapshot && previous_finished)
+        mySnapshot->copyChangesFrom(score);
+    else
+        mySnapshot.reset(new Score(score.clone()));
+
+    std::shared_ptr<const Score> snapshot = mySnapshot;
+
+    // If the previous checkpoint failed, write its generation again and keep
+    // appending to its segment. Recovery can then still fall back to the
+    // older checkpoint and replay the segment. Replaying the segment on top of
+    // the new checkpoint is harmless, since the last record for each system
+    // matches the system's current contents.
+    if (!previous_error)
+        ++myGeneration;
+    startSegment(continuous, /* append */ previous_error.has_value());
+    myHasCheckpoint = true;
+
+    // Checkpoints must be written in order, since each one deletes the
+    // previous generations.
+    myCheckpointFuture =
+        std::async(std::launch::async,
+                   [dir = myDirectory, generation = myGeneration, snapshot,
+                    previous = myCheckpointFuture]() {
+                       if (previous.valid())
+                           previous.wait();
+
+                       const path filename = getCheckpointPath(dir, generation);
+                       path temp = filename;
+                       temp += ".tmp";
+
+                       {
+                           boost::filesystem::ofstream output(
+                               temp, std::ios::out | std::ios::binary);
+                           if (!output)
+                               throw std::runtime_error(
+                                   "Error opening checkpoint for writing.");
+
+                           ScoreUtils::save(output, "score", *snapshot);
+                       }
+
+                       boost::filesystem::rename(temp, filename);
+
+                       // Remove the older checkpoints and segments, which are
+                       // now redundant.
+                       for (auto &entry :
+                            boost::filesystem::directory_iterator(dir))
+                       {
+                           auto checkpoint_gen = parseGeneration(
+                               entry.path(), theCheckpointPrefix,
+                               theCheckpointExtension);
+                           auto segment_gen =
+                               parseGeneration(entry.path(), theSegmentPrefix,
+                                               theSegmentExtension);
+
+                           if ((checkpoint_gen && *checkpoint_gen < generation) ||
+                               (segment_gen && *segment_gen < generation))
+                           {
+                               boost::system::error_code ec;
+                               boost::filesystem::remove(entry.path(), ec);
+                           }
+                       }
+                   })
+            .share();
+
+    if (previous_error)
+    {
+        throw std::runtime_error("Error writing checkpoint: " +
+                                 *previous_error);
+    }
+}
+
+void AutosaveJournal::waitForCheckpoint()
+{
+    // The future is kept, so that the next checkpoint also knows that this
+    // one failed.
+    if (myCheckpointFuture.valid())
+        myCheckpointFuture.get();
+}
+
+void AutosaveJournal::clear()
+{
+    // The saved document replaces any checkpoint, so it doesn't matter if the
+    // last one failed.
+    if (myCheckpointFuture.valid())
+        myCheckpointFuture.wait();
+    myCheckpointFuture = std::shared_future<void>();
+    mySegment.close();
+
+    for (auto &entry : boost::filesystem::directory_iterator(myDirectory))
+    {
+        const path name = entry.path().filename();
+        if (name != theLockFilename && name != theDocumentFilename)
+            boost::filesystem::remove(entry.path());
+    }
+
+    myHasCheckpoint = false;
+    myRecordCount = 0;
+}
+
+void AutosaveJournal::startSegment(bool continuous, bool append)
+{
+    mySegment.close();
+    mySegment.clear();
+    mySegment.open(getSegmentPath(myDirectory, myGeneration),
+                   std::ios::out | std::ios::binary |
+                       (append ? std::ios::app : std::ios::trunc));
+    myRecordCount = 0;
+
+    if (!continuous)
+        appendRecord(theDiscontinuity, std::string());
+}
+
+void AutosaveJournal::appendRecord(int system_index, const std::string &data)
+{
+    std::array<char, theRecordHeaderSize> header;
+    const uint32_t size =
+        boost::endian::native_to_little(static_cast<uint32_t>(data.size()));
+    const uint32_t checksum = boost::endian::native_to_little(
+        computeChecksum(system_index, data));
+    const int32_t index = boost::endian::native_to_little(
+        static_cast<int32_t>(system_index));
+    std::memcpy(header.data(), &size, sizeof(size));
+    std::memcpy(header.data() + 4, &checksum, sizeof(checksum));
+    std::memcpy(header.data() + 8, &index, sizeof(index));
+
+    mySegment.write(header.data(), header.size());
+    mySegment.write(data.data(), data.size());
+
+    // Hand the record to the OS immediately, so that it survives a crash.
+    mySegment.flush();
+
+    ++myRecordCount;
+}
+
+std::vector<AutosaveJournal::path> AutosaveJournal::findOrphanedJournals(
+    const path &autosave_dir)
+{
+    std::vector<path> journals;
+    if (!boost::filesystem::is_directory(autosave_dir))
+        return journals;
+
+    for (auto &entry : boost::filesystem::directory_iterator(autosave_dir))
+    {
+        const path lock_path = entry.path() / theLockFilename;
+        if (!boost::filesystem::exists(lock_path))
+            continue;
+
+        bool in_use = true;
+        try
+        {
+            boost::interprocess::file_lock lock(lock_path.string().c_str());
+            if (lock.try_lock())
+            {
+                lock.unlock();
+                in_use = false;
+            }
+        }
+        catch (const boost::interprocess::interprocess_exception &)
+        {
+            // Skip journals that can't be inspected.
+        }
+
+        if (in_use)
+            continue;
+
+        // A journal that was just created or was cleared after saving has
+        // nothing to recover.
+        if (!findLatestCheckpoint(entry.path()))
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(entry.path(), ec);
+            continue;
+        }
+
+        journals.push_back(entry.path());
+    }
+
+    return journals;
+}
+
+std::optional<AutosaveJournal::path> AutosaveJournal::recover(
+    const path &journal_dir, Score &score)
+{
+    const std::optional<int> generation = findLatestCheckpoint(journal_dir);
+    if (!generation)
+        throw std::runtime_error("The journal does not contain a checkpoint.");
+
+    {
+        boost::filesystem::ifstream input(
+            getCheckpointPath(journal_dir, *generation),
+            std::ios::in | std::ios::binary);
+        ScoreUtils::load(input, "score", score);
+    }
+
+    for (int gen = *generation;
+         boost::filesystem::exists(getSegmentPath(journal_dir, gen)); ++gen)
+    {
+        if (!replaySegment(getSegmentPath(journal_dir, gen),
+                           gen == *generation, score))
+        {
+            break;
+        }
+    }
+
+    std::optional<path> filename;
+    const path document_path = journal_dir / theDocumentFilename;
+    if (boost::filesystem::exists(document_path))
+    {
+        boost::filesystem::ifstream input(document_path,
+                                          std::ios::in | std::ios::binary);
+        std::string str((std::istreambuf_iterator<char>(input)),
+                        std::istreambuf_iterator<char>());
+
+        boost::filesystem::detail::utf8_codecvt_facet utf8;
+        filename = path(str, utf8);
+    }
+
+    return filename;
+}
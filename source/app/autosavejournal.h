@@ -0,0 +1,121 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef APP_AUTOSAVEJOURNAL_H
+#define APP_AUTOSAVEJOURNAL_H
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class Score;
+
+/// An append-only log of the edits made to a document, which allows unsaved
+/// changes to be recovered if the program crashes.
+///
+/// Each edit to a system appends a record containing only that system, so the
+/// cost of journaling an edit does not depend on the size of the score. A
+/// checkpoint writes a full snapshot of the score on a worker thread and
+/// starts a new journal segment, after which the older segments are deleted.
+class AutosaveJournal
+{
+public:
+    using path = boost::filesystem::path;
+
+    /// Creates a new journal in a unique subdirectory of the given directory.
+    AutosaveJournal(const path &autosave_dir);
+    AutosaveJournal(const AutosaveJournal &) = delete;
+    AutosaveJournal &operator=(const AutosaveJournal &) = delete;
+
+    /// Deletes the journal from disk. A journal is only left behind if the
+    /// program exits abnormally.
+    ~AutosaveJournal();
+
+    /// Records the filename of the document, so that it can be restored
+    /// during recovery.
+    void setDocumentFilename(const path &filename);
+
+    /// Records the new contents of a system that was modified.
+    void recordSystemChange(const Score &score, int system_index);
+
+    /// Records a change that may affect the entire score (e.g. inserting a
+    /// system or editing a player). This requires a new checkpoint.
+    void recordScoreChange(const Score &score);
+
+    /// Takes a snapshot of the score and writes it in the background, which
+    /// allows the previous journal segments to be discarded.
+    /// If the previous checkpoint failed, its generation is written again
+    /// and the failure is reported by throwing std::exception.
+    void checkpoint(const Score &score);
+
+    /// Blocks until any pending checkpoint has been written.
+    /// @throws std::exception if the checkpoint could not be written.
+    void waitForCheckpoint();
+
+    /// Removes all records, e.g. after the document has been saved.
+    void clear();
+
+    /// Returns the journal's directory.
+    const path &getDirectory() const { return myDirectory; }
+
+    /// Returns any journals in the directory that are not in use, e.g. those
+    /// left behind after a crash. Journals without a checkpoint have nothing
+    /// to recover, and are deleted instead.
+    static std::vector<path> findOrphanedJournals(const path &autosave_dir);
+
+    /// Rebuilds a score from the journal in the given directory.
+    /// Any incomplete records at the end of the journal (e.g. from a crash
+    /// while writing) are ignored.
+    /// @return The filename of the document, if it had one.
+    /// @throws std::exception if the journal does not have a checkpoint.
+    static std::optional<path> recover(const path &journal_dir, Score &score);
+
+    /// Number of records before a new checkpoint is written.
+    static const int CHECKPOINT_INTERVAL;
+
+private:
+    /// Writes a checkpoint and begins a new journal segment.
+    /// @param continuous False if the new segment cannot be replayed on top
+    /// of the previous segment.
+    void writeCheckpoint(const Score &score, bool continuous);
+    /// Closes the current journal segment and begins a new one.
+    /// @param append True to continue the existing segment for the current
+    /// generation, e.g. when retrying a failed checkpoint.
+    void startSegment(bool continuous, bool append = false);
+    /// Appends a record to the current journal segment.
+    void appendRecord(int system_index, const std::string &data);
+
+    const path myDirectory;
+    boost::interprocess::file_lock myLock;
+    boost::filesystem::ofstream mySegment;
+    /// Generation number of the current checkpoint and journal segment.
+    int myGeneration;
+    bool myHasCheckpoint;
+    /// Number of records in the current segment.
+    int myRecordCount;
+    /// The score as of the last checkpoint. Once that checkpoint has been
+    /// written, the next checkpoint only needs to copy the systems that have
+    /// changed since then.
+    std::shared_ptr<Score> mySnapshot;
+    std::shared_future<void> myCheckpointFuture;
+};
+
+#endif
@@ -0,0 +1,180 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "backgroundsaver.h"
+
+#include <algorithm>
+#include <app/paths.h>
+#include <atomic>
+#include <formats/fileformatmanager.h>
+#include <future>
+#include <QPointer>
+#include <QUndoStack>
+#include <score/score.h>
+
+struct BackgroundSaver::Job
+{
+    Job(int id, const Score &score, const boost::filesystem::path &filename,
+        const FileFormat &format, QUndoStack *undo_stack)
+        : myId(id),
+          mySnapshot(score.clone()),
+          myFilename(filename),
+          myFormat(format),
+          myUndoStack(undo_stack),
+          myCancelled(false),
+          myDocumentChanged(false),
+          myCommitted(false)
+    {
+    }
+
+    const int myId;
+    const Score mySnapshot;
+    const boost::filesystem::path myFilename;
+    const FileFormat myFormat;
+
+    QPointer<QUndoStack> myUndoStack;
+    QMetaObject::Connection myUndoConnection;
+
+    std::atomic<bool> myCancelled;
+    /// Set if the document is edited after the snapshot was taken.
+    bool myDocumentChanged;
+
+    /// Results from the worker thread, which are only valid after waiting on
+    /// the future.
+    std::shared_future<void> myFuture;
+    bool myCommitted;
+    std::string myError;
+};
+
+BackgroundSaver::BackgroundSaver(FileFormatManager &manager, QObject *parent)
+    : QObject(parent), myManager(manager), myNextJobId(0)
+{
+}
+
+BackgroundSaver::~BackgroundSaver()
+{
+    // Don't leave any worker threads referencing this object. Any pending
+    // saves are still written, since the user expects them to complete.
+    for (auto &job : myJobs)
+        job->myFuture.wait();
+}
+
+void BackgroundSaver::save(const Score &score,
+                           const boost::filesystem::path &filename,
+                           const FileFormat &format, QUndoStack *undo_stack)
+{
+    // Only the most recent snapshot should be written, but the new job must
+    // not commit until the previous job has finished with the file.
+    std::shared_future<void> previous_job;
+    for (auto &job : myJobs)
+    {
+        if (job->myFilename == filename)
+        {
+            job->myCancelled = true;
+            previous_job = job->myFuture;
+        }
+    }
+
+    myJobs.emplace_back(
+        new Job(myNextJobId++, score, filename, format, undo_stack));
+    Job *job = myJobs.back().get();
+
+    if (undo_stack)
+    {
+        // The document is only clean if it matches the snapshot that was
+        // written.
+        job->myUndoConnection =
+            connect(undo_stack, &QUndoStack::indexChanged, this,
+                    [job]() { job->myDocumentChanged = true; });
+    }
+
+    emit saveStarted(Paths::toQString(filename));
+
+    // The job is not destroyed until its future has completed, so it is safe
+    // for the worker thread to reference it.
+    job->myFuture =
+        std::async(std::launch::async, [this, job, previous_job]() {
+            if (previous_job.valid())
+                previous_job.wait();
+
+            try
+            {
+                job->myCommitted =
+                    myManager.exportFile(job->mySnapshot, job->myFilename,
+                                         job->myFormat, &job->myCancelled);
+            }
+            catch (const std::exception &e)
+            {
+                job->myError = e.what();
+            }
+
+            QMetaObject::invokeMethod(this, "onJobFinished",
+                                      Qt::QueuedConnection,
+                                      Q_ARG(int, job->myId));
+        }).share();
+}
+
+void BackgroundSaver::cancel(const boost::filesystem::path &filename)
+{
+    for (auto &job : myJobs)
+    {
+        if (job->myFilename == filename)
+            job->myCancelled = true;
+    }
+}
+
+void BackgroundSaver::waitForAll()
+{
+    while (!myJobs.empty())
+    {
+        myJobs.front()->myFuture.wait();
+        finishJob(myJobs.begin());
+    }
+}
+
+bool BackgroundSaver::isSaving() const
+{
+    return !myJobs.empty();
+}
+
+void BackgroundSaver::onJobFinished(int id)
+{
+    auto it = std::find_if(myJobs.begin(), myJobs.end(),
+                           [=](const std::unique_ptr<Job> &job) {
+                               return job->myId == id;
+                           });
+
+    // The job may have already been collected by waitForAll().
+    if (it != myJobs.end())
+        finishJob(it);
+}
+
+void BackgroundSaver::finishJob(std::vector<std::unique_ptr<Job>>::iterator it)
+{
+    std::unique_ptr<Job> job = std::move(*it);
+    myJobs.erase(it);
+
+    job->myFuture.get();
+    disconnect(job->myUndoConnection);
+
+    if (job->myCommitted && job->myUndoStack && !job->myDocumentChanged)
+        job->myUndoStack->setClean();
+
+    const bool cancelled = !job->myCommitted && job->myError.empty();
+    emit saveFinished(Paths::toQString(job->myFilename), job->myUndoStack,
+                      cancelled, QString::fromStdString(job->myError));
+}
@@ -0,0 +1,88 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef APP_BACKGROUNDSAVER_H
+#define APP_BACKGROUNDSAVER_H
+
+#include <boost/filesystem/path.hpp>
+#include <memory>
+#include <QObject>
+#include <vector>
+
+class FileFormat;
+class FileFormatManager;
+class QUndoStack;
+class Score;
+
+/// Writes files on a worker thread so that the editor remains responsive while
+/// large scores are serialized and compressed.
+/// A snapshot of the score is taken when the save is started, so the user can
+/// continue editing while the file is being written.
+class BackgroundSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BackgroundSaver(FileFormatManager &manager,
+                             QObject *parent = nullptr);
+    ~BackgroundSaver();
+
+    /// Starts saving a snapshot of the score. Any pending save to the same
+    /// file is cancelled.
+    /// @param undo_stack If provided, the stack is marked as clean once the
+    /// file has been written, unless the document was modified in the
+    /// meantime.
+    void save(const Score &score, const boost::filesystem::path &filename,
+              const FileFormat &format, QUndoStack *undo_stack);
+
+    /// Cancels any pending save to the given file. The existing file on disk
+    /// is left untouched.
+    void cancel(const boost::filesystem::path &filename);
+
+    /// Blocks until all pending saves have finished.
+    void waitForAll();
+
+    /// Returns whether any saves are in progress.
+    bool isSaving() const;
+
+signals:
+    /// Emitted when a save begins writing to disk.
+    void saveStarted(const QString &filename);
+
+    /// Emitted once a save has either been committed, cancelled, or failed.
+    /// If the save failed, the error message is non-empty. The undo stack is
+    /// the one passed to save(), or null if it was not provided or has since
+    /// been destroyed.
+    void saveFinished(const QString &filename, QUndoStack *undo_stack,
+                      bool cancelled, const QString &error);
+
+private slots:
+    /// Invoked on the GUI thread when a worker thread has completed.
+    void onJobFinished(int id);
+
+private:
+    struct Job;
+
+    /// Collects the result of the job and notifies any listeners.
+    void finishJob(std::vector<std::unique_ptr<Job>>::iterator it);
+
+    FileFormatManager &myManager;
+    std::vector<std::unique_ptr<Job>> myJobs;
+    int myNextJobId;
+};
+
+#endif
@@ -17,6 +17,7 @@
   
 #include "documentmanager.h"
 
+#include <app/autosavejournal.h>
 #include <app/settings.h>
 #include <app/settingsmanager.h>
 
@@ -141,6 +142,10 @@ Document::Document()
 {
 }
 
+Document::~Document()
+{
+}
+
 bool Document::hasFilename() const
 {
     return myFilename.has_value();
@@ -154,6 +159,9 @@ const Document::PathType &Document::getFilename() const
 void Document::setFilename(const PathType &filename)
 {
     myFilename = filename;
+
+    if (myJournal)
+        myJournal->setDocumentFilename(filename);
 }
 
 const Score &Document::getScore() const
@@ -187,3 +195,11 @@ Caret &Document::getCaret()
 {
     return myCaret;
 }
+
+void Document::setJournal(std::unique_ptr<AutosaveJournal> journal)
+{
+    myJournal = std::move(journal);
+
+    if (myJournal && myFilename)
+        myJournal->setDocumentFilename(*myFilename);
+}
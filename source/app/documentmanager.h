@@ -26,6 +26,7 @@
 #include <score/score.h>
 #include <vector>
 
+class AutosaveJournal;
 class SettingsManager;
 
 /// A document is a score that is either associated with a file or unsaved.
@@ -35,6 +36,7 @@ public:
     using PathType = boost::filesystem::path;
 
     Document();
+    ~Document();
     Document(const Document &) = delete;
     Document &operator=(const Document &) = delete;
 
@@ -54,11 +56,16 @@ public:
     const Caret &getCaret() const;
     Caret &getCaret();
 
+    /// Returns the journal used to recover unsaved changes, if there is one.
+    AutosaveJournal *getJournal() const { return myJournal.get(); }
+    void setJournal(std::unique_ptr<AutosaveJournal> journal);
+
 private:
     std::optional<PathType> myFilename;
     Score myScore;
     ViewOptions myViewOptions;
     Caret myCaret;
+    std::unique_ptr<AutosaveJournal> myJournal;
 };
 
 /// Class for managing open documents.
@@ -43,6 +43,11 @@ path getUserDataDir()
         QStandardPaths::writableLocation(QStandardPaths::DataLocation));
 }
 
+path getAutosaveDir()
+{
+    return getUserDataDir() / "autosave";
+}
+
 std::vector<path> getDataDirs()
 {
     QStringList q_paths =
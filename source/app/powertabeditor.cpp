@@ -76,6 +76,8 @@
 #include <actions/volumeswell.h>
 
 #include <app/appinfo.h>
+#include <app/autosavejournal.h>
+#include <app/backgroundsaver.h>
 #include <app/caret.h>
 #include <app/clipboard.h>
 #include <app/command.h>
@@ -91,6 +93,7 @@
 #include <audio/midiplayer.h>
 #include <audio/settings.h>
 
+#include <boost/filesystem/operations.hpp>
 #include <boost/range/algorithm/transform.hpp>
 #include <chrono>
 
@@ -139,6 +142,7 @@
 #include <QPrintDialog>
 #include <QPrintPreviewDialog>
 #include <QScrollArea>
+#include <QStatusBar>
 #include <QTabBar>
 #include <QUrl>
 #include <QVBoxLayout>
@@ -147,6 +151,7 @@
 #include <score/utils.h>
 #include <score/voiceutils.h>
 
+#include <util/scopeexit.h>
 #include <util/tostring.h>
 
 #include <widgets/instruments/instrumentpanel.h>
@@ -159,6 +164,7 @@ PowerTabEditor::PowerTabEditor()
       mySettingsManager(new SettingsManager()),
       myDocumentManager(new DocumentManager()),
       myFileFormatManager(new FileFormatManager(*mySettingsManager)),
+      myBackgroundSaver(new BackgroundSaver(*myFileFormatManager)),
       myUndoManager(new UndoManager()),
       myTuningDictionary(new TuningDictionary()),
       myIsPlaying(false),
@@ -191,6 +197,24 @@ PowerTabEditor::PowerTabEditor()
     connect(myUndoManager.get(), &UndoManager::cleanChanged, this,
             &PowerTabEditor::updateModified);
 
+    // Record each edit in the autosave journal.
+    // Record each edit in the autosave journal of the document whose undo
+    // stack it was made on.
+    connect(myUndoManager.get(), &UndoManager::systemChanged, this,
+            &PowerTabEditor::journalSystemChange);
+    connect(myUndoManager.get(), &UndoManager::scoreChanged, this,
+            &PowerTabEditor::journalScoreChange);
+    connect(myUndoManager.get(), &UndoManager::stackCleanChanged, this,
+            &PowerTabEditor::clearJournal);
+
+    connect(myBackgroundSaver.get(), &BackgroundSaver::saveStarted, this,
+            [=](const QString &filename) {
+                statusBar()->showMessage(
+                    tr("Saving %1...").arg(QFileInfo(filename).fileName()));
+            });
+    connect(myBackgroundSaver.get(), &BackgroundSaver::saveFinished, this,
+            &PowerTabEditor::handleSaveFinished);
+
     myTuningDictionary->loadInBackground();
     mySettingsManager->load(Paths::getConfigDir());
 
@@ -232,6 +256,75 @@ void PowerTabEditor::openFiles(const QStringList &files)
         openFile(filename);
 }
 
+void PowerTabEditor::recoverAutosavedDocuments()
+{
+    const std::vector<Paths::path> journals =
+        AutosaveJournal::findOrphanedJournals(Paths::getAutosaveDir());
+    if (journals.empty())
+        return;
+
+    const int ret = QMessageBox::question(
+        this, tr("Recover Documents"),
+        tr("%n document(s) had unsaved changes when the program last exited. "
+           "Do you want to recover them?",
+           "", static_cast<int>(journals.size())),
+        QMessageBox::Yes | QMessageBox::No);
+
+    for (const Paths::path &journal_dir : journals)
+    {
+        // Discard the journal whether or not it could be recovered, so that
+        // the user isn't prompted about it again on the next startup.
+        Util::ScopeExit remove_journal([&]() {
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(journal_dir, ec);
+        });
+
+        if (ret == QMessageBox::Yes)
+        {
+            try
+            {
+                Document &doc = myDocumentManager->addDocument();
+                std::optional<Paths::path> filename =
+                    AutosaveJournal::recover(journal_dir, doc.getScore());
+                if (filename)
+                    doc.setFilename(*filename);
+            }
+            catch (const std::exception &e)
+            {
+                myDocumentManager->removeDocument(
+                    myDocumentManager->getCurrentDocumentIndex());
+
+                QMessageBox::warning(
+                    this, tr("Error Recovering Document"),
+                    tr("Error recovering document: %1").arg(QString(e.what())));
+                continue;
+            }
+
+            setupNewTab();
+
+            // The recovered changes have not been saved. Journal them
+            // immediately in case the program crashes again.
+            const int index = myDocumentManager->getCurrentDocumentIndex();
+            myUndoManager->stacks()[index]->resetClean();
+
+            Document &doc = myDocumentManager->getCurrentDocument();
+            if (AutosaveJournal *journal = doc.getJournal())
+            {
+                try
+                {
+                    journal->checkpoint(doc.getScore());
+                    journal->waitForCheckpoint();
+                }
+                catch (const std::exception &e)
+                {
+                    qDebug() << "Error writing to autosave journal:"
+                             << e.what();
+                }
+            }
+        }
+    }
+}
+
 void PowerTabEditor::createNewDocument()
 {
     myDocumentManager->addDefaultDocument(*mySettingsManager);
@@ -265,9 +358,10 @@ void PowerTabEditor::openFile(QString filename)
 
     qDebug() << "Opening file: " << filename;
 
-    QFileInfo fileInfo(filename);
-    std::optional<FileFormat> format = myFileFormatManager->findFormat(
-                fileInfo.suffix().toStdString());
+    // Detect the format from the file's contents, so that files with a
+    // missing or incorrect extension can still be opened.
+    std::optional<FileFormat> format =
+        myFileFormatManager->findImportFormat(path);
 
     if (!format)
     {
@@ -342,6 +436,11 @@ bool PowerTabEditor::closeTab(int index)
         {
             if (!saveFile(index))
                 return false;
+
+            // Don't close the document until the file has been written.
+            myBackgroundSaver->waitForAll();
+            if (!myUndoManager->stacks()[index]->isClean())
+                return false;
         }
         else if (ret == QMessageBox::Cancel)
             return false;
@@ -400,36 +499,13 @@ bool PowerTabEditor::saveFile(int doc_index, QString path)
     auto path_str = Paths::fromQString(path);
     Document &doc = myDocumentManager->getDocument(doc_index);
 
-    try
-    {
-        myFileFormatManager->exportFile(doc.getScore(), path_str, *format);
-    }
-    catch (const std::exception &e)
-    {
-        QMessageBox::warning(
-            this, tr("Error Saving File"),
-            tr("Error saving file: %1").arg(QString(e.what())));
-
-        return false;
-    }
-
-    if (extension == "pt2")
-    {
-        doc.setFilename(path_str);
-
-        // Update window title and tab bar.
-        updateWindowTitle();
-        const QString filename = info.fileName();
-        myTabWidget->setTabText(doc_index, filename);
-        myTabWidget->setTabToolTip(doc_index, filename);
-
-        // Add to the recent files list and update the last used directory.
-        myRecentFiles->add(path);
-        setPreviousDirectory(path);
-
-        // Mark the file as being in an unmodified state.
-        myUndoManager->stacks()[doc_index]->setClean();
-    }
+    // The file is written from a snapshot of the score on a worker thread.
+    // For native files, the document is marked as unmodified and renamed once
+    // the write has been committed (see handleSaveFinished()).
+    const bool is_native_format = (extension == "pt2");
+    myBackgroundSaver->save(
+        doc.getScore(), path_str, *format,
+        is_native_format ? myUndoManager->stacks()[doc_index] : nullptr);
 
     return true;
 }
@@ -468,6 +544,108 @@ bool PowerTabEditor::saveFileAs(int doc_index)
         return false;
 }
 
+void PowerTabEditor::handleSaveFinished(const QString &filename,
+                                        QUndoStack *undo_stack, bool cancelled,
+                                        const QString &error)
+{
+    if (!myBackgroundSaver->isSaving())
+        statusBar()->clearMessage();
+
+    if (cancelled)
+        return;
+
+    if (!error.isEmpty())
+    {
+        QMessageBox::warning(this, tr("Error Saving File"),
+                             tr("Error saving file %1: %2")
+                                 .arg(QFileInfo(filename).fileName(), error));
+    }
+    else
+    {
+        statusBar()->showMessage(
+            tr("Saved %1").arg(QFileInfo(filename).fileName()), 2000);
+
+        // Only native files have an undo stack attached. The document may
+        // have been closed while the file was being written.
+        const int doc_index = myUndoManager->stacks().indexOf(undo_stack);
+        if (!undo_stack || doc_index < 0)
+            return;
+
+        Document &doc = myDocumentManager->getDocument(doc_index);
+        doc.setFilename(Paths::fromQString(filename));
+
+        // Update window title and tab bar.
+        updateWindowTitle();
+        const QString name = QFileInfo(filename).fileName();
+        myTabWidget->setTabText(doc_index, name);
+        myTabWidget->setTabToolTip(doc_index, name);
+
+        // Add to the recent files list and update the last used directory.
+        myRecentFiles->add(filename);
+        setPreviousDirectory(filename);
+    }
+}
+
+Document *PowerTabEditor::getDocument(QUndoStack *undo_stack)
+{
+    const int doc_index = myUndoManager->stacks().indexOf(undo_stack);
+    if (doc_index < 0)
+        return nullptr;
+
+    return &myDocumentManager->getDocument(doc_index);
+}
+
+void PowerTabEditor::journalSystemChange(QUndoStack *undo_stack, int system)
+{
+    Document *doc = getDocument(undo_stack);
+    if (AutosaveJournal *journal = doc ? doc->getJournal() : nullptr)
+    {
+        try
+        {
+            journal->recordSystemChange(doc->getScore(), system);
+        }
+        catch (const std::exception &e)
+        {
+            qDebug() << "Error writing to autosave journal:" << e.what();
+        }
+    }
+}
+
+void PowerTabEditor::journalScoreChange(QUndoStack *undo_stack)
+{
+    Document *doc = getDocument(undo_stack);
+    if (AutosaveJournal *journal = doc ? doc->getJournal() : nullptr)
+    {
+        try
+        {
+            journal->recordScoreChange(doc->getScore());
+        }
+        catch (const std::exception &e)
+        {
+            qDebug() << "Error writing to autosave journal:" << e.what();
+        }
+    }
+}
+
+void PowerTabEditor::clearJournal(QUndoStack *undo_stack, bool clean)
+{
+    if (!clean)
+        return;
+
+    Document *doc = getDocument(undo_stack);
+    if (AutosaveJournal *journal = doc ? doc->getJournal() : nullptr)
+    {
+        try
+        {
+            journal->clear();
+        }
+        catch (const std::exception &e)
+        {
+            qDebug() << "Error clearing autosave journal:" << e.what();
+        }
+    }
+}
+
 void PowerTabEditor::updateModified(bool clean)
 {
     setWindowModified(!clean);
@@ -1809,6 +1987,9 @@ void PowerTabEditor::closeEvent(QCloseEvent *event)
         }
     }
 
+    // Finish writing any files that are being saved in the background.
+    myBackgroundSaver->waitForAll();
+
     myTuningDictionary->save();
 
     {
@@ -1825,10 +2006,19 @@ void PowerTabEditor::dragEnterEvent(QDragEnterEvent *event)
 {
     if (event->mimeData()->hasUrls())
     {
+        // Only accept files that can be imported. This is checked using the
+        // file extension, since reading the files' contents here would block
+        // the GUI thread (e.g. for files on a network drive). The contents are
+        // checked when the files are opened.
         for (const QUrl &url : event->mimeData()->urls())
         {
-            if (!url.isLocalFile())
+            const QString extension =
+                QFileInfo(url.toLocalFile()).suffix().toLower();
+            if (!url.isLocalFile() || !myFileFormatManager->findImportFormat(
+                                          extension.toStdString()))
+            {
                 return;
+            }
         }
 
         event->acceptProposedAction();
@@ -3244,6 +3434,17 @@ void PowerTabEditor::setupNewTab()
 
     myUndoManager->addNewUndoStack();
 
+    // Journal any edits so that they can be recovered after a crash.
+    try
+    {
+        doc.setJournal(
+            std::make_unique<AutosaveJournal>(Paths::getAutosaveDir()));
+    }
+    catch (const std::exception &e)
+    {
+        qDebug() << "Error creating autosave journal:" << e.what();
+    }
+
     QString filename = "Untitled";
     if (doc.hasFilename())
         filename = Paths::toQString(doc.getFilename());
@@ -28,8 +28,10 @@
 #include <string>
 #include <vector>
 
+class BackgroundSaver;
 class Caret;
 class Command;
+class Document;
 class DocumentManager;
 class FileFormatManager;
 class InstrumentPanel;
@@ -38,6 +40,7 @@ class MidiPlayer;
 class Mixer;
 class PlaybackWidget;
 class QActionGroup;
+class QUndoStack;
 class RecentFiles;
 class ScoreArea;
 class ScoreLocation;
@@ -56,6 +59,10 @@ public:
     /// Opens the given list of files.
     void openFiles(const QStringList &files);
 
+    /// Checks for documents with unsaved changes that were left behind by a
+    /// crash, and offers to recover them.
+    void recoverAutosavedDocuments();
+
 private slots:
     /// Creates a new (blank) document.
     void createNewDocument();
@@ -369,14 +376,32 @@ private:
     /// @return True if the file was successfully saved.
     bool saveFile(int doc_index);
 
-    /// Saves the document to the specified path.
-    /// @return True if the file was successfully saved.
+    /// Saves the document to the specified path. The file is written in the
+    /// background, and any errors are reported once it has finished.
+    /// @return True if the save was started.
     bool saveFile(int doc_index, QString path);
 
     /// Saves the document to a new filename.
     /// @return True if the file was successfully saved.
     bool saveFileAs(int doc_index);
 
+    /// Reports the result of a save that was written in the background.
+    /// If the file was committed, the document now refers to the new file.
+    void handleSaveFinished(const QString &filename, QUndoStack *undo_stack,
+                            bool cancelled, const QString &error);
+
+    /// Returns the document that owns the undo stack, or null if it has been
+    /// closed.
+    Document *getDocument(QUndoStack *undo_stack);
+    /// Records a modified system in the autosave journal of the document
+    /// that owns the undo stack.
+    void journalSystemChange(QUndoStack *undo_stack, int system);
+    /// Records a change to the entire score in the autosave journal of the
+    /// document that owns the undo stack.
+    void journalScoreChange(QUndoStack *undo_stack);
+    /// Discards the document's autosave journal once it is saved.
+    void clearJournal(QUndoStack *undo_stack, bool clean);
+
     /// Adds or removes a rest at the current location.
     void editRest(Position::DurationType duration);
 
@@ -416,6 +441,7 @@ private:
     std::unique_ptr<SettingsManager> mySettingsManager;
     std::unique_ptr<DocumentManager> myDocumentManager;
     std::unique_ptr<FileFormatManager> myFileFormatManager;
+    std::unique_ptr<BackgroundSaver> myBackgroundSaver;
     std::unique_ptr<UndoManager> myUndoManager;
     std::unique_ptr<MidiPlayer> myMidiPlayer;
     std::unique_ptr<TuningDictionary> myTuningDictionary;
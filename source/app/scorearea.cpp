@@ -20,8 +20,11 @@
 #include <app/documentmanager.h>
 #include <app/pubsub/clickpubsub.h>
 #include <chrono>
-#include <future>
 #include <painters/caretpainter.h>
+#include <painters/glyphcache.h>
+#include <painters/renderprofiler.h>
+#include <painters/scorecolor.h>
+#include <painters/scoreexporter.h>
 #include <painters/scoreinforenderer.h>
 #include <painters/systemrenderer.h>
 #include <QDebug>
@@ -30,8 +33,74 @@
 #include <QPrinter>
 #include <QScrollBar>
 #include <score/score.h>
+#include <score/serialization.h>
+#include <score/voiceutils.h>
 
 static const double SYSTEM_SPACING = 50;
+/// The maximum time to spend rendering systems in the background before
+/// handling events again.
+static const std::chrono::milliseconds IDLE_RENDER_BUDGET(10);
+
+ScoreArea::RenderSettings::RenderSettings(const Score &score,
+                                          const ViewOptions &view_options)
+    : myPlayers(score.getPlayers().begin(), score.getPlayers().end()),
+      myLineSpacing(score.getLineSpacing())
+{
+    if (const std::optional<int> filter = view_options.getFilter())
+        myFilter = score.getViewFilters()[*filter];
+}
+
+bool ScoreArea::RenderSettings::operator==(const RenderSettings &other) const
+{
+    return myFilter == other.myFilter && myPlayers == other.myPlayers &&
+           myLineSpacing == other.myLineSpacing;
+}
+
+bool ScoreArea::RenderSettings::operator!=(const RenderSettings &other) const
+{
+    return !operator==(other);
+}
+
+ScoreArea::SystemKey::SystemKey(const Score &score, int index, int bar_number,
+                                const PlayerChange *players)
+{
+    const auto &systems = score.getSystems();
+
+    std::optional<PlayerChange> previous_players;
+    if (players)
+        previous_players = *players;
+
+    std::vector<std::optional<Position>> next_positions;
+    if (index + 1 < static_cast<int>(systems.size()))
+    {
+        for (const Staff &staff : systems[index + 1].getStaves())
+        {
+            for (const Voice &voice : staff.getVoices())
+            {
+                if (const Position *pos =
+                        VoiceUtils::getNextPosition(voice, -1))
+                {
+                    next_positions.push_back(*pos);
+                }
+                else
+                    next_positions.push_back(std::nullopt);
+            }
+        }
+    }
+
+    ScoreUtils::HashArchive ar;
+    ar("system", systems[index]);
+    ar("bar_number", bar_number);
+    ar("players", previous_players);
+    ar("next_positions", next_positions);
+    myDigest = ar.getDigest();
+}
+
+/// Returns the number of bars that start in the system.
+static int getBarCount(const System &system)
+{
+    return static_cast<int>(system.getBarlines().size()) - 1;
+}
 
 void ScoreArea::Scene::dragEnterEvent(QGraphicsSceneDragDropEvent *event)
 {
@@ -40,130 +109,408 @@ void ScoreArea::Scene::dragEnterEvent(QGraphicsSceneDragDropEvent *event)
 
 ScoreArea::ScoreArea(QWidget *parent)
     : QGraphicsView(parent),
+      myDocument(nullptr),
       myScoreInfoBlock(nullptr),
+      mySystemsTop(0),
       myCaretPainter(nullptr),
       myScorePalette(&parent->palette()),
+      myPrintPalette(getPrintPalette()),
       myClickPubSub(std::make_shared<ClickPubSub>())
 {
     setScene(&myScene);
 
-    // set the palette colors to be used when printing
-    myPrintPalette.setColor(QPalette::Text,Qt::black);
-    myPrintPalette.setColor(QPalette::Light,Qt::white);
-    myPrintPalette.setColor(QPalette::Dark,Qt::lightGray);
+    setActivePalette(myScorePalette);
 
-    activePalette = myScorePalette;
+    // Systems that haven't been rendered yet are rendered whenever there are
+    // no other events to process.
+    myIdleTimer.setInterval(0);
+    connect(&myIdleTimer, &QTimer::timeout, this,
+            [=]() { renderPendingSystems(); });
 }
 
 void ScoreArea::renderDocument(const Document &document)
 {
-    myScene.clear();
-    myRenderedSystems.clear();
-    myDocument = &document;
-
     const Score &score = document.getScore();
+    const ViewOptions &view_options = document.getViewOptions();
+
+    // The rendered systems refer to the document's score, so they can only be
+    // reused when redrawing the same document with the same settings.
+    RenderSettings settings(score, view_options);
+    if (&document != myDocument || settings != myRenderSettings)
+    {
+        mySystemKeys.clear();
+        mySystemLayouts.clear();
+    }
 
     auto start = std::chrono::high_resolution_clock::now();
 
+    const int num_systems = static_cast<int>(score.getSystems().size());
+
+    // Compute the bar numbers and active players in a single pass, rather
+    // than scanning through the previous systems for each system.
+    std::vector<SystemKey> keys;
+    keys.reserve(num_systems);
+    std::vector<int> bar_counts;
+    bar_counts.reserve(num_systems);
+    mySystemsWithPlayers.clear();
+    const PlayerChange *players = nullptr;
+    for (int i = 0, bar_number = 1; i < num_systems; ++i)
+    {
+        const System &system = score.getSystems()[i];
+        keys.emplace_back(score, i, bar_number, players);
+
+        bar_counts.push_back(getBarCount(system));
+        bar_number += bar_counts.back();
+        if (!system.getPlayerChanges().empty())
+        {
+            players = &system.getPlayerChanges().back();
+            mySystemsWithPlayers.insert(mySystemsWithPlayers.end(), i);
+        }
+    }
+    myBarCounts = Util::FenwickTree<int>(bar_counts);
+
+    // Take the systems that are unchanged out of the scene before clearing
+    // it, so that they aren't deleted.
+    QList<QGraphicsItem *> systems;
+    systems.reserve(num_systems);
+    std::vector<std::vector<LayoutConstPtr>> layouts(num_systems);
+    int num_reused = 0;
+
+    for (int i = 0; i < num_systems; ++i)
+    {
+        QGraphicsItem *system = nullptr;
+        if (i < static_cast<int>(mySystemKeys.size()) &&
+            myRenderedSystems[i] && mySystemKeys[i] == keys[i])
+        {
+            system = myRenderedSystems[i];
+            myScene.removeItem(system);
+            layouts[i] = std::move(mySystemLayouts[i]);
+            ++num_reused;
+        }
+
+        systems.append(system);
+    }
+
+    myScene.clear();
+    myRenderedSystems = systems;
+    mySystemKeys = std::move(keys);
+    myRenderSettings = std::move(settings);
+    myDocument = &document;
+
     myCaretPainter =
-        new CaretPainter(document.getCaret(), document.getViewOptions());
+        new CaretPainter(document.getCaret(), view_options,
+                         [=](int index) { return getSystemRect(index); });
     myCaretPainter->subscribeToMovement([=]() {
         adjustScroll();
     });
 
-    myScoreInfoBlock = ScoreInfoRenderer::render(score.getScoreInfo(), activePalette->text().color());
+    myScoreInfoBlock =
+        ScoreInfoRenderer::render(score.getScoreInfo(), ScoreColor::Default);
 
-    myRenderedSystems.reserve(static_cast<int>(score.getSystems().size()));
-    for (unsigned int i = 0; i < score.getSystems().size(); ++i)
-        myRenderedSystems.append(nullptr);
+    // The heights of the systems that haven't been rendered are estimated
+    // from the systems that were kept. If there are none, render the first
+    // system now.
+    if (num_systems > 0 && num_reused == 0)
+        myRenderedSystems[0] = createSystem(0, layouts[0]);
 
-#if 0
-    const int num_threads = std::thread::hardware_concurrency();
-#else
-    const int num_threads = 1;
-#endif
-    std::vector<std::future<void>> tasks;
-    const int work_size = myRenderedSystems.size() / num_threads;
-    qDebug() << "Using" << num_threads << "worker thread(s)";
-
-    for (int i = 0; i < num_threads; ++i)
+    double rendered_height = 0;
+    int num_rendered = 0;
+    for (const QGraphicsItem *system : myRenderedSystems)
     {
-        const int left = i * work_size;
-        const int right = (i == num_threads - 1) ? myRenderedSystems.size()
-                                                 : (i + 1) * work_size;
-
-        tasks.push_back(std::async(std::launch::async, [&](int left, int right)
+        if (system)
         {
-            for (int i = left; i < right; ++i)
-            {
-                SystemRenderer render(this, score, document.getViewOptions());
-                myRenderedSystems[i] = render(score.getSystems()[i], i);
-            }
-        }, left, right));
+            rendered_height += system->boundingRect().height();
+            ++num_rendered;
+        }
     }
-
-    for (auto &&task : tasks)
-        task.get();
+    const double estimated_height =
+        (num_rendered > 0 ? rendered_height / num_rendered : 0) +
+        SYSTEM_SPACING;
 
     double height = 0;
     // Score info.
     myScene.addItem(myScoreInfoBlock);
     height += myScoreInfoBlock->boundingRect().height() + 0.5 * SYSTEM_SPACING;
+    mySystemsTop = height;
 
     // Layout the systems.
-    for (QGraphicsItem *system : myRenderedSystems)
+    std::vector<double> heights;
+    heights.reserve(myRenderedSystems.size());
+    myPendingSystems.clear();
+
+    for (int i = 0; i < myRenderedSystems.size(); ++i)
     {
-        system->setPos(0, height);
-        myScene.addItem(system);
-        height += system->boundingRect().height() + SYSTEM_SPACING;
+        QGraphicsItem *system = myRenderedSystems[i];
+        if (system)
+        {
+            system->setPos(0, height);
+            {
+                RenderProfiler::ScopedTimer timer(
+                    RenderProfiler::Phase::SceneInsertion);
+                myScene.addItem(system);
+            }
+
+            heights.push_back(system->boundingRect().height() +
+                              SYSTEM_SPACING);
+        }
+        else
+        {
+            heights.push_back(estimated_height);
+            myPendingSystems.insert(i);
+        }
 
-        myCaretPainter->addSystemRect(system->sceneBoundingRect());
+        height += heights.back();
+
+        myCaretPainter->addSystem(layouts[i]);
     }
 
+    mySystemLayouts = std::move(layouts);
+
+    mySystemHeights = Util::FenwickTree<double>(heights);
+    myDisplacedSystems = Util::Displacements<double>(heights.size());
+    updateSceneRect();
+
     myScene.addItem(myCaretPainter);
 
+    // Render the visible systems now, and the remaining systems in the
+    // background.
+    updateVisibleSystems();
+    if (myPendingSystems.empty())
+        myIdleTimer.stop();
+    else
+        myIdleTimer.start();
+
     auto end = std::chrono::high_resolution_clock::now();
     qDebug() << "Score rendered in"
              << std::chrono::duration_cast<std::chrono::milliseconds>(
                     end - start).count() << "ms";
     qDebug() << "Rendered " << myScene.items().size() << "items";
+    qDebug() << "Reused" << num_reused << "unchanged system(s)";
+    qDebug() << myPendingSystems.size()
+             << "system(s) will be rendered in the background";
+    qDebug() << "Glyph cache:" << GlyphCache::getHitCount() << "hits,"
+             << GlyphCache::getMissCount() << "misses";
 }
 
 void ScoreArea::redrawSystem(int index)
 {
     // Delete and remove the system from the scene.
-    delete myRenderedSystems.takeAt(index);
+    delete myRenderedSystems[index];
+    myRenderedSystems[index] = nullptr;
 
+    // Only this system has changed, so update the running bar counts and
+    // player changes before computing its key.
     const Score &score = myDocument->getScore();
-    SystemRenderer render(this, score, myDocument->getViewOptions());
-    QGraphicsItem *newSystem = render(score.getSystems()[index], index);
+    const System &system = score.getSystems()[index];
+    myBarCounts.set(index, getBarCount(system));
+    if (system.getPlayerChanges().empty())
+        mySystemsWithPlayers.erase(index);
+    else
+        mySystemsWithPlayers.insert(index);
 
-    double height = 0;
-    if (index > 0)
+    mySystemKeys[index] = SystemKey(score, index, getBarNumber(index),
+                                    getPreviousPlayers(index));
+
+    renderSystem(index);
+
+    updateVisibleSystems();
+
+    // The spacing may have changed, so update the caret's position and redraw
+    // it.
+    myCaretPainter->updatePosition();
+}
+
+QGraphicsItem *ScoreArea::createSystem(
+    int index, std::vector<LayoutConstPtr> &layouts) const
+{
+    const Score &score = myDocument->getScore();
+    SystemRenderer render(myClickPubSub, score, myDocument->getViewOptions());
+
+    QGraphicsItem *system = render(score.getSystems()[index], index);
+    layouts = render.getLayouts();
+
+    return system;
+}
+
+void ScoreArea::renderSystem(int index)
+{
+    std::vector<LayoutConstPtr> layouts;
+    QGraphicsItem *system = createSystem(index, layouts);
+
+    system->setPos(0, getSystemTop(index));
     {
-        height = myRenderedSystems.at(index - 1)->sceneBoundingRect().bottom() +
-                SYSTEM_SPACING;
+        RenderProfiler::ScopedTimer timer(
+            RenderProfiler::Phase::SceneInsertion);
+        myScene.addItem(system);
     }
 
-    newSystem->setPos(0, height);
-    height += newSystem->boundingRect().height() + SYSTEM_SPACING;
-    myCaretPainter->setSystemRect(index, newSystem->sceneBoundingRect());
+    myRenderedSystems[index] = system;
+    myDisplacedSystems.reset(index);
+    myPendingSystems.erase(index);
+    myCaretPainter->setSystem(index, layouts);
+    mySystemLayouts[index] = std::move(layouts);
+
+    // If the height changed, the following systems need to be shifted. Rather
+    // than moving every system, only the offsets are updated and the systems
+    // are moved when they become visible.
+    const double height = system->boundingRect().height() + SYSTEM_SPACING;
+    if (height != mySystemHeights.get(index))
+    {
+        myDisplacedSystems.shift(index + 1,
+                                 height - mySystemHeights.get(index));
+        mySystemHeights.set(index, height);
+        updateSceneRect();
+    }
+}
 
-    myScene.addItem(newSystem);
-    myRenderedSystems.insert(index, newSystem);
+void ScoreArea::renderPendingSystems()
+{
+    const auto deadline =
+        std::chrono::steady_clock::now() + IDLE_RENDER_BUDGET;
 
-    // Shift the following systems.
-    for (int i = index + 1; i < myRenderedSystems.size(); ++i)
+    while (!myPendingSystems.empty() &&
+           std::chrono::steady_clock::now() < deadline)
     {
-        QGraphicsItem *system = myRenderedSystems[i];
-        system->setPos(0, height);
-        height += system->boundingRect().height() + SYSTEM_SPACING;
-        myCaretPainter->setSystemRect(i, system->sceneBoundingRect());
+        // Prefer the systems just below the visible area. After those, render
+        // the nearest systems above it.
+        const double visible_top =
+            mapToScene(viewport()->rect()).boundingRect().top();
+        const int first_visible = static_cast<int>(
+            mySystemHeights.find(visible_top - mySystemsTop));
+
+        auto it = myPendingSystems.lower_bound(first_visible);
+        if (it == myPendingSystems.end())
+            --it;
+        const int index = *it;
+
+        // If a system above the visible area changes height, scroll by the
+        // same amount so that the visible systems don't appear to move.
+        const double old_height = mySystemHeights.get(index);
+        const bool above_visible_area =
+            getSystemTop(index) + old_height <= visible_top;
+
+        renderSystem(index);
+
+        if (above_visible_area)
+        {
+            const double offset =
+                (mySystemHeights.get(index) - old_height) * transform().m22();
+            verticalScrollBar()->setValue(verticalScrollBar()->value() +
+                                          qRound(offset));
+        }
     }
 
-    // The spacing may have changed, so update the caret's position and redraw
-    // it.
-    myCaretPainter->updatePosition();
+    if (myPendingSystems.empty())
+        myIdleTimer.stop();
+
+    updateVisibleSystems();
+}
+
+void ScoreArea::renderAllSystems()
+{
+    while (!myPendingSystems.empty())
+        renderSystem(*myPendingSystems.begin());
+
+    myIdleTimer.stop();
+}
+
+int ScoreArea::getBarNumber(int index) const
+{
+    return 1 + myBarCounts.getPrefixSum(index);
+}
+
+const PlayerChange *ScoreArea::getPreviousPlayers(int index) const
+{
+    auto it = mySystemsWithPlayers.lower_bound(index);
+    if (it == mySystemsWithPlayers.begin())
+        return nullptr;
+
+    const System &system = myDocument->getScore().getSystems()[*std::prev(it)];
+    return &system.getPlayerChanges().back();
+}
+
+double ScoreArea::getSystemTop(int index) const
+{
+    return mySystemsTop + mySystemHeights.getPrefixSum(index);
+}
+
+QRectF ScoreArea::getSystemRect(int index) const
+{
+    if (const QGraphicsItem *system = myRenderedSystems.at(index))
+        return system->boundingRect().translated(0, getSystemTop(index));
+
+    // Until the system is rendered, use its estimated height.
+    return QRectF(0, getSystemTop(index), LayoutInfo::STAFF_WIDTH,
+                  mySystemHeights.get(index) - SYSTEM_SPACING);
+}
+
+void ScoreArea::updateSceneRect()
+{
+    // The systems aren't necessarily at their final locations (and some may
+    // not be rendered yet), so the scene's size can't be computed from its
+    // items.
+    const double width = std::max(LayoutInfo::STAFF_WIDTH,
+                                  myScoreInfoBlock->boundingRect().width());
+    myScene.setSceneRect(0, 0, width,
+                         mySystemsTop + mySystemHeights.getTotal());
+}
+
+void ScoreArea::updateVisibleSystems()
+{
+    const int num_systems = myRenderedSystems.size();
+    if (myDisplacedSystems.empty() && myPendingSystems.empty())
+        return;
+
+    auto moveSystem = [&](int index) {
+        if (myDisplacedSystems.get(index) != 0)
+        {
+            myRenderedSystems[index]->setPos(0, getSystemTop(index));
+            myDisplacedSystems.reset(index);
+        }
+    };
+
+    const QRectF visible_rect =
+        mapToScene(viewport()->rect()).boundingRect();
+
+    // Move the systems that should be visible.
+    for (int i = static_cast<int>(
+             mySystemHeights.find(visible_rect.top() - mySystemsTop));
+         i < num_systems && getSystemTop(i) <= visible_rect.bottom(); ++i)
+    {
+        // If the system was scrolled into view before it was rendered in the
+        // background, only wait for this system to be rendered.
+        if (myRenderedSystems[i])
+            moveSystem(i);
+        else
+            renderSystem(i);
+    }
+
+    // Move any systems which haven't been moved yet, but overlap the visible
+    // area from their previous location. Only the systems whose previous
+    // location overlaps the visible area are looked up, rather than checking
+    // every system that might be out of place.
+    std::vector<int> overlapping;
+    myDisplacedSystems.findOverlapping(
+        mySystemHeights, visible_rect.top() - mySystemsTop,
+        visible_rect.bottom() - mySystemsTop, [&](size_t index) {
+            if (myRenderedSystems[static_cast<int>(index)])
+                overlapping.push_back(static_cast<int>(index));
+        });
+
+    for (int index : overlapping)
+        moveSystem(index);
+}
+
+void ScoreArea::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    updateVisibleSystems();
+}
+
+void ScoreArea::resizeEvent(QResizeEvent *event)
+{
+    QGraphicsView::resizeEvent(event);
+    updateVisibleSystems();
 }
 
 void ScoreArea::print(QPrinter &printer)
@@ -171,60 +518,44 @@ void ScoreArea::print(QPrinter &printer)
     QPainter painter;
     painter.begin(&printer);
 
-    // use the printPalette for rendering
-    activePalette = &myPrintPalette;
+    // Use the print palette. The items look up their colors when painting,
+    // so the score doesn't need to be rendered again.
+    setActivePalette(&myPrintPalette);
 
     // Hide the caret when printing.
     myCaretPainter->hide();
 
-    //render the document after the palette has been set to print colors
-    this->renderDocument(*myDocument);
+    // Finish rendering any systems that are waiting to be rendered in the
+    // background.
+    renderAllSystems();
 
-    QRectF target_rect(0, 0, painter.device()->width(),
-                       painter.device()->height());
+    // Systems are otherwise only moved into place once they are visible.
+    for (int i = 0; i < myRenderedSystems.size(); ++i)
+        myRenderedSystems[i]->setPos(0, getSystemTop(i));
+    myDisplacedSystems = Util::Displacements<double>(myRenderedSystems.size());
 
     QList<QGraphicsItem*> items;
     items.append(myScoreInfoBlock);
     items.append(myRenderedSystems);
 
-    for (int i = 0, n = items.length(); i < n; ++i)
-    {
-        const QGraphicsItem *item = items[i];
-        const QRectF source_rect = item->sceneBoundingRect();
-        const float ratio =
-            std::min(target_rect.width() / source_rect.width(),
-                     target_rect.height() / source_rect.height());
+    const std::vector<std::vector<PageItem>> pages = paginate(
+        items, QSizeF(painter.device()->width(), painter.device()->height()));
 
+    for (size_t i = 0; i < pages.size(); ++i)
+    {
         if (i > 0)
-        {
-            const QGraphicsItem *prev_item = items[i - 1];
-            const double spacing =
-                source_rect.y() - prev_item->sceneBoundingRect().bottom();
-            target_rect.moveTop(target_rect.y() + spacing * ratio);
-        }
-
-        // Figure out how much space the item will take up on the page, and
-        // determine if we need a page break.
-        const float height = source_rect.height() * ratio;
-        if (target_rect.y() + height > painter.device()->height())
-        {
             printer.newPage();
-            target_rect.moveTop(0);
-        }
 
-        // Draw the system on the page.
-        scene()->render(&painter, target_rect, source_rect);
-
-        // Set the location for the next item.
-        target_rect.moveTop(target_rect.y() + height);
+        // Draw each system on the page.
+        for (const PageItem &item : pages[i])
+            scene()->render(&painter, item.myTarget, item.mySource);
     }
 
     myCaretPainter->show();
     painter.end();
 
-    // reuse the original app palette and render the document
-    activePalette = myScorePalette;
-    this->renderDocument(*myDocument);    
+    // Switch back to the original app palette.
+    setActivePalette(myScorePalette);
 }
 
 std::shared_ptr<ClickPubSub> ScoreArea::getClickPubSub() const
@@ -262,6 +593,8 @@ void ScoreArea::refreshZoom()
     QTransform xform;
     xform.scale(scale_factor, scale_factor);
     setTransform(xform);
+
+    updateVisibleSystems();
 }
 
 const QPalette *ScoreArea::getPalette() const
@@ -269,13 +602,22 @@ const QPalette *ScoreArea::getPalette() const
     return activePalette;
 }
 
+void ScoreArea::setActivePalette(const QPalette *palette)
+{
+    activePalette = palette;
+
+    // Repaint the score with the new colors.
+    myScene.setPalette(*activePalette);
+    myScene.update();
+}
+
 bool ScoreArea::event(QEvent *event)
 {
 
     QGraphicsView::event(event);
     if(event->type() == QEvent::PaletteChange)
     {
-        this->renderDocument(*myDocument);
+        setActivePalette(myScorePalette);
         return true;
     }
     else
@@ -19,14 +19,25 @@
 #define APP_SCOREAREA_H
 
 #include <memory>
+#include <optional>
+#include <painters/layoutinfo.h>
 #include <QGraphicsScene>
 #include <QGraphicsView>
-#include <score/staff.h>
+#include <QTimer>
+#include <score/player.h>
+#include <score/serialization.h>
+#include <score/viewfilter.h>
+#include <set>
+#include <util/displacements.h>
+#include <util/fenwicktree.h>
 
 class CaretPainter;
 class ClickPubSub;
 class Document;
+class PlayerChange;
 class QPrinter;
+class Score;
+class ViewOptions;
 
 /// The visual display of the score.
 class ScoreArea : public QGraphicsView
@@ -49,8 +60,8 @@ public:
 
     void print(QPrinter &printer);
 
-    /// Redraws the specified system, and shifts the following systems as
-    /// necessary.
+    /// Redraws the specified system. If its height changed, the following
+    /// systems are only moved once they are scrolled into view.
     void redrawSystem(int index);
 
     std::shared_ptr<ClickPubSub> getClickPubSub() const;
@@ -62,15 +73,108 @@ protected:
     virtual void focusInEvent(QFocusEvent *event) override;
     virtual void focusOutEvent(QFocusEvent *event) override;
     bool event(QEvent *event) override;
+    virtual void scrollContentsBy(int dx, int dy) override;
+    virtual void resizeEvent(QResizeEvent *event) override;
 
 private:
+    /// The settings that affect how every system is rendered. The palette is
+    /// not included since the colors are looked up when painting.
+    struct RenderSettings
+    {
+        RenderSettings() = default;
+        RenderSettings(const Score &score, const ViewOptions &view_options);
+
+        bool operator==(const RenderSettings &other) const;
+        bool operator!=(const RenderSettings &other) const;
+
+        std::optional<ViewFilter> myFilter;
+        std::vector<Player> myPlayers;
+        int myLineSpacing = 0;
+    };
+
+    /// The inputs that a system is rendered from, other than the render
+    /// settings. A full redraw only needs to re-render the systems whose
+    /// inputs have changed.
+    struct SystemKey
+    {
+        /// @param players The last player change before the system.
+        SystemKey(const Score &score, int index, int bar_number,
+                  const PlayerChange *players);
+
+        bool operator==(const SystemKey &other) const
+        {
+            return myDigest == other.myDigest;
+        }
+
+        /// A digest of the system, its bar number, the last player change
+        /// before it, and the first position of each voice in the next system
+        /// (since hammer-ons, pull-offs and slides can continue into it).
+        ScoreUtils::Digest myDigest;
+    };
+
     /// Adjusts the scroll location whenever the caret moves.
     void adjustScroll();
 
+    /// Sets the palette that the score is painted with.
+    void setActivePalette(const QPalette *palette);
+
+    /// Renders the system without adding it to the scene.
+    QGraphicsItem *createSystem(int index,
+                                std::vector<LayoutConstPtr> &layouts) const;
+    /// Renders the system and adds it to the scene, replacing its estimated
+    /// height.
+    void renderSystem(int index);
+    /// Renders the pending systems that are nearest to the visible area,
+    /// until the time budget for an idle callback is used up.
+    void renderPendingSystems();
+    /// Renders all of the pending systems.
+    void renderAllSystems();
+
+    /// Returns the number of the first bar in the system.
+    int getBarNumber(int index) const;
+    /// Returns the last player change before the system.
+    const PlayerChange *getPreviousPlayers(int index) const;
+    /// Returns the y-coordinate of the top of the system.
+    double getSystemTop(int index) const;
+    /// Returns the scene location of the system.
+    QRectF getSystemRect(int index) const;
+    /// Sizes the scene to fit the systems, using the estimated heights of
+    /// any pending systems.
+    void updateSceneRect();
+    /// Moves any systems that are out of place and overlap the visible area
+    /// of the scene.
+    void updateVisibleSystems();
+
     Scene myScene;
     const Document *myDocument;
     QGraphicsItem *myScoreInfoBlock;
+    /// The rendered systems, or null for systems that are waiting to be
+    /// rendered in the background.
     QList<QGraphicsItem *> myRenderedSystems;
+    /// The systems that haven't been rendered yet. These are rendered when
+    /// the application is idle, or as soon as they are scrolled into view.
+    std::set<int> myPendingSystems;
+    QTimer myIdleTimer;
+    /// The settings that the systems were rendered with.
+    RenderSettings myRenderSettings;
+    /// The inputs for each system.
+    std::vector<SystemKey> mySystemKeys;
+    /// The number of bars that start in each system, for finding the bar
+    /// numbers.
+    Util::FenwickTree<int> myBarCounts;
+    /// The systems that contain player changes.
+    std::set<int> mySystemsWithPlayers;
+    /// The layouts for each rendered system, which are shared with the caret.
+    std::vector<std::vector<LayoutConstPtr>> mySystemLayouts;
+    /// The height of each system, including the spacing below it. The offset
+    /// of a system is the sum of the heights of the systems before it. The
+    /// heights of pending systems are estimated.
+    Util::FenwickTree<double> mySystemHeights;
+    /// The y-coordinate of the first system.
+    double mySystemsTop;
+    /// How far each rendered system is from its correct location, since
+    /// systems are only moved when they are scrolled into view.
+    Util::Displacements<double> myDisplacedSystems;
     CaretPainter *myCaretPainter;
     const QPalette *myScorePalette; // the palette used by scorearea
     QPalette myPrintPalette; // the palette used by when printing
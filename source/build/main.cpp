@@ -220,6 +220,7 @@ int main(int argc, char *argv[])
 
     // Launch the application.
     program.show();
+    program.recoverAutosavedDocuments();
     program.openFiles(files_to_open);
 
     return a.exec();
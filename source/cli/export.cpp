@@ -0,0 +1,410 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <app/settingsmanager.h>
+#include <app/viewoptions.h>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <chrono>
+#include <formats/fileformatmanager.h>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <painters/scoreexporter.h>
+#include <QApplication>
+#include <QFontDatabase>
+#include <QPageLayout>
+#include <QPageSize>
+#include <score/score.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+const char *theUsage =
+    "Usage: pte_export [options] <input>...\n"
+    "\n"
+    "Renders each input file, or each supported file found by recursively\n"
+    "searching an input directory, to a PDF file, or to an SVG or PNG file\n"
+    "for each page. This does not require a display.\n"
+    "\n"
+    "Options:\n"
+    "  -f, --format <fmt>  Output format: pdf (the default), svg, or png.\n"
+    "  -o, --output <dir>  Write the exported files to this directory, keeping\n"
+    "                      the layout of any input directories. By default, each\n"
+    "                      file is written alongside its input file.\n"
+    "  -j, --jobs <n>      Number of PNG pages to compress in parallel. By\n"
+    "                      default, one page per core is compressed at a time.\n"
+    "  --page-size <size>  Page size: letter (the default) or a4.\n"
+    "  --width <pixels>    Width of the PNG images (800 by default).\n"
+    "  --overwrite         Replace existing output files rather than skipping\n"
+    "                      them.\n"
+    "  -h, --help          Show this message.\n";
+
+enum ExitCode
+{
+    EXIT_OK = 0,
+    EXIT_EXPORT_FAILED = 1,
+    EXIT_INVALID_ARGS = 2
+};
+
+/// The margins around each page, in millimetres.
+const double PAGE_MARGIN = 15;
+
+struct Options
+{
+    std::string myFormat = "pdf";
+    std::optional<fs::path> myOutputDir;
+    unsigned int myNumJobs = 0;
+    QPageSize::PageSizeId myPageSize = QPageSize::Letter;
+    int myImageWidth = 800;
+    bool myOverwrite = false;
+    bool myShowHelp = false;
+    std::vector<fs::path> myInputs;
+};
+
+/// A single file to export.
+struct Task
+{
+    fs::path mySource;
+    FileFormat mySourceFormat;
+    /// The output file, or the base name for the per-page files.
+    fs::path myDest;
+};
+
+/// @throw std::invalid_argument
+int parsePositiveInt(const std::string &arg, const std::string &value)
+{
+    int n = 0;
+    try
+    {
+        n = std::stoi(value);
+    }
+    catch (const std::exception &)
+    {
+    }
+
+    if (n <= 0)
+        throw std::invalid_argument("Invalid value for " + arg + ": " + value);
+    return n;
+}
+
+/// @throw std::invalid_argument
+Options parseArgs(int argc, char *argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        auto nextValue = [&]() -> std::string {
+            if (i + 1 >= argc)
+                throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help")
+            options.myShowHelp = true;
+        else if (arg == "-f" || arg == "--format")
+        {
+            options.myFormat = boost::algorithm::to_lower_copy(nextValue());
+            if (options.myFormat != "pdf" && options.myFormat != "svg" &&
+                options.myFormat != "png")
+            {
+                throw std::invalid_argument("Unsupported output format: " +
+                                            options.myFormat);
+            }
+        }
+        else if (arg == "-o" || arg == "--output")
+            options.myOutputDir = fs::path(nextValue());
+        else if (arg == "-j" || arg == "--jobs")
+        {
+            options.myNumJobs =
+                static_cast<unsigned int>(parsePositiveInt(arg, nextValue()));
+        }
+        else if (arg == "--page-size")
+        {
+            const std::string value =
+                boost::algorithm::to_lower_copy(nextValue());
+            if (value == "letter")
+                options.myPageSize = QPageSize::Letter;
+            else if (value == "a4")
+                options.myPageSize = QPageSize::A4;
+            else
+                throw std::invalid_argument("Unsupported page size: " + value);
+        }
+        else if (arg == "--width")
+            options.myImageWidth = parsePositiveInt(arg, nextValue());
+        else if (arg == "--overwrite")
+            options.myOverwrite = true;
+        else if (!arg.empty() && arg[0] == '-')
+            throw std::invalid_argument("Unknown option: " + arg);
+        else
+            options.myInputs.emplace_back(arg);
+    }
+
+    if (options.myShowHelp)
+        return options;
+
+    if (options.myInputs.empty())
+        throw std::invalid_argument("No input files were specified.");
+
+    return options;
+}
+
+/// Returns the file that is checked to see whether the input was already
+/// exported. For the per-page formats, this is the first page.
+fs::path getFirstOutputFile(const Options &options, const fs::path &dest)
+{
+    if (options.myFormat == "pdf")
+        return dest;
+
+    return fs::path(ScoreExporter::getPageFilename(
+                        QString::fromStdString(dest.string()), 1,
+                        QString::fromStdString(options.myFormat))
+                        .toStdString());
+}
+
+/// Finds the files to export.
+/// @return False if any of the inputs could not be used.
+bool collectTasks(const Options &options, const FileFormatManager &manager,
+                  std::vector<Task> &tasks)
+{
+    bool valid = true;
+
+    auto addTask = [&](const fs::path &source, const FileFormat &format,
+                       fs::path dest) {
+        // The per-page formats add the page number to the file name.
+        if (options.myFormat == "pdf")
+            dest.replace_extension(options.myFormat);
+        else
+            dest.replace_extension();
+
+        const fs::path output = getFirstOutputFile(options, dest);
+        if (fs::exists(output) && !options.myOverwrite)
+        {
+            std::cout << "Skipping " << source.string() << ": "
+                      << output.string() << " already exists." << std::endl;
+            return;
+        }
+
+        tasks.push_back({ source, format, dest });
+    };
+
+    for (const fs::path &input : options.myInputs)
+    {
+        if (fs::is_directory(input))
+        {
+            for (const fs::directory_entry &entry :
+                 fs::recursive_directory_iterator(input))
+            {
+                if (!fs::is_regular_file(entry.status()))
+                    continue;
+
+                const fs::path &source = entry.path();
+                std::optional<FileFormat> format =
+                    manager.findImportFormat(source);
+                if (!format)
+                    continue;
+
+                fs::path dest = source;
+                if (options.myOutputDir)
+                    dest = *options.myOutputDir / fs::relative(source, input);
+
+                addTask(source, *format, dest);
+            }
+        }
+        else if (fs::is_regular_file(input))
+        {
+            std::optional<FileFormat> format =
+                manager.findImportFormat(input);
+            if (!format)
+            {
+                std::cerr << "Error: " << input.string()
+                          << " is not a supported file type." << std::endl;
+                valid = false;
+                continue;
+            }
+
+            fs::path dest = input;
+            if (options.myOutputDir)
+                dest = *options.myOutputDir / input.filename();
+
+            addTask(input, *format, dest);
+        }
+        else
+        {
+            std::cerr << "Error: " << input.string() << " does not exist."
+                      << std::endl;
+            valid = false;
+        }
+    }
+
+    return valid;
+}
+
+void writeFiles(const Options &options, const ScoreExporter &exporter,
+                const fs::path &dest)
+{
+    const QString filename = QString::fromStdString(dest.string());
+
+    if (options.myFormat == "pdf")
+        exporter.exportPdf(filename);
+    else if (options.myFormat == "svg")
+        exporter.exportSvg(filename);
+    else
+    {
+        exporter.exportPng(filename, options.myImageWidth,
+                           options.myNumJobs);
+    }
+}
+
+/// Exports a single file, and reports the time taken.
+/// The score is laid out and its pages are drawn on this (the GUI) thread,
+/// and then PNG pages are compressed in parallel.
+/// @return False if the export failed.
+bool exportFile(const Options &options, const Task &task,
+                FileFormatManager &manager, const QPageLayout &page_layout,
+                const ViewOptions &view_options)
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    const auto start = std::chrono::steady_clock::now();
+    int num_pages = 0;
+
+    try
+    {
+        std::unique_ptr<ScoreExporter> exporter;
+        {
+            Score score;
+            manager.importFile(score, task.mySource, task.mySourceFormat);
+            exporter = std::make_unique<ScoreExporter>(score, view_options,
+                                                       page_layout);
+        }
+
+        if (task.myDest.has_parent_path())
+            fs::create_directories(task.myDest.parent_path());
+
+        writeFiles(options, *exporter, task.myDest);
+        num_pages = exporter->getPageCount();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Failed to export " << task.mySource.string() << ": "
+                  << e.what() << std::endl;
+        return false;
+    }
+
+    const Milliseconds elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::fixed << std::setprecision(1) << std::setw(9)
+              << elapsed.count() << " ms  " << task.mySource.string()
+              << " -> " << task.myDest.string() << " (" << num_pages
+              << (num_pages == 1 ? " page)" : " pages)") << std::endl;
+    return true;
+}
+
+/// Exports each file.
+/// @return The number of files that failed to export.
+int runTasks(const Options &options, const std::vector<Task> &tasks,
+             FileFormatManager &manager)
+{
+    const QPageLayout page_layout(QPageSize(options.myPageSize),
+                                  QPageLayout::Portrait,
+                                  QMarginsF(PAGE_MARGIN, PAGE_MARGIN,
+                                            PAGE_MARGIN, PAGE_MARGIN),
+                                  QPageLayout::Millimeter);
+    const ViewOptions view_options;
+
+    int num_failed = 0;
+    for (const Task &task : tasks)
+    {
+        if (!exportFile(options, task, manager, page_layout, view_options))
+            ++num_failed;
+    }
+
+    return num_failed;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    try
+    {
+        options = parseArgs(argc, argv);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n" << theUsage;
+        return EXIT_INVALID_ARGS;
+    }
+
+    if (options.myShowHelp)
+    {
+        std::cout << theUsage;
+        return EXIT_OK;
+    }
+
+    // Render without a display, unless another platform was requested.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    // Load the fonts that the score is drawn with.
+    QFontDatabase::addApplicationFont(":fonts/emmentaler-13.otf");
+    QFontDatabase::addApplicationFont(":fonts/LiberationSans-Regular.ttf");
+    QFontDatabase::addApplicationFont(":fonts/LiberationSerif-Regular.ttf");
+
+    // Use the default settings rather than the user's settings from the
+    // editor.
+    SettingsManager settings_manager;
+    FileFormatManager manager(settings_manager);
+
+    std::vector<Task> tasks;
+    bool success = true;
+    try
+    {
+        success = collectTasks(options, manager, tasks);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_EXPORT_FAILED;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const int num_failed = runTasks(options, tasks, manager);
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    const int num_tasks = static_cast<int>(tasks.size());
+    std::cout << "Exported " << (num_tasks - num_failed) << " of "
+              << num_tasks << " files in " << std::fixed
+              << std::setprecision(2) << elapsed.count() << " s";
+    if (num_failed > 0)
+        std::cout << " (" << num_failed << " failed)";
+    std::cout << std::endl;
+
+    return (success && num_failed == 0) ? EXIT_OK : EXIT_EXPORT_FAILED;
+}
@@ -0,0 +1,376 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <app/settingsmanager.h>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <chrono>
+#include <formats/fileformatmanager.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <score/score.h>
+#include <stdexcept>
+#include <string>
+#include <util/parallel.h>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+const char *theUsage =
+    "Usage: pte_convert [options] <input>...\n"
+    "\n"
+    "Converts each input file, or each supported file found by recursively\n"
+    "searching an input directory, to another file format.\n"
+    "\n"
+    "Options:\n"
+    "  -f, --format <ext>  File extension of the output format (e.g. pt2, mid).\n"
+    "  -o, --output <dir>  Write the converted files to this directory, keeping\n"
+    "                      the layout of any input directories. By default, each\n"
+    "                      file is written alongside its input file.\n"
+    "  -j, --jobs <n>      Number of files to convert in parallel. By default,\n"
+    "                      one file per core is converted at a time.\n"
+    "  --overwrite         Replace existing output files rather than skipping\n"
+    "                      them.\n"
+    "  -h, --help          Show this message.\n";
+
+enum ExitCode
+{
+    EXIT_OK = 0,
+    EXIT_CONVERSION_FAILED = 1,
+    EXIT_INVALID_ARGS = 2
+};
+
+struct Options
+{
+    std::string myFormat;
+    std::optional<fs::path> myOutputDir;
+    unsigned int myNumJobs = 0;
+    bool myOverwrite = false;
+    bool myShowHelp = false;
+    std::vector<fs::path> myInputs;
+};
+
+/// A single file to convert.
+struct Task
+{
+    fs::path mySource;
+    FileFormat mySourceFormat;
+    fs::path myDest;
+};
+
+/// @throw std::invalid_argument
+Options parseArgs(int argc, char *argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        auto nextValue = [&]() -> std::string {
+            if (i + 1 >= argc)
+                throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help")
+            options.myShowHelp = true;
+        else if (arg == "-f" || arg == "--format")
+            options.myFormat = boost::algorithm::to_lower_copy(nextValue());
+        else if (arg == "-o" || arg == "--output")
+            options.myOutputDir = fs::path(nextValue());
+        else if (arg == "-j" || arg == "--jobs")
+        {
+            const std::string value = nextValue();
+            int num_jobs = 0;
+            try
+            {
+                num_jobs = std::stoi(value);
+            }
+            catch (const std::exception &)
+            {
+            }
+
+            if (num_jobs <= 0)
+                throw std::invalid_argument("Invalid number of jobs: " + value);
+            options.myNumJobs = static_cast<unsigned int>(num_jobs);
+        }
+        else if (arg == "--overwrite")
+            options.myOverwrite = true;
+        else if (!arg.empty() && arg[0] == '-')
+            throw std::invalid_argument("Unknown option: " + arg);
+        else
+            options.myInputs.emplace_back(arg);
+    }
+
+    if (options.myShowHelp)
+        return options;
+
+    if (options.myFormat.empty())
+        throw std::invalid_argument("An output format must be specified.");
+    if (options.myInputs.empty())
+        throw std::invalid_argument("No input files were specified.");
+
+    return options;
+}
+
+/// Removes any tasks that would write to the same output file (e.g. song.gp5
+/// and song.gpx both converting to song.pt2), since the result would depend
+/// on which task finished last.
+/// @return False if there were any conflicts.
+bool removeConflictingTasks(std::vector<Task> &tasks)
+{
+    std::map<fs::path, std::vector<size_t>> tasks_by_dest;
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        tasks_by_dest[fs::absolute(tasks[i].myDest).lexically_normal()]
+            .push_back(i);
+    }
+
+    std::vector<bool> conflicts(tasks.size(), false);
+    bool valid = true;
+    for (const auto &[dest, indices] : tasks_by_dest)
+    {
+        if (indices.size() < 2)
+            continue;
+
+        valid = false;
+        std::cerr << "Error: multiple inputs would be converted to "
+                  << dest.string() << ":" << std::endl;
+        for (size_t i : indices)
+        {
+            std::cerr << "  " << tasks[i].mySource.string() << std::endl;
+            conflicts[i] = true;
+        }
+    }
+
+    std::vector<Task> remaining;
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        if (!conflicts[i])
+            remaining.push_back(std::move(tasks[i]));
+    }
+    tasks = std::move(remaining);
+
+    return valid;
+}
+
+/// Finds the files to convert.
+/// @return False if any of the inputs could not be used.
+bool collectTasks(const Options &options, const FileFormatManager &manager,
+                  std::vector<Task> &tasks)
+{
+    bool valid = true;
+
+    auto addTask = [&](const fs::path &source, const FileFormat &format,
+                       fs::path dest) {
+        dest.replace_extension(options.myFormat);
+
+        if (fs::exists(dest) && !options.myOverwrite)
+        {
+            std::cout << "Skipping " << source.string() << ": "
+                      << dest.string() << " already exists." << std::endl;
+            return;
+        }
+
+        tasks.push_back({ source, format, dest });
+    };
+
+    for (const fs::path &input : options.myInputs)
+    {
+        if (fs::is_directory(input))
+        {
+            for (const fs::directory_entry &entry :
+                 fs::recursive_directory_iterator(input))
+            {
+                if (!fs::is_regular_file(entry.status()))
+                    continue;
+
+                const fs::path &source = entry.path();
+                std::optional<FileFormat> format =
+                    manager.findImportFormat(source);
+                if (!format)
+                    continue;
+
+                fs::path dest = source;
+                if (options.myOutputDir)
+                    dest = *options.myOutputDir / fs::relative(source, input);
+
+                addTask(source, *format, dest);
+            }
+        }
+        else if (fs::is_regular_file(input))
+        {
+            std::optional<FileFormat> format =
+                manager.findImportFormat(input);
+            if (!format)
+            {
+                std::cerr << "Error: " << input.string()
+                          << " is not a supported file type." << std::endl;
+                valid = false;
+                continue;
+            }
+
+            fs::path dest = input;
+            if (options.myOutputDir)
+                dest = *options.myOutputDir / input.filename();
+
+            addTask(input, *format, dest);
+        }
+        else
+        {
+            std::cerr << "Error: " << input.string() << " does not exist."
+                      << std::endl;
+            valid = false;
+        }
+    }
+
+    // Check for conflicts before any files are written.
+    if (!removeConflictingTasks(tasks))
+        valid = false;
+
+    return valid;
+}
+
+/// Converts each file on a pool of worker threads, and reports the time
+/// taken for each file.
+/// @return The number of files that failed to convert.
+int runTasks(const std::vector<Task> &tasks, FileFormatManager &manager,
+             const FileFormat &output_format, unsigned int num_jobs)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    std::mutex output_mutex;
+    int num_failed = 0;
+
+    // The importers and exporters don't have any state, so the files can be
+    // converted independently.
+    Util::parallelFor(
+        tasks.size(),
+        [&](size_t i) {
+            const Task &task = tasks[i];
+            const Clock::time_point start = Clock::now();
+
+            std::string error;
+            try
+            {
+                Score score;
+                manager.importFile(score, task.mySource, task.mySourceFormat);
+
+                if (task.myDest.has_parent_path())
+                    fs::create_directories(task.myDest.parent_path());
+                manager.exportFile(score, task.myDest, output_format);
+            }
+            catch (const std::exception &e)
+            {
+                error = e.what();
+            }
+            catch (...)
+            {
+                error = "Unknown error";
+            }
+
+            const Milliseconds elapsed = Clock::now() - start;
+
+            std::lock_guard<std::mutex> lock(output_mutex);
+            if (error.empty())
+            {
+                std::cout << std::fixed << std::setprecision(1) << std::setw(9)
+                          << elapsed.count() << " ms  "
+                          << task.mySource.string() << " -> "
+                          << task.myDest.string() << std::endl;
+            }
+            else
+            {
+                ++num_failed;
+                std::cerr << "Failed to convert " << task.mySource.string()
+                          << ": " << error << std::endl;
+            }
+        },
+        num_jobs);
+
+    return num_failed;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    try
+    {
+        options = parseArgs(argc, argv);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n" << theUsage;
+        return EXIT_INVALID_ARGS;
+    }
+
+    if (options.myShowHelp)
+    {
+        std::cout << theUsage;
+        return EXIT_OK;
+    }
+
+    // Use the default settings (e.g. for the MIDI exporter) rather than the
+    // user's settings from the editor.
+    SettingsManager settings_manager;
+    FileFormatManager manager(settings_manager);
+
+    std::optional<FileFormat> output_format =
+        manager.findExportFormat(options.myFormat);
+    if (!output_format)
+    {
+        std::cerr << "Error: unsupported output format: " << options.myFormat
+                  << std::endl;
+        return EXIT_INVALID_ARGS;
+    }
+
+    std::vector<Task> tasks;
+    bool success = true;
+    try
+    {
+        success = collectTasks(options, manager, tasks);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_CONVERSION_FAILED;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const int num_failed =
+        runTasks(tasks, manager, *output_format, options.myNumJobs);
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    const int num_tasks = static_cast<int>(tasks.size());
+    std::cout << "Converted " << (num_tasks - num_failed) << " of "
+              << num_tasks << " files in " << std::fixed
+              << std::setprecision(2) << elapsed.count() << " s";
+    if (num_failed > 0)
+        std::cout << " (" << num_failed << " failed)";
+    std::cout << std::endl;
+
+    return (success && num_failed == 0) ? EXIT_OK : EXIT_CONVERSION_FAILED;
+}
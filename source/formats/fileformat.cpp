@@ -17,7 +17,10 @@
   
 #include "fileformat.h"
 
+#include "scoremetadata.h"
+
 #include <algorithm>
+#include <score/score.h>
 
 FileFormat::FileFormat(const std::string &name,
                        const std::vector<std::string> &fileExtensions)
@@ -66,6 +69,19 @@ FileFormatImporter::~FileFormatImporter()
 {
 }
 
+ScoreMetadata FileFormatImporter::probe(
+    const boost::filesystem::path &filename)
+{
+    Score score;
+    load(filename, score);
+    return ScoreMetadata::fromScore(score);
+}
+
+bool FileFormatImporter::canRead(std::string_view) const
+{
+    return false;
+}
+
 FileFormat FileFormatImporter::fileFormat() const
 {
     return myFormat;
@@ -21,9 +21,11 @@
 #include <boost/filesystem/path.hpp>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class Score;
+struct ScoreMetadata;
 
 class FileFormat
 {
@@ -60,6 +62,23 @@ public:
     virtual void load(const boost::filesystem::path &filename,
                       Score &score) = 0;
 
+    /// Reads summary information (title, instruments, etc) about the file.
+    /// Importers should override this to read as little of the file as
+    /// possible. By default, the entire file is imported.
+    /// This may be called concurrently from multiple threads.
+    /// @throw FileFormatException
+    virtual ScoreMetadata probe(const boost::filesystem::path &filename);
+
+    /// Returns whether the file appears to be in this format, based on the
+    /// first few bytes of its contents (e.g. a magic number or version
+    /// string). By default, nothing is recognized.
+    /// This may be called concurrently from multiple threads.
+    /// @param header Up to HEADER_SIZE bytes from the start of the file.
+    virtual bool canRead(std::string_view header) const;
+
+    /// The maximum number of bytes that are read for format detection.
+    static constexpr size_t HEADER_SIZE = 4096;
+
     /// Returns the file format corresponding to this importer.
     FileFormat fileFormat() const;
 
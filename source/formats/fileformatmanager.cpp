@@ -17,13 +17,22 @@
   
 #include "fileformatmanager.h"
 
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <formats/gp7/gp7importer.h>
 #include <formats/gpx/gpximporter.h>
 #include <formats/guitar_pro/guitarproimporter.h>
 #include <formats/midi/midiexporter.h>
+#include <formats/midi/midiimporter.h>
 #include <formats/powertab/powertabexporter.h>
 #include <formats/powertab/powertabimporter.h>
 #include <formats/powertab_old/powertaboldimporter.h>
+#include <util/parallel.h>
+#include <util/scopeexit.h>
+
+#include <algorithm>
+#include <array>
 
 FileFormatManager::FileFormatManager(const SettingsManager &settings_manager)
 {
@@ -32,6 +41,7 @@ FileFormatManager::FileFormatManager(const SettingsManager &settings_manager)
     myImporters.emplace_back(new GuitarProImporter());
     myImporters.emplace_back(new GpxImporter());
     myImporters.emplace_back(new Gp7Importer());
+    myImporters.emplace_back(new MidiImporter());
 
     myExporters.emplace_back(new PowerTabExporter());
     myExporters.emplace_back(new MidiExporter(settings_manager));
@@ -55,6 +65,45 @@ std::optional<FileFormat> FileFormatManager::findFormat(
     return std::nullopt;
 }
 
+std::optional<FileFormat> FileFormatManager::findImportFormat(
+    const std::string &extension) const
+{
+    if (FileFormatImporter *importer = findImporter(extension))
+        return importer->fileFormat();
+
+    return std::nullopt;
+}
+
+std::optional<FileFormat> FileFormatManager::findExportFormat(
+    const std::string &extension) const
+{
+    for (auto &exporter : myExporters)
+    {
+        if (exporter->fileFormat().contains(extension))
+            return exporter->fileFormat();
+    }
+
+    return std::nullopt;
+}
+
+std::optional<FileFormat> FileFormatManager::detectFormat(
+    const boost::filesystem::path &filename) const
+{
+    if (FileFormatImporter *importer = detectImporter(filename))
+        return importer->fileFormat();
+
+    return std::nullopt;
+}
+
+std::optional<FileFormat> FileFormatManager::findImportFormat(
+    const boost::filesystem::path &filename) const
+{
+    if (FileFormatImporter *importer = findImporter(filename))
+        return importer->fileFormat();
+
+    return std::nullopt;
+}
+
 std::string FileFormatManager::importFileFilter() const
 {
     std::string filterAll = "All Supported Formats (";
@@ -91,6 +140,120 @@ void FileFormatManager::importFile(Score &score,
     throw std::runtime_error("Unknown file format");
 }
 
+ScoreMetadata FileFormatManager::probeFile(
+    const boost::filesystem::path &filename, const FileFormat &format)
+{
+    for (auto &importer : myImporters)
+    {
+        if (importer->fileFormat() == format)
+            return importer->probe(filename);
+    }
+
+    throw std::runtime_error("Unknown file format");
+}
+
+FileFormatImporter *FileFormatManager::findImporter(
+    const std::string &extension) const
+{
+    for (auto &importer : myImporters)
+    {
+        if (importer->fileFormat().contains(extension))
+            return importer.get();
+    }
+
+    return nullptr;
+}
+
+FileFormatImporter *FileFormatManager::detectImporter(
+    const boost::filesystem::path &filename) const
+{
+    // Only read the start of the file, since the importers only need to look
+    // at the header.
+    boost::filesystem::ifstream file(filename,
+                                     std::ios::in | std::ios::binary);
+    if (!file)
+        return nullptr;
+
+    std::array<char, FileFormatImporter::HEADER_SIZE> buffer;
+    file.read(buffer.data(), buffer.size());
+    if (file.gcount() <= 0)
+        return nullptr;
+
+    const std::string_view header(buffer.data(),
+                                  static_cast<size_t>(file.gcount()));
+    for (auto &importer : myImporters)
+    {
+        if (importer->canRead(header))
+            return importer.get();
+    }
+
+    return nullptr;
+}
+
+FileFormatImporter *FileFormatManager::findImporter(
+    const boost::filesystem::path &filename) const
+{
+    if (FileFormatImporter *importer = detectImporter(filename))
+        return importer;
+
+    return findExtensionImporter(filename);
+}
+
+FileFormatImporter *FileFormatManager::findExtensionImporter(
+    const boost::filesystem::path &filename) const
+{
+    // Strip the leading '.' from the extension.
+    const std::string extension =
+        boost::algorithm::to_lower_copy(filename.extension().string());
+    return extension.empty() ? nullptr : findImporter(extension.substr(1));
+}
+
+std::vector<FileFormatManager::ProbeResult> FileFormatManager::probeDirectory(
+    const boost::filesystem::path &dir)
+{
+    namespace fs = boost::filesystem;
+
+    std::vector<ProbeResult> results;
+
+    // Only look for files with a supported extension, so that the walk
+    // doesn't need to open every file in the directory.
+    for (const fs::directory_entry &entry :
+         fs::recursive_directory_iterator(dir))
+    {
+        if (!fs::is_regular_file(entry.status()) ||
+            !findExtensionImporter(entry.path()))
+        {
+            continue;
+        }
+
+        ProbeResult result;
+        result.myFilename = entry.path();
+        results.push_back(std::move(result));
+    }
+
+    // The importers don't have any state, so each file can be read on a
+    // separate thread. The file's header is checked in case its extension
+    // doesn't match its format.
+    Util::parallelFor(results.size(), [&](size_t i) {
+        try
+        {
+            FileFormatImporter *importer = findImporter(results[i].myFilename);
+            results[i].myMetadata = importer->probe(results[i].myFilename);
+        }
+        catch (const std::exception &e)
+        {
+            results[i].myError = e.what();
+        }
+    });
+
+    std::sort(results.begin(), results.end(),
+              [](const ProbeResult &a, const ProbeResult &b) {
+                  return a.myFilename < b.myFilename;
+              });
+
+    return results;
+}
+
 std::string FileFormatManager::exportFileFilter() const
 {
     std::string filter;
@@ -106,16 +269,58 @@ std::string FileFormatManager::exportFileFilter() const
     return filter;
 }
 
-void FileFormatManager::exportFile(const Score &score,
+bool FileFormatManager::exportFile(const Score &score,
                                    const boost::filesystem::path &filename,
-                                   const FileFormat &format)
+                                   const FileFormat &format,
+                                   const std::atomic<bool> *cancelled)
 {
     for (auto &exporter : myExporters)
     {
         if (exporter->fileFormat() == format)
         {
-            exporter->save(filename, score);
-            return;
+            // Write to a temporary file in the same directory, so that the
+            // final rename doesn't need to cross filesystems.
+            boost::filesystem::path temp_path = filename;
+            temp_path += boost::filesystem::unique_path(".%%%%-%%%%.tmp");
+
+            bool committed = false;
+            Util::ScopeExit cleanup([&]() {
+                if (!committed)
+                {
+                    boost::system::error_code ec;
+                    boost::filesystem::remove(temp_path, ec);
+                }
+            });
+
+            auto isCancelled = [&]() { return cancelled && *cancelled; };
+
+            // The exporter writes the file in one step, so cancellation can
+            // only be checked between the stages of the export.
+            if (isCancelled())
+                return false;
+
+            exporter->save(temp_path, score);
+
+            if (isCancelled())
+                return false;
+
+            // Keep the permissions of the file being replaced. This is best
+            // effort, since some filesystems don't support permissions.
+            boost::system::error_code ec;
+            const boost::filesystem::file_status status =
+                boost::filesystem::status(filename, ec);
+            if (!ec && boost::filesystem::exists(status))
+            {
+                boost::filesystem::permissions(temp_path, status.permissions(),
+                                               ec);
+            }
+
+            if (isCancelled())
+                return false;
+
+            boost::filesystem::rename(temp_path, filename);
+            committed = true;
+            return true;
         }
     }
 
@@ -19,7 +19,9 @@
 #define FORMATS_FILEFORMATMANAGER_H
 
 #include "fileformat.h"
+#include "scoremetadata.h"
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -38,6 +40,26 @@ public:
     /// Returns the file format corresponding to the given extension.
     std::optional<FileFormat> findFormat(const std::string &extension) const;
 
+    /// Returns the importable file format for the given extension.
+    std::optional<FileFormat> findImportFormat(
+        const std::string &extension) const;
+
+    /// Returns the exportable file format for the given extension.
+    std::optional<FileFormat> findExportFormat(
+        const std::string &extension) const;
+
+    /// Determines the importable file format from the file's contents, rather
+    /// than its extension. Only the first few bytes of the file are read.
+    /// @returns An empty value if the file could not be read or the format was
+    /// not recognized.
+    std::optional<FileFormat> detectFormat(
+        const boost::filesystem::path &filename) const;
+
+    /// Returns the importable file format for the file, preferring the format
+    /// detected from the file's contents over its extension.
+    std::optional<FileFormat> findImportFormat(
+        const boost::filesystem::path &filename) const;
+
     /// Returns a correctly formatted file filter for a Qt file dialog.
     /// e.g. "FileType (*.ext1 *.ext2);;FileType2 (*.ext3)".
     std::string importFileFilter() const;
@@ -47,15 +69,58 @@ public:
     void importFile(Score &score, const boost::filesystem::path &filename,
                     const FileFormat &format);
 
+    /// Reads summary information about a file, without necessarily importing
+    /// the entire file.
+    /// @throws std::exception
+    ScoreMetadata probeFile(const boost::filesystem::path &filename,
+                            const FileFormat &format);
+
+    struct ProbeResult
+    {
+        boost::filesystem::path myFilename;
+        /// Empty if the file could not be read.
+        std::optional<ScoreMetadata> myMetadata;
+        std::string myError;
+    };
+
+    /// Recursively probes each file in the directory that has a supported
+    /// extension. The files are read in parallel, and the results are sorted
+    /// by filename.
+    /// @throws std::exception if the directory cannot be listed.
+    std::vector<ProbeResult> probeDirectory(
+        const boost::filesystem::path &dir);
+
     /// Returns a correctly formatted file filter for a Qt file dialog.
     std::string exportFileFilter() const;
 
     /// Exports the given score to a file.
+    /// The data is written to a temporary file which then replaces the
+    /// destination, so an existing file is never left partially written.
+    /// The permissions of an existing destination file are preserved.
+    /// This may be called from a worker thread.
+    /// @param cancelled If this flag is set before the new file is committed,
+    /// the temporary file is discarded and the destination is not modified.
+    /// @return False if the export was cancelled.
     /// @throws std::exception
-    void exportFile(const Score &score, const boost::filesystem::path &filename,
-                    const FileFormat &format);
+    bool exportFile(const Score &score, const boost::filesystem::path &filename,
+                    const FileFormat &format,
+                    const std::atomic<bool> *cancelled = nullptr);
 
 private:
+    /// Returns the importer for the given extension, if there is one.
+    FileFormatImporter *findImporter(const std::string &extension) const;
+    /// Returns the importer that recognizes the file's contents, if any.
+    FileFormatImporter *detectImporter(
+        const boost::filesystem::path &filename) const;
+    /// Returns the importer for the file, based on either its contents or
+    /// its extension.
+    FileFormatImporter *findImporter(
+        const boost::filesystem::path &filename) const;
+    /// Returns the importer for the file's extension, without reading the
+    /// file.
+    FileFormatImporter *findExtensionImporter(
+        const boost::filesystem::path &filename) const;
+
     template <typename Importer>
     void registerImporter();
 
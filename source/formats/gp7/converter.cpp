@@ -23,6 +23,7 @@
 #include <numeric>
 
 #include <formats/fileformat.h>
+#include <formats/scoremetadata.h>
 #include <score/generalmidi.h>
 #include <score/keysignature.h>
 #include <score/note.h>
@@ -41,8 +42,8 @@
 #include <iostream>
 
 /// Convert the Guitar Pro file metadata.
-static void
-convertScoreInfo(const Gp7::ScoreInfo &gp_info, Score &score)
+static ScoreInfo
+convertScoreInfo(const Gp7::ScoreInfo &gp_info)
 {
     ScoreInfo info;
     SongData data;
@@ -63,7 +64,7 @@ convertScoreInfo(const Gp7::ScoreInfo &gp_info, Score &score)
     // Skipping Notices since there isn't an equivalent.
 
     info.setSongData(data);
-    score.setScoreInfo(info);
+    return info;
 }
 
 /// Create players and instruments from the Guitar Pro tracks, and the initial
@@ -543,6 +544,28 @@ convertAlternateEndings(System &system, int bar_pos,
     system.insertAlternateEnding(ending);
 }
 
+static TempoMarker::BeatType
+convertBeatType(Gp7::TempoChange::BeatType beat_type)
+{
+    switch (beat_type)
+    {
+        using BeatType = Gp7::TempoChange::BeatType;
+
+        case BeatType::Eighth:
+            return TempoMarker::Eighth;
+        case BeatType::Half:
+            return TempoMarker::Half;
+        case BeatType::HalfDotted:
+            return TempoMarker::HalfDotted;
+        case BeatType::Quarter:
+            return TempoMarker::Quarter;
+        case BeatType::QuarterDotted:
+            return TempoMarker::QuarterDotted;
+    }
+
+    return TempoMarker::Quarter;
+}
+
 static void
 convertTempoMarkers(System &system, int bar_pos,
                     const Gp7::MasterBar &master_bar)
@@ -557,27 +580,7 @@ convertTempoMarkers(System &system, int bar_pos,
     const Gp7::TempoChange &gp_tempo = master_bar.myTempoChanges[0];
 
     TempoMarker marker;
-    switch (gp_tempo.myBeatType)
-    {
-        using BeatType = Gp7::TempoChange::BeatType;
-
-        case BeatType::Eighth:
-            marker.setBeatType(TempoMarker::Eighth);
-            break;
-        case BeatType::Half:
-            marker.setBeatType(TempoMarker::Half);
-            break;
-        case BeatType::HalfDotted:
-            marker.setBeatType(TempoMarker::HalfDotted);
-            break;
-        case BeatType::Quarter:
-            marker.setBeatType(TempoMarker::Quarter);
-            break;
-        case BeatType::QuarterDotted:
-            marker.setBeatType(TempoMarker::QuarterDotted);
-            break;
-    }
-
+    marker.setBeatType(convertBeatType(gp_tempo.myBeatType));
     marker.setBeatsPerMinute(gp_tempo.myBeatsPerMinute);
     marker.setDescription(gp_tempo.myDescription);
 
@@ -1103,7 +1106,7 @@ isValidLayout(const std::vector<int> &layout, int num_bars)
 void
 Gp7::convert(const Gp7::Document &doc, Score &score)
 {
-    convertScoreInfo(doc.myScoreInfo, score);
+    score.setScoreInfo(convertScoreInfo(doc.myScoreInfo));
 
     // The multi-track layout is sometimes invalid (particularly for .gpx
     // files). So, fall back to the first track's layout if we need to.
@@ -1128,3 +1131,44 @@ Gp7::convert(const Gp7::Document &doc, Score &score)
     ScoreUtils::polishScore(score);
     ScoreUtils::addStandardFilters(score);
 }
+
+ScoreMetadata
+Gp7::convertMetadata(const Gp7::Document &doc)
+{
+    ScoreMetadata metadata;
+    metadata.myScoreInfo = convertScoreInfo(doc.myScoreInfo);
+
+    // Each staff is imported as a separate player.
+    for (const Gp7::Track &track : doc.myTracks)
+    {
+        for (const Gp7::Staff &staff : track.myStaves)
+        {
+            const int string_count =
+                staff.myTuning.empty()
+                    ? Tuning().getStringCount()
+                    : static_cast<int>(staff.myTuning.size());
+            metadata.myInstruments.push_back({ track.myName, string_count });
+        }
+    }
+
+    metadata.myBarCount = static_cast<int>(doc.myMasterBars.size());
+
+    // As with the full import, only the first tempo change in a bar is used,
+    // and it takes effect at the start of the bar.
+    DurationEstimator duration;
+    for (const Gp7::MasterBar &master_bar : doc.myMasterBars)
+    {
+        if (!master_bar.myTempoChanges.empty())
+        {
+            const Gp7::TempoChange &change = master_bar.myTempoChanges[0];
+            duration.setTempo(change.myBeatsPerMinute,
+                              convertBeatType(change.myBeatType));
+        }
+
+        duration.addBar(master_bar.myTimeSig.myBeats,
+                        master_bar.myTimeSig.myBeatValue);
+    }
+    metadata.myDuration = duration.getDuration();
+
+    return metadata;
+}
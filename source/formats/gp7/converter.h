@@ -19,6 +19,7 @@
 #define FORMATS_GP7_CONVERTER_H
 
 class Score;
+struct ScoreMetadata;
 
 namespace Gp7
 {
@@ -27,6 +28,10 @@ struct Document;
 /// Converts the Guitar Pro document into the provided score.
 void convert(const Gp7::Document &doc, Score &score);
 
+/// Converts the score information, tracks, and master bars of the Guitar Pro
+/// document into a summary of the score.
+ScoreMetadata convertMetadata(const Gp7::Document &doc);
+
 } // namespace Gp7
 
 #endif
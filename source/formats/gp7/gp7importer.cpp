@@ -27,7 +27,12 @@
 
 #include <pugixml.hpp>
 
+#include <algorithm>
+#include <array>
+#include <limits>
+
 #include <formats/fileformat.h>
+#include <formats/scoremetadata.h>
 #include <score/score.h>
 #include <util/scopeexit.h>
 
@@ -87,41 +92,65 @@ std::vector<std::byte> loadFileFromZip(unzFile zip_file, const char *name)
             throw FileFormatException("Failed to close file.");
     });
 
-    // Read the file contents, block by block.
-    std::vector<std::byte> buffer;
-    while (true)
+    // The directory entry records the uncompressed size, so the file can
+    // usually be read in one pass into a buffer of the right size. The size
+    // could be wrong in a corrupt file, so don't trust anything beyond the
+    // maximum ratio for deflate (about 1032:1), and keep reading in case the
+    // file is longer than expected.
+    unz_file_info64 info;
+    if (unzGetCurrentFileInfo64(zip_file, &info, nullptr, 0, nullptr, 0,
+                                nullptr, 0) != UNZ_OK)
     {
-        static constexpr int BLOCK_SIZE = 4096;
+        throw FileFormatException("Failed to read file information.");
+    }
 
-        const size_t block_start = buffer.size();
-        buffer.resize(buffer.size() + BLOCK_SIZE);
-        const int bytes_read = unzReadCurrentFile(
-            zip_file, buffer.data() + block_start, BLOCK_SIZE);
+    static constexpr uint64_t MAX_DEFLATE_RATIO = 1032;
+    const uint64_t expected_size = std::min(
+        info.uncompressed_size, (info.compressed_size + 1) * MAX_DEFLATE_RATIO);
 
+    std::vector<std::byte> buffer(expected_size);
+    size_t size = 0;
+    while (true)
+    {
+        static constexpr unsigned int BLOCK_SIZE = 4096;
+        std::array<std::byte, BLOCK_SIZE> overflow;
+
+        // Once the buffer is full, read into a separate block so that the end
+        // of the file can be detected without growing the buffer.
+        const bool is_full = (size == buffer.size());
+        std::byte *dest = is_full ? overflow.data() : buffer.data() + size;
+        const unsigned int length =
+            is_full ? BLOCK_SIZE
+                    : static_cast<unsigned int>(std::min<size_t>(
+                          buffer.size() - size,
+                          std::numeric_limits<int>::max()));
+
+        const int bytes_read = unzReadCurrentFile(zip_file, dest, length);
         if (bytes_read == 0)
         {
             // End of file.
             break;
         }
         else if (bytes_read < 0)
-        {
             throw FileFormatException("Failed to read file.");
-        }
-        else if (bytes_read != BLOCK_SIZE)
+
+        if (is_full)
         {
-            // We likely reached the end of the file - trim extra entries that
-            // were allocated.
-            assert(bytes_read < BLOCK_SIZE);
-            buffer.resize(buffer.size() - (BLOCK_SIZE - bytes_read));
+            buffer.insert(buffer.end(), overflow.begin(),
+                          overflow.begin() + bytes_read);
         }
-    };
 
+        size += bytes_read;
+    }
+
+    // Trim the buffer if the file was shorter than expected.
+    buffer.resize(size);
     return buffer;
 }
 
-} // namespace
-
-void Gp7Importer::load(const boost::filesystem::path &filename, Score &score)
+/// Loads the score.gpif XML file from the zip archive.
+void loadScoreXml(const boost::filesystem::path &filename,
+                  std::vector<std::byte> &buffer, pugi::xml_document &xml_doc)
 {
     // The .gp file format is just a zip file with a different extension.
     UnzFileHandle zip_file = openZipFile(filename);
@@ -129,16 +158,74 @@ void Gp7Importer::load(const boost::filesystem::path &filename, Score &score)
     // There are a few files, but Content/score.gpif has the main contents in
     // XML format. This is very similar to the .gpx file format, but with a
     // different container.
-    std::vector<std::byte> buffer =
-        loadFileFromZip(zip_file.get(), "Content/score.gpif");
+    buffer = loadFileFromZip(zip_file.get(), "Content/score.gpif");
 
     // Parse as an XML file.
-    pugi::xml_document xml_doc;
     pugi::xml_parse_result result =
-        xml_doc.load_buffer_inplace(buffer.data(), buffer.size());
+        xml_doc.load_buffer_inplace(buffer.data(), buffer.size(),
+                                    Gp7::PARSE_OPTIONS);
     if (!result)
         throw FileFormatException(result.description());
+}
+
+} // namespace
+
+void Gp7Importer::load(const boost::filesystem::path &filename, Score &score)
+{
+    std::vector<std::byte> buffer;
+    pugi::xml_document xml_doc;
+    loadScoreXml(filename, buffer, xml_doc);
 
     Gp7::Document doc = Gp7::parse(xml_doc, Gp7::Version::V7);
+
+    // Release the XML data before building the score.
+    xml_doc.reset();
+    buffer = std::vector<std::byte>();
+
     Gp7::convert(doc, score);
 }
+
+ScoreMetadata Gp7Importer::probe(const boost::filesystem::path &filename)
+{
+    std::vector<std::byte> buffer;
+    pugi::xml_document xml_doc;
+    loadScoreXml(filename, buffer, xml_doc);
+
+    return Gp7::convertMetadata(Gp7::parseHeader(xml_doc, Gp7::Version::V7));
+}
+
+bool Gp7Importer::canRead(std::string_view header) const
+{
+    // The file is a zip archive, which is a sequence of local file headers
+    // and their data. To avoid claiming other zip-based files (e.g. .zip or
+    // .docx), look for an entry in the Content/ directory, which contains the
+    // score. This is normally the first entry in the archive.
+    static constexpr size_t LOCAL_HEADER_SIZE = 30;
+    static const std::string_view LOCAL_HEADER_SIGNATURE("PK\x03\x04", 4);
+
+    auto readInt = [&](size_t pos, int num_bytes) {
+        size_t value = 0;
+        for (int i = num_bytes - 1; i >= 0; --i)
+            value = (value << 8) | static_cast<uint8_t>(header[pos + i]);
+        return value;
+    };
+
+    size_t offset = 0;
+    while (offset + LOCAL_HEADER_SIZE <= header.size() &&
+           header.substr(offset, 4) == LOCAL_HEADER_SIGNATURE)
+    {
+        const size_t compressed_size = readInt(offset + 18, 4);
+        const size_t name_length = readInt(offset + 26, 2);
+        const size_t extra_length = readInt(offset + 28, 2);
+
+        const std::string_view name =
+            header.substr(offset + LOCAL_HEADER_SIZE, name_length);
+        if (name.substr(0, 8) == "Content/")
+            return true;
+
+        offset += LOCAL_HEADER_SIZE + name_length + extra_length +
+                  compressed_size;
+    }
+
+    return false;
+}
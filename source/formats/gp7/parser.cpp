@@ -19,12 +19,13 @@
 
 #include <formats/fileformat.h>
 #include <score/generalmidi.h>
+#include <util/parallel.h>
 
-#include <boost/algorithm/string/split.hpp>
+#include <charconv>
+#include <functional>
+#include <iterator>
 #include <string>
 
-#include <iostream>
-
 bool
 Gp7::MasterBar::TimeSignature::operator==(const TimeSignature &other) const
 {
@@ -50,30 +51,68 @@ Gp7::MasterBar::KeySignature::operator!=(const KeySignature &other) const
     return !operator==(other);
 }
 
-static std::vector<std::string>
-splitString(std::string input, char separator = ' ')
+/// Parses the integer at the start of the string, ignoring any trailing
+/// characters.
+static int
+toInt(std::string_view input)
 {
-    if (input.empty())
-        return {};
+    int value = 0;
+    auto result =
+        std::from_chars(input.data(), input.data() + input.size(), value);
+    if (result.ec != std::errc())
+        throw FileFormatException("Invalid integer value.");
 
-    std::vector<std::string> output;
-    boost::algorithm::split(output, input,
-                            [=](char c) { return c == separator; });
-    return output;
+    return value;
 }
 
+/// Parses a list of integers separated by the given character, e.g. "0 1 2".
 static std::vector<int>
-toIntList(const std::vector<std::string> &input)
+toIntList(std::string_view input, char separator = ' ')
 {
     std::vector<int> output;
-    output.reserve(input.size());
+    while (!input.empty())
+    {
+        const size_t end = input.find(separator);
+        output.push_back(toInt(input.substr(0, end)));
 
-    for (auto &&val : input)
-        output.push_back(std::stoi(val));
+        if (end == std::string_view::npos)
+            break;
+        input.remove_prefix(end + 1);
+    }
 
     return output;
 }
 
+/// The number of notes below which the sections of a file are parsed
+/// serially. Each parallel section is started as a std::async task, which
+/// costs roughly the time taken to parse a few hundred notes, so this only
+/// helps for larger files. Most files that are opened are small enough to be
+/// parsed on the calling thread.
+static const size_t PARALLEL_PARSE_MIN_NOTES = 5000;
+
+/// Returns the number of children with the given name.
+static size_t
+countChildren(const pugi::xml_node &node, const char *name)
+{
+    size_t count = 0;
+    for ([[maybe_unused]] const pugi::xml_node &child : node.children(name))
+        ++count;
+
+    return count;
+}
+
+/// Returns the id attribute of the node, which is used to index into the
+/// document's tables.
+static int
+getId(const pugi::xml_node &node)
+{
+    const int id = node.attribute("id").as_int(-1);
+    if (id < 0)
+        throw FileFormatException("Invalid id.");
+
+    return id;
+}
+
 static Gp7::ScoreInfo
 parseScoreInfo(const pugi::xml_node &node)
 {
@@ -96,7 +135,7 @@ parseScoreInfo(const pugi::xml_node &node)
     // Skipping ScoreSystemsDefaultLayout, ScoreZoomPolicy,
     // ScoreZoom, MultiVoice.
     info.myScoreSystemsLayout =
-        toIntList(splitString(node.child_value("ScoreSystemsLayout")));
+        toIntList(node.child_value("ScoreSystemsLayout"));
 
     return info;
 }
@@ -116,13 +155,12 @@ parseTempoChanges(const pugi::xml_node &master_track,
         change.myIsVisible = node.child("Visible").text().as_bool(true);
 
         // There should be space-separated string such as "120 2".
-        std::vector<std::string> values =
-            splitString(node.child_value("Value"));
+        const std::vector<int> values = toIntList(node.child_value("Value"));
         if (values.size() != 2)
             throw FileFormatException("Invalid tempo change values.");
 
-        change.myBeatsPerMinute = std::stoi(values[0]);
-        switch (std::stoi(values[1]))
+        change.myBeatsPerMinute = values[0];
+        switch (values[1])
         {
             using BeatType = Gp7::TempoChange::BeatType;
             case 1:
@@ -252,8 +290,7 @@ parseStaff(const pugi::xml_node &node, Gp7::Track &track)
     // of pitches.
     auto tuning_property =
         properties.find_child_by_attribute("Property", "name", "Tuning");
-    staff.myTuning =
-        toIntList(splitString(tuning_property.child_value("Pitches")));
+    staff.myTuning = toIntList(tuning_property.child_value("Pitches"));
 
     auto diagram_property = properties.find_child_by_attribute(
         "Property", "name", "DiagramCollection");
@@ -271,8 +308,7 @@ parseTracks(const pugi::xml_node &tracks_node, Gp7::Version version)
     {
         Gp7::Track track;
         track.myName = node.child_value("Name");
-        track.mySystemsLayout =
-            toIntList(splitString(node.child_value("SystemsLayout")));
+        track.mySystemsLayout = toIntList(node.child_value("SystemsLayout"));
 
         // Many fields related to RSE are skipped here.
 
@@ -326,7 +362,7 @@ parseMasterBars(const pugi::xml_node &master_bars_node)
     {
         Gp7::MasterBar master_bar;
 
-        master_bar.myBarIds = toIntList(splitString(node.child_value("Bars")));
+        master_bar.myBarIds = toIntList(node.child_value("Bars"));
 
         auto section_node = node.child("Section");
         if (section_node)
@@ -354,11 +390,10 @@ parseMasterBars(const pugi::xml_node &master_bars_node)
         }
 
         master_bar.myAlternateEndings =
-            toIntList(splitString(node.child_value("AlternateEndings")));
+            toIntList(node.child_value("AlternateEndings"));
 
         // The time signature should be a string like 12/8.
-        std::vector<int> time_sig =
-            toIntList(splitString(node.child_value("Time"), '/'));
+        std::vector<int> time_sig = toIntList(node.child_value("Time"), '/');
         if (time_sig.size() != 2)
             throw FileFormatException("Unexpected time signature value");
 
@@ -379,7 +414,7 @@ parseMasterBars(const pugi::xml_node &master_bars_node)
              node.child("Fermatas").children("Fermata"))
         {
             std::vector<int> offset =
-                toIntList(splitString(fermata.child_value("Offset"), '/'));
+                toIntList(fermata.child_value("Offset"), '/');
             if (offset.size() != 2)
                 throw FileFormatException("Unexpected fermata offset.");
 
@@ -451,17 +486,20 @@ parseMasterBars(const pugi::xml_node &master_bars_node)
     return master_bars;
 }
 
-static std::unordered_map<int, Gp7::Bar>
+static Gp7::IdTable<Gp7::Bar>
 parseBars(const pugi::xml_node &bars_node)
 {
-    std::unordered_map<int, Gp7::Bar> bars;
+    const size_t count = countChildren(bars_node, "Bar");
+    Gp7::IdTable<Gp7::Bar> bars;
+    bars.reserve(count);
+
     for (const pugi::xml_node &node : bars_node.children("Bar"))
     {
         Gp7::Bar bar;
-        bar.myVoiceIds = toIntList(splitString(node.child_value("Voices")));
+        bar.myVoiceIds = toIntList(node.child_value("Voices"));
 
         using ClefType = Gp7::Bar::ClefType;
-        std::string clef_name = node.child_value("Clef");
+        const std::string_view clef_name = node.child_value("Clef");
         if (clef_name == "G2")
             bar.myClefType = ClefType::G2;
         else if (clef_name == "F4")
@@ -477,37 +515,41 @@ parseBars(const pugi::xml_node &bars_node)
 
         // TODO - import the 'Ottavia' key if the clef has 8va, etc
 
-        const int id = node.attribute("id").as_int();
-        bars.emplace(id, bar);
+        bars.insert(getId(node), std::move(bar));
     }
 
     return bars;
 }
 
-static std::unordered_map<int, Gp7::Voice>
+static Gp7::IdTable<Gp7::Voice>
 parseVoices(const pugi::xml_node &voices_node)
 {
-    std::unordered_map<int, Gp7::Voice> voices;
+    const size_t count = countChildren(voices_node, "Voice");
+    Gp7::IdTable<Gp7::Voice> voices;
+    voices.reserve(count);
+
     for (const pugi::xml_node &node : voices_node.children("Voice"))
     {
         Gp7::Voice voice;
-        voice.myBeatIds = toIntList(splitString(node.child_value("Beats")));
-        const int id = node.attribute("id").as_int();
-        voices.emplace(id, voice);
+        voice.myBeatIds = toIntList(node.child_value("Beats"));
+        voices.insert(getId(node), std::move(voice));
     }
 
     return voices;
 }
 
-static std::unordered_map<int, Gp7::Beat>
+static Gp7::IdTable<Gp7::Beat>
 parseBeats(const pugi::xml_node &beats_node)
 {
-    std::unordered_map<int, Gp7::Beat> beats;
+    const size_t count = countChildren(beats_node, "Beat");
+    Gp7::IdTable<Gp7::Beat> beats;
+    beats.reserve(count);
+
     for (const pugi::xml_node &node : beats_node.children("Beat"))
     {
         Gp7::Beat beat;
         beat.myRhythmId = node.child("Rhythm").attribute("ref").as_int();
-        beat.myNoteIds = toIntList(splitString(node.child_value("Notes")));
+        beat.myNoteIds = toIntList(node.child_value("Notes"));
 
         if (auto chord_id = node.child("Chord"))
             beat.myChordId = chord_id.text().as_int(-1);
@@ -564,17 +606,19 @@ parseBeats(const pugi::xml_node &beats_node)
                 beat.myArpeggioUp = true;
         }
 
-        const int id = node.attribute("id").as_int();
-        beats.emplace(id, beat);
+        beats.insert(getId(node), std::move(beat));
     }
 
     return beats;
 }
 
-static std::unordered_map<int, Gp7::Note>
+static Gp7::IdTable<Gp7::Note>
 parseNotes(const pugi::xml_node &notes_node)
 {
-    std::unordered_map<int, Gp7::Note> notes;
+    const size_t count = countChildren(notes_node, "Note");
+    Gp7::IdTable<Gp7::Note> notes;
+    notes.reserve(count);
+
     for (const pugi::xml_node &node : notes_node.children("Note"))
     {
         Gp7::Note note;
@@ -701,29 +745,31 @@ parseNotes(const pugi::xml_node &notes_node)
 
         // TODO - import bends.
 
-        const int id = node.attribute("id").as_int();
-        notes.emplace(id, note);
+        notes.insert(getId(node), std::move(note));
     }
 
     return notes;
 }
 
-static std::unordered_map<int, Gp7::Rhythm>
+static Gp7::IdTable<Gp7::Rhythm>
 parseRhythms(const pugi::xml_node &rhythms_node)
 {
-    static const std::unordered_map<std::string, int> theNoteValuesMap = {
+    static const std::unordered_map<std::string_view, int> theNoteValuesMap = {
         { "Whole", 1 }, { "Half", 2 },  { "Quarter", 4 }, { "Eighth", 8 },
         { "16th", 16 }, { "32nd", 32 }, { "64th", 64 }
     };
 
-    std::unordered_map<int, Gp7::Rhythm> rhythms;
+    const size_t count = countChildren(rhythms_node, "Rhythm");
+    Gp7::IdTable<Gp7::Rhythm> rhythms;
+    rhythms.reserve(count);
+
     for (const pugi::xml_node &node : rhythms_node.children("Rhythm"))
     {
         Gp7::Rhythm rhythm;
 
         // Import the duration.
         {
-            const std::string note_value = node.child_value("NoteValue");
+            const std::string_view note_value = node.child_value("NoteValue");
             auto it = theNoteValuesMap.find(note_value);
             if (it == theNoteValuesMap.end())
                 throw FileFormatException("Unexpected rhythm note value");
@@ -744,8 +790,7 @@ parseRhythms(const pugi::xml_node &rhythms_node)
             rhythm.myTupletDenom = tuplet.attribute("den").as_int();
         }
 
-        const int id = node.attribute("id").as_int();
-        rhythms.emplace(id, rhythm);
+        rhythms.insert(getId(node), rhythm);
     }
 
     return rhythms;
@@ -754,32 +799,28 @@ parseRhythms(const pugi::xml_node &rhythms_node)
 void
 Gp7::Document::addBar(MasterBar &master_bar, Bar bar)
 {
-    const int bar_id = static_cast<int>(myBars.size());
-    myBars[bar_id] = std::move(bar);
+    const int bar_id = myBars.push_back(std::move(bar));
     master_bar.myBarIds.push_back(bar_id);
 }
 
 void
 Gp7::Document::addVoice(Bar &bar, Voice voice)
 {
-    const int voice_id = static_cast<int>(myVoices.size());
-    myVoices[voice_id] = std::move(voice);
+    const int voice_id = myVoices.push_back(std::move(voice));
     bar.myVoiceIds.push_back(voice_id);
 }
 
 void
 Gp7::Document::addBeat(Voice &voice, Beat beat)
 {
-    const int beat_id = static_cast<int>(myBeats.size());
-    myBeats[beat_id] = std::move(beat);
+    const int beat_id = myBeats.push_back(std::move(beat));
     voice.myBeatIds.push_back(beat_id);
 }
 
 void
 Gp7::Document::addNote(Beat &beat, Note note)
 {
-    const int note_id = static_cast<int>(myNotes.size());
-    myNotes[note_id] = std::move(note);
+    const int note_id = myNotes.push_back(std::move(note));
     beat.myNoteIds.push_back(note_id);
 }
 
@@ -787,8 +828,7 @@ void
 Gp7::Document::addRhythm(Beat &beat, Rhythm rhythm)
 {
     // TODO - consolidate identical rhythms?
-    const int rhythm_id = static_cast<int>(myRhythms.size());
-    myRhythms[rhythm_id] = std::move(rhythm);
+    const int rhythm_id = myRhythms.push_back(std::move(rhythm));
     beat.myRhythmId = rhythm_id;
 }
 
@@ -813,15 +853,41 @@ Gp7::parse(const pugi::xml_document &root, Version version)
     // changes do occur as 'Automation' nodes here.
     const pugi::xml_node master_track = gpif.child("MasterTrack");
 
-    doc.myTracks = parseTracks(gpif.child("Tracks"), version);
-    doc.myMasterBars = parseMasterBars(gpif.child("MasterBars"));
-    doc.myBars = parseBars(gpif.child("Bars"));
-    doc.myVoices = parseVoices(gpif.child("Voices"));
-    doc.myBeats = parseBeats(gpif.child("Beats"));
-    doc.myNotes = parseNotes(gpif.child("Notes"));
-    doc.myRhythms = parseRhythms(gpif.child("Rhythms"));
+    // The sections are independent of each other, and the XML document can be
+    // safely read from multiple threads. The notes, beats and rhythms make up
+    // most of a large file, so the other sections finish quickly and their
+    // threads are reused for the larger sections.
+    const std::function<void()> sections[] = {
+        [&]() { doc.myTracks = parseTracks(gpif.child("Tracks"), version); },
+        [&]() {
+            doc.myMasterBars = parseMasterBars(gpif.child("MasterBars"));
+        },
+        [&]() { doc.myBars = parseBars(gpif.child("Bars")); },
+        [&]() { doc.myVoices = parseVoices(gpif.child("Voices")); },
+        [&]() { doc.myBeats = parseBeats(gpif.child("Beats")); },
+        [&]() { doc.myNotes = parseNotes(gpif.child("Notes")); },
+        [&]() { doc.myRhythms = parseRhythms(gpif.child("Rhythms")); }
+    };
+    const bool parallel =
+        countChildren(gpif.child("Notes"), "Note") >= PARALLEL_PARSE_MIN_NOTES;
+    Util::parallelFor(std::size(sections), [&](size_t i) { sections[i](); },
+                      parallel ? 0 : 1);
 
     parseTempoChanges(master_track, doc.myMasterBars);
 
     return doc;
 }
+
+Gp7::Document
+Gp7::parseHeader(const pugi::xml_document &root, Version version)
+{
+    Gp7::Document doc;
+
+    const pugi::xml_node gpif = root.child("GPIF");
+    doc.myScoreInfo = parseScoreInfo(gpif.child("Score"));
+    doc.myTracks = parseTracks(gpif.child("Tracks"), version);
+    doc.myMasterBars = parseMasterBars(gpif.child("MasterBars"));
+    parseTempoChanges(gpif.child("MasterTrack"), doc.myMasterBars);
+
+    return doc;
+}
@@ -19,17 +19,33 @@
 #define FORMATS_GP7_PARSER_H
 
 #include "score/timesignature.h"
+#include <algorithm>
 #include <bitset>
+
 #include <boost/rational.hpp>
+#include <cassert>
 #include <optional>
 #include <pugixml.hpp>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace Gp7
 {
+/// Options for parsing score.gpif. Embedding text in the element nodes avoids
+/// allocating a separate node for each value. The default flags are kept so
+/// that text values (e.g. lyrics, which may contain line breaks) are still
+/// normalized.
+#if PUGIXML_VERSION >= 190
+constexpr unsigned int PARSE_OPTIONS =
+    pugi::parse_default | pugi::parse_embed_pcdata;
+#else
+constexpr unsigned int PARSE_OPTIONS = pugi::parse_default;
+#endif
+
 /// Guitar Pro 6 files (.gpx) are very similar.
 enum class Version
 {
@@ -356,6 +372,77 @@ struct Note
     std::optional<Bend> myBend;
 };
 
+/// Stores the objects (bars, beats, etc) that are referenced by id.
+/// The ids are normally numbered from zero, so they are used as indices into a
+/// vector rather than being hashed. Any ids that are far beyond the number of
+/// objects are stored in a map instead, so that sparse ids don't require a
+/// huge vector.
+template <typename T>
+class IdTable
+{
+public:
+    /// Returns the object with the given id.
+    /// @throws std::out_of_range if there isn't an object with that id.
+    const T &at(int id) const
+    {
+        if (id >= 0 && id < static_cast<int>(myItems.size()) && myItems[id])
+            return *myItems[id];
+
+        auto it = mySparseItems.find(id);
+        if (it == mySparseItems.end())
+            throw std::out_of_range("Invalid id");
+
+        return it->second;
+    }
+
+    T &at(int id)
+    {
+        return const_cast<T &>(std::as_const(*this).at(id));
+    }
+
+    /// Inserts an object with the given id, replacing any existing object.
+    void insert(int id, T item)
+    {
+        assert(id >= 0);
+        myNextId = std::max(myNextId, id + 1);
+
+        const size_t index = static_cast<size_t>(id);
+        if (index >= myItems.size() && index > 2 * myCount + MAX_GAP)
+        {
+            if (mySparseItems.insert_or_assign(id, std::move(item)).second)
+                ++myCount;
+            return;
+        }
+
+        if (index >= myItems.size())
+            myItems.resize(index + 1);
+
+        if (!myItems[index])
+            ++myCount;
+        myItems[index] = std::move(item);
+    }
+
+    /// Adds an object with the next unused id, and returns its id.
+    int push_back(T item)
+    {
+        const int id = myNextId;
+        insert(id, std::move(item));
+        return id;
+    }
+
+    void reserve(size_t size) { myItems.reserve(size); }
+
+private:
+    /// The number of unused ids allowed past the end of the vector, in
+    /// addition to the number of objects.
+    static constexpr size_t MAX_GAP = 64;
+
+    std::vector<std::optional<T>> myItems;
+    std::unordered_map<int, T> mySparseItems;
+    size_t myCount = 0;
+    int myNextId = 0;
+};
+
 /// Container for a Guitar Pro 7 document.
 struct Document
 {
@@ -368,16 +455,24 @@ struct Document
     ScoreInfo myScoreInfo;
     std::vector<Track> myTracks;
     std::vector<MasterBar> myMasterBars;
-    std::unordered_map<int, Bar> myBars;
-    std::unordered_map<int, Voice> myVoices;
-    std::unordered_map<int, Beat> myBeats;
-    std::unordered_map<int, Note> myNotes;
-    std::unordered_map<int, Rhythm> myRhythms;
+    IdTable<Bar> myBars;
+    IdTable<Voice> myVoices;
+    IdTable<Beat> myBeats;
+    IdTable<Note> myNotes;
+    IdTable<Rhythm> myRhythms;
 };
 
-/// Parses the score.gpif XML file.
+/// Parses the score.gpif XML file. For large files, the sections of the file
+/// (tracks, bars, beats, notes, etc) are parsed in parallel, unless this is
+/// already running on one of Util::parallelFor()'s workers (e.g. when
+/// converting or probing a batch of files). Otherwise they are parsed
+/// serially.
 Document parse(const pugi::xml_document &root, Version version);
 
+/// Parses only the score information, tracks, and master bars from the
+/// score.gpif XML file, skipping the contents of the bars.
+Document parseHeader(const pugi::xml_document &root, Version version);
+
 } // namespace Gp7
 
 #endif
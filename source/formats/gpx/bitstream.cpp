@@ -17,63 +17,87 @@
 
 #include "bitstream.h"
 
-#include "util.h"
-#include <cassert>
+#include <algorithm>
 #include <istream>
 
 static constexpr uint32_t BYTE_LENGTH = 8;
 
-Gpx::BitStream::BitStream(std::istream &stream) : myPosition(0)
+/// Loads 8 bytes as a big-endian integer. Compilers optimize this into a
+/// single load and byte swap.
+static uint64_t
+loadBigEndian(const std::byte *bytes)
 {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); ++i)
+        value = (value << BYTE_LENGTH) | std::to_integer<uint64_t>(bytes[i]);
+
+    return value;
+}
+
+static std::vector<std::byte>
+readAll(std::istream &stream)
+{
+    std::vector<std::byte> bytes;
+
     // Copy data from the stream into an internal buffer.
     stream.seekg(0, std::ios::end);
-    myBytes.resize(stream.tellg());
+    bytes.resize(stream.tellg());
 
     stream.seekg(0, std::ios::beg);
-    stream.read(reinterpret_cast<char *>(&myBytes[0]), myBytes.size());
+    stream.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+
+    return bytes;
 }
 
-uint32_t
-Gpx::BitStream::readInt()
+Gpx::BitStream::BitStream(std::istream &stream) : BitStream(readAll(stream))
 {
-    assert(myPosition % BYTE_LENGTH == 0);
-
-    const uint32_t value =
-        Gpx::Util::readUInt(myBytes, myPosition / BYTE_LENGTH);
-    myPosition += sizeof(uint32_t) * BYTE_LENGTH;
-    return value;
 }
 
-bool
-Gpx::BitStream::readBit()
+Gpx::BitStream::BitStream(std::vector<std::byte> bytes)
+    : myBytes(std::move(bytes)), myBuffer(0), myBufferSize(0), myNextByte(0)
 {
-    if (myPosition / BYTE_LENGTH >= myBytes.size())
-        return 0;
-
-    std::byte byte = myBytes[myPosition / BYTE_LENGTH];
-    byte >>= ((BYTE_LENGTH - 1) - (myPosition % BYTE_LENGTH));
-    byte &= std::byte{ 0x01 };
-
-    ++myPosition;
-
-    return byte != std::byte{ 0 };
 }
 
-int32_t
-Gpx::BitStream::readBits(int n, BitOrder order)
+void
+Gpx::BitStream::refill()
 {
-    int32_t value = 0;
-
-    if (order == Reversed)
+    if (myNextByte + sizeof(uint64_t) <= myBytes.size())
     {
-        for (int i = 0; i < n; ++i)
-            value |= (readBit() << i);
+        // Load a full word and keep as many whole bytes as will fit. Any
+        // extra bits that are loaded are the same as the bits that the next
+        // refill will load, so they don't need to be masked off.
+        myBuffer |= loadBigEndian(&myBytes[myNextByte]) >> myBufferSize;
+
+        const int num_bytes = (64 - myBufferSize) / BYTE_LENGTH;
+        myNextByte += num_bytes;
+        myBufferSize += num_bytes * BYTE_LENGTH;
     }
     else
     {
-        for (int i = n - 1; i >= 0; --i)
-            value |= (readBit() << i);
+        // Near the end of the data, load a byte at a time and pad with zeros.
+        while (myBufferSize <= 56)
+        {
+            if (myNextByte < myBytes.size())
+            {
+                myBuffer |= std::to_integer<uint64_t>(myBytes[myNextByte])
+                            << (56 - myBufferSize);
+            }
+
+            ++myNextByte;
+            myBufferSize += BYTE_LENGTH;
+        }
     }
+}
+
+uint32_t
+Gpx::BitStream::readInt()
+{
+    assert(myBufferSize % BYTE_LENGTH == 0);
+
+    // The integer is stored in little-endian order.
+    uint32_t value = 0;
+    for (size_t i = 0; i < sizeof(uint32_t); ++i)
+        value |= static_cast<uint32_t>(takeBits(BYTE_LENGTH)) << (8 * i);
 
     return value;
 }
@@ -81,7 +105,14 @@ Gpx::BitStream::readBits(int n, BitOrder order)
 size_t
 Gpx::BitStream::getLocation() const
 {
-    return myPosition / BYTE_LENGTH;
+    const size_t position = myNextByte * BYTE_LENGTH - myBufferSize;
+    return std::min(position / BYTE_LENGTH, myBytes.size());
+}
+
+size_t
+Gpx::BitStream::getSize() const
+{
+    return myBytes.size();
 }
 
 bool
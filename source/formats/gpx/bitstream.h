@@ -18,6 +18,9 @@
 #ifndef FORMATS_GPX_BITSTREAM_H
 #define FORMATS_GPX_BITSTREAM_H
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <cstdint>
 #include <cstddef>
 #include <iosfwd>
@@ -28,6 +31,10 @@ namespace Gpx
 
 /// Provides the ability to read individual bits from a stream.
 /// This is required for the compression scheme used in .gpx files.
+///
+/// Bits are read from a 64-bit buffer, which is refilled a word at a time,
+/// so that multi-bit values can be extracted with a single shift rather than
+/// one bit at a time. Reading past the end of the data produces zero bits.
 class BitStream
 {
 public:
@@ -38,6 +45,7 @@ public:
     };
 
     BitStream(std::istream &stream);
+    BitStream(std::vector<std::byte> bytes);
 
     /// Reads a 32-bit unsigned integer from the stream. This assumes that the
     /// stream position is exactly on the start of a byte.
@@ -46,22 +54,123 @@ public:
     /// Reads the next bit from the stream.
     bool readBit();
 
-    /// Reads the next n bits from the stream into an integer.
+    /// Reads the next n bits (at most 32) from the stream into an integer.
     int32_t readBits(int n, BitOrder = Normal);
 
+    /// Reads the next n bytes from the stream, which do not need to be
+    /// aligned to a byte boundary.
+    void readBytes(std::byte *dest, size_t n);
+
     /// Returns the position in the stream (measured in bytes).
     size_t getLocation() const;
 
+    /// Returns the total size of the stream (measured in bytes).
+    size_t getSize() const;
+
     /// Returns true if we've reached the end of the stream.
     bool isAtEnd() const;
 
 private:
-    /// The current position in the input (measured in bits).
-    size_t myPosition;
+    /// Loads more bytes into the buffer, so that it contains at least 57
+    /// bits.
+    void refill();
+    /// Removes the next n bits (at most 57) from the buffer.
+    uint64_t takeBits(int n);
+
     /// The compressed data being read.
     std::vector<std::byte> myBytes;
+    /// The next bits to be read, starting from the most significant bit.
+    uint64_t myBuffer;
+    /// The number of valid bits in the buffer.
+    int myBufferSize;
+    /// The index of the next byte to be loaded into the buffer.
+    size_t myNextByte;
 };
 
+namespace Detail
+{
+/// Lookup table for reversing the bits in a byte.
+inline constexpr std::array<uint8_t, 256> theReversedBytes = []() {
+    std::array<uint8_t, 256> table = {};
+    for (int i = 0; i < 256; ++i)
+    {
+        uint8_t reversed = 0;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            if (i & (1 << bit))
+                reversed |= static_cast<uint8_t>(1 << (7 - bit));
+        }
+
+        table[i] = reversed;
+    }
+
+    return table;
+}();
+} // namespace Detail
+
+// The functions below are called for every chunk of a compressed file, so
+// they are defined inline.
+
+inline uint64_t
+BitStream::takeBits(int n)
+{
+    assert(n >= 0 && n <= 57);
+
+    if (myBufferSize < n)
+        refill();
+    if (n == 0)
+        return 0;
+
+    const uint64_t value = myBuffer >> (64 - n);
+    myBuffer <<= n;
+    myBufferSize -= n;
+    return value;
+}
+
+inline bool
+BitStream::readBit()
+{
+    return takeBits(1) != 0;
+}
+
+inline int32_t
+BitStream::readBits(int n, BitOrder order)
+{
+    assert(n >= 0 && n <= 32);
+    if (n == 0)
+        return 0;
+
+    uint32_t value = static_cast<uint32_t>(takeBits(n));
+    if (order == Reversed)
+    {
+        auto reverse = [](uint32_t byte) -> uint32_t {
+            return Detail::theReversedBytes[byte & 0xff];
+        };
+        value = ((reverse(value) << 24) | (reverse(value >> 8) << 16) |
+                 (reverse(value >> 16) << 8) | reverse(value >> 24)) >>
+                (32 - n);
+    }
+
+    return static_cast<int32_t>(value);
+}
+
+inline void
+BitStream::readBytes(std::byte *dest, size_t n)
+{
+    // Extract up to 7 bytes at a time from the buffer.
+    while (n > 0)
+    {
+        const size_t count = std::min<size_t>(n, 7);
+        const uint64_t value = takeBits(static_cast<int>(count * 8));
+
+        for (size_t i = 0; i < count; ++i)
+            dest[i] = static_cast<std::byte>(value >> (8 * (count - 1 - i)));
+
+        dest += count;
+        n -= count;
+    }
+}
+
 } // namespace Gpx
 
 #endif
@@ -21,6 +21,8 @@
 #include "util.h"
 #include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <utility>
 #include <formats/fileformat.h>
 
 enum ChunkHeader
@@ -29,14 +31,35 @@ enum ChunkHeader
     Compressed = 1
 };
 
-static const uint32_t SECTOR_SIZE = 0x1000;
+// This is a size_t so that sector offsets are computed without overflow.
+static const size_t SECTOR_SIZE = 0x1000;
+
+static const size_t BCFS_HEADER_SIZE = 4;
+
+/// Limits the initial size of the decompressed buffer relative to the size of
+/// the compressed data, since the expected length comes from the file and
+/// can't be trusted. This is well above the typical compression ratio.
+static const size_t MAX_INITIAL_EXPANSION = 32;
 
 Gpx::FileSystem::FileSystem(std::istream &stream)
+    : myData(decompress(stream))
+{
+    // The data we just read should now have a header indicating that it's
+    // uncompressed!
+    const uint32_t BCFS_HEADER = 0x53464342;
+    if (myData.size() < BCFS_HEADER_SIZE ||
+        Gpx::Util::readUInt(myData, 0) != BCFS_HEADER)
+    {
+        throw FileFormatException("Invalid GPX Format");
+    }
+}
+
+std::vector<std::byte>
+Gpx::FileSystem::decompress(std::istream &stream)
 {
     // Decompress the input file and return the filesystem.
     Gpx::BitStream input(stream);
 
-    const uint32_t BCFS_HEADER = 0x53464342;
     const uint32_t BCFZ_HEADER = 0x5a464342;
 
     const uint32_t header = input.readInt();
@@ -46,8 +69,16 @@ Gpx::FileSystem::FileSystem(std::istream &stream)
         throw FileFormatException("Invalid header");
 
     const uint32_t length = input.readInt();
-    std::vector<std::byte> output;
-    output.reserve(length);
+
+    // The output is written directly into a buffer of the expected size,
+    // which is only grown if the header's length was too small.
+    std::vector<std::byte> output(std::min<size_t>(
+        length, MAX_INITIAL_EXPANSION * input.getSize()));
+    size_t size = 0;
+    auto grow = [&](size_t n) {
+        if (size + n > output.size())
+            output.resize(std::max(size + n, 2 * output.size()));
+    };
 
     // We now have a succession of compressed and uncompressed chunks.
     while (!input.isAtEnd() && input.getLocation() < length)
@@ -62,11 +93,9 @@ Gpx::FileSystem::FileSystem(std::istream &stream)
             const int32_t rawLength =
                 input.readBits(2, Gpx::BitStream::Reversed);
 
-            for (int32_t i = 0; i < rawLength; ++i)
-            {
-                output.push_back(
-                    std::byte{ static_cast<uint8_t>(input.readBits(8)) });
-            }
+            grow(rawLength);
+            input.readBytes(output.data() + size, rawLength);
+            size += rawLength;
         }
         // For a compressed chunk, we have a 4-bit integer giving a length P,
         // then two integers of P bits representing the offset and length of the
@@ -77,85 +106,127 @@ Gpx::FileSystem::FileSystem(std::istream &stream)
         {
             const int32_t p = input.readBits(4);
             const int32_t offset = input.readBits(p, Gpx::BitStream::Reversed);
-            const size_t startPos = output.size() - offset;
+            if (static_cast<size_t>(offset) > size)
+                throw FileFormatException("Invalid GPX Format");
+
+            const size_t startPos = size - offset;
 
+            // Since the length is at most the offset, the source and
+            // destination do not overlap.
             const int32_t length = std::clamp<int32_t>(
                 input.readBits(p, Gpx::BitStream::Reversed), 0, offset);
 
-            std::copy(output.begin() + startPos,
-                      output.begin() + startPos + length,
-                      std::back_inserter(output));
+            if (length > 0)
+            {
+                grow(length);
+                std::memcpy(output.data() + size, output.data() + startPos,
+                            length);
+                size += length;
+            }
         }
     }
 
-    // The data we just read should now have a header indicating that it's
-    // uncompressed!
-    const uint32_t newHeader = Gpx::Util::readUInt(output, 0);
-    if (newHeader != BCFS_HEADER)
-        throw FileFormatException("Invalid GPX Format");
-
-    readUncompressedData(output);
+    output.resize(size);
+    return output;
 }
 
-const std::vector<std::byte> &
-Gpx::FileSystem::getFileContents(const std::string &filename) const
+uint32_t
+Gpx::FileSystem::readUInt(size_t offset) const
 {
-    auto it = myFiles.find(filename);
-    if (it == myFiles.end())
-        throw FileFormatException("Invalid filename");
-    else
-        return it->second;
+    offset += BCFS_HEADER_SIZE;
+    if (offset + sizeof(uint32_t) > myData.size())
+        return 0;
+
+    return Util::readUInt(myData, offset);
 }
 
-void
-Gpx::FileSystem::readUncompressedData(std::vector<std::byte> &data)
+Gpx::FileSystem::FileView
+Gpx::FileSystem::getFileContents(const std::string &filename)
 {
-    // Remove the BCFS header.
-    data.erase(data.begin(), data.begin() + 4);
+    auto assembled = myAssembledFiles.find(filename);
+    if (assembled != myAssembledFiles.end())
+        return { assembled->second.data(), assembled->second.size() };
+
+    // The sectors are numbered from the end of the BCFS header.
+    std::byte *sectors = myData.data() + BCFS_HEADER_SIZE;
+    const size_t size = myData.size() - BCFS_HEADER_SIZE;
     size_t offset = 0;
 
-    // Read all files from the file system.
-    while ((offset = (offset + SECTOR_SIZE)) + 3 < data.size())
+    // Scan the file system until the requested file is found.
+    while ((offset = (offset + SECTOR_SIZE)) + 3 < size)
     {
-        if (Util::readUInt(data, offset) == 2)
+        if (readUInt(offset) != 2)
+            continue;
+
+        const size_t fileNameIndex = offset + 4;
+        const size_t fileSizeIndex = offset + 0x8C;
+        const size_t blockIndex = offset + 0x94;
+
+        // Find the file's sectors.
+        std::vector<uint32_t> blocks;
+        uint32_t block = 0;
+        while ((block = readUInt(blockIndex + 4 * blocks.size())) != 0)
         {
-            const size_t fileNameIndex = offset + 4;
-            const size_t fileSizeIndex = offset + 0x8C;
-            const size_t blockIndex = offset + 0x94;
+            blocks.push_back(block);
+            offset = block * SECTOR_SIZE;
+        }
 
-            int block = 0;
-            int blockCount = 0;
-            std::vector<std::byte> file_data;
+        const size_t fileNameLength =
+            std::min<size_t>(127, size - std::min(size, fileNameIndex));
+        std::string fileName(
+            reinterpret_cast<const char *>(sectors + fileNameIndex),
+            fileNameLength);
+        // Trim extra NULL characters.
+        fileName.erase(fileName.find_last_not_of('\0') + 1);
+
+        if (fileName != filename)
+            continue;
+
+        // Returns the range of the data covered by the sector. The last
+        // sector may be truncated by the end of the data.
+        auto sectorRange = [&](uint32_t b) {
+            const size_t start = std::min(b * SECTOR_SIZE, size);
+            const size_t end = std::min(start + SECTOR_SIZE, size);
+            return std::make_pair(sectors + start, sectors + end);
+        };
+
+        size_t available = 0;
+        for (uint32_t b : blocks)
+        {
+            auto [start, end] = sectorRange(b);
+            available += end - start;
+        }
 
-            // Read the file data.
-            while ((block =
-                        Util::readUInt(data, blockIndex + 4 * blockCount)) != 0)
-            {
-                offset = block * SECTOR_SIZE;
-                std::copy(data.begin() + offset,
-                          data.begin() +
-                              std::clamp<size_t>(offset + SECTOR_SIZE, 0,
-                                                 data.size()),
-                          std::back_inserter(file_data));
-                ++blockCount;
-            }
+        const uint32_t fileSize = readUInt(fileSizeIndex);
+        if (available < fileSize)
+            continue;
 
-            // Read the file name and save the file.
-            const uint32_t fileSize = Util::readUInt(data, fileSizeIndex);
-            if (file_data.size() >= fileSize)
-            {
-                std::string fileName;
-                std::transform(data.begin() + fileNameIndex,
-                               data.begin() + fileNameIndex + 127,
-                               std::back_inserter(fileName), [](std::byte b) {
-                                   return std::to_integer<char>(b);
-                               });
-                // Trim extra NULL characters.
-                fileName.erase(fileName.find_last_not_of('\0') + 1);
-
-                file_data.resize(fileSize);
-                myFiles[fileName] = std::move(file_data);
-            }
+        // If the sectors are adjacent, the file's contents can be used in
+        // place.
+        bool contiguous = true;
+        for (size_t i = 1; i < blocks.size(); ++i)
+            contiguous &= (blocks[i] == blocks[i - 1] + 1);
+
+        if (contiguous)
+        {
+            const size_t start = blocks.empty() ? 0 : blocks[0] * SECTOR_SIZE;
+            if (start > size || fileSize > size - start)
+                throw FileFormatException("Invalid GPX Format");
+
+            return { sectors + start, fileSize };
         }
+
+        std::vector<std::byte> &fileData = myAssembledFiles[filename];
+        fileData.reserve(available);
+        for (uint32_t b : blocks)
+        {
+            auto [start, end] = sectorRange(b);
+            fileData.insert(fileData.end(), start, end);
+        }
+
+        fileData.resize(fileSize);
+        return { fileData.data(), fileData.size() };
     }
+
+    throw FileFormatException("Invalid filename");
 }
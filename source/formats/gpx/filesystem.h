@@ -31,19 +31,40 @@ namespace Gpx
 /// The uncompressed *.gpx file is essentially a filesystem containing several
 /// xml files.
 /// This class handles the extraction of information from that filesystem.
+/// The decompressed data is kept in a single buffer, and files are only
+/// located when they are requested.
 class FileSystem
 {
 public:
     FileSystem(std::istream &stream);
 
-    const std::vector<std::byte> &getFileContents(
-        const std::string &filename) const;
+    /// A view of a file's contents, which is valid for the lifetime of the
+    /// filesystem. The data may be modified, e.g. by an in-place parser.
+    struct FileView
+    {
+        std::byte *myData;
+        size_t mySize;
+    };
+
+    /// Finds the file with the given name. If the file's sectors are
+    /// adjacent, the view points directly into the filesystem's buffer.
+    /// Otherwise, the sectors are first copied into a separate buffer.
+    /// @throws FileFormatException if the file does not exist.
+    FileView getFileContents(const std::string &filename);
+
+    /// Decompresses a BCFZ archive, returning the uncompressed filesystem.
+    /// @throws FileFormatException
+    static std::vector<std::byte> decompress(std::istream &stream);
 
 private:
-    void readUncompressedData(std::vector<std::byte> &data);
+    /// Returns the integer at the given offset (after the BCFS header), or
+    /// zero if the offset is past the end of the data.
+    uint32_t readUInt(size_t offset) const;
 
-    /// Maps filenames to file contents.
-    std::unordered_map<std::string, std::vector<std::byte>> myFiles;
+    /// The uncompressed filesystem, including the BCFS header.
+    std::vector<std::byte> myData;
+    /// Files whose sectors were not adjacent, and had to be assembled.
+    std::unordered_map<std::string, std::vector<std::byte>> myAssembledFiles;
 };
 
 } // namespace Gpx
@@ -21,34 +21,68 @@
 
 #include <formats/gp7/parser.h>
 #include <formats/gp7/converter.h>
+#include <formats/scoremetadata.h>
 #include <score/score.h>
 
 #include <boost/filesystem/fstream.hpp>
 #include <pugixml.hpp>
 
-#include <iostream>
+#include <optional>
 
 GpxImporter::GpxImporter()
     : FileFormatImporter(FileFormat("Guitar Pro 6", { "gpx" }))
 {
 }
 
-void
-GpxImporter::load(const boost::filesystem::path &filename, Score &score)
+/// Loads the score.gpif XML file from the .gpx archive. The XML document
+/// refers to the filesystem's buffer, so the filesystem must outlive it.
+static void
+loadScoreXml(const boost::filesystem::path &filename,
+             std::optional<Gpx::FileSystem> &fs, pugi::xml_document &xml_doc)
 {
     // Load the data, decompress, and open as XML document.
     boost::filesystem::ifstream file(filename, std::ios::binary | std::ios::in);
-    Gpx::FileSystem fs(file);
-
-    std::vector<std::byte> buffer = fs.getFileContents("score.gpif");
+    fs.emplace(file);
 
-    // Parse as an XML file.
-    pugi::xml_document xml_doc;
-    pugi::xml_parse_result result =
-        xml_doc.load_buffer_inplace(buffer.data(), buffer.size());
+    // Parse the XML file directly from the decompressed data.
+    const Gpx::FileSystem::FileView score_xml =
+        fs->getFileContents("score.gpif");
+    pugi::xml_parse_result result = xml_doc.load_buffer_inplace(
+        score_xml.myData, score_xml.mySize, Gp7::PARSE_OPTIONS);
     if (!result)
         throw FileFormatException(result.description());
+}
+
+void
+GpxImporter::load(const boost::filesystem::path &filename, Score &score)
+{
+    std::optional<Gpx::FileSystem> fs;
+    pugi::xml_document xml_doc;
+    loadScoreXml(filename, fs, xml_doc);
 
     Gp7::Document doc = Gp7::parse(xml_doc, Gp7::Version::V6);
+
+    // Release the XML data before building the score.
+    xml_doc.reset();
+    fs.reset();
+
     Gp7::convert(doc, score);
 }
+
+ScoreMetadata
+GpxImporter::probe(const boost::filesystem::path &filename)
+{
+    std::optional<Gpx::FileSystem> fs;
+    pugi::xml_document xml_doc;
+    loadScoreXml(filename, fs, xml_doc);
+
+    return Gp7::convertMetadata(Gp7::parseHeader(xml_doc, Gp7::Version::V6));
+}
+
+bool
+GpxImporter::canRead(std::string_view header) const
+{
+    // The archive is either compressed (BCFZ) or uncompressed (BCFS).
+    const std::string_view magic = header.substr(0, 4);
+    return magic == "BCFZ" || magic == "BCFS";
+}
@@ -213,7 +213,7 @@ void Header::load(InputStream &stream)
 
     const uint32_t n = stream.read<uint32_t>();
     for (uint32_t i = 0; i < n; ++i)
-        myNotices.push_back(stream.readString());
+        myNotices.emplace_back(stream.readString());
 
     if (stream.version() <= Version4)
         myTripletFeel = stream.readBool();
@@ -225,7 +225,7 @@ void Header::load(InputStream &stream)
         for (int i = 0; i < NUM_LYRIC_LINES; ++i)
         {
             const int n = stream.read<int32_t>();
-            myLyrics.emplace_back(n, stream.readIntString());
+            myLyrics.emplace_back(n, std::string(stream.readIntString()));
         }
     }
 
@@ -1084,6 +1084,14 @@ void Track::load(InputStream &stream)
 }
 
 void Document::load(InputStream &stream)
+{
+    loadHeader(stream);
+
+    for (Measure &measure : myMeasures)
+        measure.loadStaves(stream, myTracks);
+}
+
+void Document::loadHeader(InputStream &stream)
 {
     myHeader.load(stream);
 
@@ -1172,9 +1180,6 @@ void Document::load(InputStream &stream)
         stream.skip(2);
     else if (stream.version() == Version5_1)
         stream.skip(1);
-
-    for (int i = 0; i < numMeasures; ++i)
-        myMeasures[i].loadStaves(stream, myTracks);
 }
 
 }
@@ -280,6 +280,9 @@ struct DirectionMap
 struct Document
 {
     void load(InputStream &stream);
+    /// Loads everything except for the contents of each bar (i.e. the
+    /// measure headers and tracks are loaded, but not the notes).
+    void loadHeader(InputStream &stream);
 
     Header myHeader;
     int myStartTempo = 0;
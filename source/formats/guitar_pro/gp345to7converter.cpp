@@ -22,20 +22,20 @@
 #include <cmath>
 
 static Gp7::ScoreInfo
-convertScoreInfo(const Gp::Document &doc)
+convertScoreInfo(Gp::Document &doc)
 {
-    const Gp::Header &header = doc.myHeader;
+    Gp::Header &header = doc.myHeader;
 
     Gp7::ScoreInfo gp7_info;
-    gp7_info.myTitle = header.myTitle;
-    gp7_info.mySubtitle = header.mySubtitle;
-    gp7_info.myArtist = header.myArtist;
-    gp7_info.myAlbum = header.myAlbum;
-    gp7_info.myWords = header.myLyricist;
-    gp7_info.myMusic = header.myComposer;
-    gp7_info.myCopyright = header.myCopyright;
-    gp7_info.myTabber = header.myTranscriber;
-    gp7_info.myInstructions = header.myInstructions;
+    gp7_info.myTitle = std::move(header.myTitle);
+    gp7_info.mySubtitle = std::move(header.mySubtitle);
+    gp7_info.myArtist = std::move(header.myArtist);
+    gp7_info.myAlbum = std::move(header.myAlbum);
+    gp7_info.myWords = std::move(header.myLyricist);
+    gp7_info.myMusic = std::move(header.myComposer);
+    gp7_info.myCopyright = std::move(header.myCopyright);
+    gp7_info.myTabber = std::move(header.myTranscriber);
+    gp7_info.myInstructions = std::move(header.myInstructions);
     gp7_info.myNotices = boost::algorithm::join(header.myNotices, "\n");
 
     // Decide how the measures are split into systems.
@@ -82,7 +82,7 @@ convertTracks(const Gp::Document &doc)
         sound.myMidiPreset = channel.myInstrument;
         gp7_track.mySounds = { sound };
 
-        gp7_tracks.push_back(gp7_track);
+        gp7_tracks.push_back(std::move(gp7_track));
     }
 
     return gp7_tracks;
@@ -392,9 +392,9 @@ convertBeat(const Gp::Beat &beat, const Gp::Track &track,
 }
 
 static void
-convertMasterBars(const Gp::Document &doc, Gp7::Document &gp7_doc)
+convertMasterBars(Gp::Document &doc, Gp7::Document &gp7_doc)
 {
-    for (const Gp::Measure &measure : doc.myMeasures)
+    for (Gp::Measure &measure : doc.myMeasures)
     {
         Gp7::MasterBar master_bar;
         master_bar.myDoubleBar = measure.myIsDoubleBar;
@@ -406,7 +406,7 @@ convertMasterBars(const Gp::Document &doc, Gp7::Document &gp7_doc)
         if (measure.myMarker)
         {
             Gp7::MasterBar::Section section;
-            section.myText = *measure.myMarker;
+            section.myText = std::move(*measure.myMarker);
             master_bar.mySection = section;
         }
 
@@ -445,7 +445,7 @@ convertMasterBars(const Gp::Document &doc, Gp7::Document &gp7_doc)
         {
             Gp7::TempoChange tempo_change;
             tempo_change.myBeatsPerMinute = doc.myStartTempo;
-            tempo_change.myDescription = doc.myStartTempoName;
+            tempo_change.myDescription = std::move(doc.myStartTempoName);
             tempo_change.myIsVisible = doc.myStartTempoVisible;
             master_bar.myTempoChanges.push_back(tempo_change);
         }
@@ -515,7 +515,12 @@ convertMasterBars(const Gp::Document &doc, Gp7::Document &gp7_doc)
             gp7_doc.addBar(master_bar, std::move(bar));
         }
 
-        gp7_doc.myMasterBars.push_back(master_bar);
+        // The measure's notes are no longer needed. Tied notes are found by
+        // searching the GP7 document.
+        measure.myStaves.clear();
+        measure.myStaves.shrink_to_fit();
+
+        gp7_doc.myMasterBars.push_back(std::move(master_bar));
     }
 }
 
@@ -558,7 +563,7 @@ convertDirections(const Gp::DirectionMap &dirs, Gp7::Document &gp7_doc)
 }
 
 Gp7::Document
-Gp::convertToGp7(const Gp::Document &doc)
+Gp::convertToGp7(Gp::Document &&doc)
 {
     Gp7::Document gp7_doc;
     gp7_doc.myScoreInfo = convertScoreInfo(doc);
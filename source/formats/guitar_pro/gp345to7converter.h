@@ -24,7 +24,9 @@
 namespace Gp
 {
 /// Converts the Guitar Pro 3/4/5 document into a GP 7 document.
-Gp7::Document convertToGp7(const Gp::Document &doc);
+/// The contents of each measure are released once they have been converted,
+/// so that the notes are not held in memory in both formats.
+Gp7::Document convertToGp7(Gp::Document &&doc);
 }
 
 #endif
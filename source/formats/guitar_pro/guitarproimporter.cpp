@@ -18,10 +18,12 @@
 #include "guitarproimporter.h"
 #include "gp345to7converter.h"
 
-#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include <formats/gp7/converter.h>
 #include <formats/gp7/parser.h>
+#include <formats/scoremetadata.h>
 #include <formats/guitar_pro/document.h>
 #include <formats/guitar_pro/inputstream.h>
 
@@ -31,17 +33,69 @@ GuitarProImporter::GuitarProImporter()
 {
 }
 
+/// Maps the entire file into memory, so that it can be parsed without any
+/// copies.
+static boost::iostreams::mapped_file_source
+mapFile(const boost::filesystem::path &filename)
+{
+    // Empty files cannot be mapped.
+    if (boost::filesystem::file_size(filename) == 0)
+        throw FileFormatException("The file is empty.");
+
+    return boost::iostreams::mapped_file_source(filename);
+}
+
+static const std::byte *
+getData(const boost::iostreams::mapped_file_source &file)
+{
+    return reinterpret_cast<const std::byte *>(file.data());
+}
+
 void
 GuitarProImporter::load(const boost::filesystem::path &filename, Score &score)
 {
-    boost::filesystem::ifstream in(filename, std::ios::binary | std::ios::in);
-    Gp::InputStream stream(in);
+    const boost::iostreams::mapped_file_source file = mapFile(filename);
+    Gp::InputStream stream(getData(file), file.size());
 
     Gp::Document document;
     document.load(stream);
 
     // Convert to the GP7 intermediate format, which then can be converted to
     // our score format.
-    Gp7::Document gp7_doc = Gp::convertToGp7(document);
+    // The GP document is released as it is converted, so that the notes are
+    // not held in memory in all three formats at once.
+    const Gp7::Document gp7_doc = Gp::convertToGp7(std::move(document));
     Gp7::convert(gp7_doc, score);
 }
+
+ScoreMetadata
+GuitarProImporter::probe(const boost::filesystem::path &filename)
+{
+    const boost::iostreams::mapped_file_source file = mapFile(filename);
+    Gp::InputStream stream(getData(file), file.size());
+
+    // The bar and track headers are stored before any of the notes, so the
+    // rest of the file can be skipped. Tempo changes after the start of the
+    // song are stored with the notes, so the duration is estimated from the
+    // initial tempo.
+    Gp::Document document;
+    document.loadHeader(stream);
+
+    return Gp7::convertMetadata(Gp::convertToGp7(std::move(document)));
+}
+
+bool
+GuitarProImporter::canRead(std::string_view header) const
+{
+    // The file begins with a length-prefixed version string, which is stored
+    // in a 30 character field.
+    if (header.empty())
+        return false;
+
+    const size_t length = static_cast<uint8_t>(header[0]);
+    if (length > 30 || header.size() < length + 1)
+        return false;
+
+    return Gp::InputStream::isSupportedVersion(
+        std::string(header.substr(1, length)));
+}
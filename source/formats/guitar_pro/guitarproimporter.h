@@ -27,6 +27,8 @@ public:
     GuitarProImporter();
 
     void load(const boost::filesystem::path &filename, Score &score) override;
+    ScoreMetadata probe(const boost::filesystem::path &filename) override;
+    bool canRead(std::string_view header) const override;
 };
 
 #endif
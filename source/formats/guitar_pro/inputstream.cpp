@@ -17,7 +17,9 @@
 
 #include "inputstream.h"
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <map>
 
 #include <formats/fileformat.h>
@@ -31,11 +33,26 @@ const std::map<std::string, Gp::Version> theVersionStrings = {
     { "FICHIER GUITAR PRO v5.10", Gp::Version5_1 }
 };
 
-Gp::InputStream::InputStream(std::istream &stream) : myStream(stream)
+Gp::InputStream::InputStream(const std::byte *data, size_t size)
+    : myData(data), mySize(size), myPosition(0)
 {
-    myStream.exceptions(std::istream::failbit | std::istream::badbit |
-                       std::istream::eofbit);
+    readVersion();
+}
+
+Gp::InputStream::InputStream(std::istream &stream) : myPosition(0)
+{
+    std::transform(std::istreambuf_iterator<char>(stream),
+                   std::istreambuf_iterator<char>(),
+                   std::back_inserter(myBuffer),
+                   [](char c) { return static_cast<std::byte>(c); });
+    myData = myBuffer.data();
+    mySize = myBuffer.size();
+
+    readVersion();
+}
 
+void Gp::InputStream::readVersion()
+{
     const std::string versionString = readVersionString();
 
     auto it = theVersionStrings.find(versionString);
@@ -47,52 +64,56 @@ Gp::InputStream::InputStream(std::istream &stream) : myStream(stream)
 
 std::string Gp::InputStream::readVersionString()
 {
-    myStream.seekg(std::ios_base::beg);
+    myPosition = 0;
 
     // THe version consists of a 30 character string, although not all 30
     // characters may be used.
-    std::string version = readCharacterString<uint8_t>();
+    std::string version(readCharacterString<uint8_t>());
 
     // Skip past any unread characters to land at position 0x1f.
-    myStream.seekg(31, std::ios_base::beg);
+    myPosition = 0;
+    advance(31);
 
     return version;
 }
 
-std::string Gp::InputStream::readString()
+void Gp::InputStream::throwEndOfFile()
+{
+    throw FileFormatException("Unexpected end of file");
+}
+
+bool Gp::InputStream::isSupportedVersion(const std::string &version)
+{
+    return theVersionStrings.find(version) != theVersionStrings.end();
+}
+
+std::string_view Gp::InputStream::readString()
 {
     [[maybe_unused]] const uint32_t size = read<uint32_t>();
 
-    std::string str = readCharacterString<uint8_t>();
+    std::string_view str = readCharacterString<uint8_t>();
     assert(size - 1 == str.length());
 
     return str;
 }
 
-std::string Gp::InputStream::readIntString()
+std::string_view Gp::InputStream::readIntString()
 {
     return readCharacterString<uint32_t>();
 }
 
-std::string Gp::InputStream::readFixedLengthString(uint32_t maxLength)
+std::string_view Gp::InputStream::readFixedLengthString(uint32_t maxLength)
 {
     const uint8_t actualLength = read<uint8_t>();
+    const size_t length = (maxLength != 0) ? maxLength : actualLength;
 
-    std::string str;
-
-    if (maxLength != 0)
-        str.resize(maxLength);
-    else
-        str.resize(actualLength);
-
-    if (str.size() != 0)
-        myStream.read(&str[0], str.size());
-
-    str.resize(actualLength);
-    return str;
+    const auto data = reinterpret_cast<const char *>(advance(length));
+    return std::string_view(data, std::min<size_t>(actualLength, length));
 }
 
 void Gp::InputStream::skip(int numBytes)
 {
-    myStream.seekg(numBytes, std::ios_base::cur);
+    // Like seeking in a stream, skipping past the end is not an error until
+    // the next read.
+    myPosition = std::min<size_t>(myPosition + numBytes, mySize);
 }
@@ -19,19 +19,33 @@
 #define FORMATS_GP_STREAM_H
 
 #include <boost/endian/conversion.hpp>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <istream>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "document.h"
 
 namespace Gp
 {
+/// Reads the data types used in Guitar Pro files from an in-memory buffer
+/// (e.g. a memory-mapped file). All reads are bounds-checked.
 class InputStream
 {
 public:
+    /// Reads from the given data, which must outlive the stream.
+    /// @throws FileFormatException if the file version is not supported.
+    InputStream(const std::byte *data, size_t size);
+    /// Reads the remaining contents of the stream into memory.
+    /// @throws FileFormatException if the file version is not supported.
     InputStream(std::istream &stream);
 
+    InputStream(const InputStream &) = delete;
+    InputStream &operator=(const InputStream &) = delete;
+
     /// Returns the file version.
     Version version() const;
 
@@ -44,39 +58,67 @@ public:
 
     /// Reads a string in the most common format for Guitar Pro - an integer
     /// representing the size of the stored information + 1, followed by the
-    /// length-prefixed string of characters representing the data
-    std::string readString();
+    /// length-prefixed string of characters representing the data.
+    /// The returned strings refer to the stream's data.
+    std::string_view readString();
 
     /// Reads a string prefixed with 4 bytes that indicate the length.
-    std::string readIntString();
+    std::string_view readIntString();
 
     /// Reads a fixed length string (any unused characters trailing the string
     /// are skipped).
-    std::string readFixedLengthString(uint32_t maxLength);
+    std::string_view readFixedLengthString(uint32_t maxLength);
 
     std::string readVersionString();
 
+    /// Returns whether the version string is from a supported file version.
+    static bool isSupportedVersion(const std::string &version);
+
     void skip(int numBytes);
 
 private:
+    /// Reads the file version from the start of the data.
+    void readVersion();
+
+    /// Returns the next n bytes, and moves past them.
+    /// @throws FileFormatException if there are not enough bytes remaining.
+    const std::byte *advance(size_t n);
+
+    [[noreturn]] static void throwEndOfFile();
+
     /// Reads a character string.
     /// The string consists of some number of bytes (encoding the length of the
     /// string, n) followed by n characters.  This is templated on the length
     /// prefix type, to allow for strings prefixed with a 2-byte length value,
     /// 4-byte length value, etc
     template <class LengthPrefixType>
-    std::string readCharacterString();
+    std::string_view readCharacterString();
 
-    std::istream &myStream;
+    /// Holds the data if it was read from a stream.
+    std::vector<std::byte> myBuffer;
+    const std::byte *myData;
+    size_t mySize;
+    size_t myPosition;
     Version myVersion;
 };
 
+inline const std::byte *
+InputStream::advance(size_t n)
+{
+    if (n > mySize - myPosition)
+        throwEndOfFile();
+
+    const std::byte *data = myData + myPosition;
+    myPosition += n;
+    return data;
+}
+
 template <class T>
 inline T InputStream::read()
 {
     static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
     T data;
-    myStream.read((char *)&data, sizeof(data));
+    std::memcpy(&data, advance(sizeof(data)), sizeof(data));
     // The values are stored in little-endian format.
     return boost::endian::little_to_native(data);
 }
@@ -88,20 +130,14 @@ InputStream::readBool()
 }
 
 template <typename LengthPrefixType>
-inline std::string InputStream::readCharacterString()
+inline std::string_view InputStream::readCharacterString()
 {
     static_assert(std::is_integral<LengthPrefixType>::value,
                   "LengthPrefixType must be an integral type");
 
-    const LengthPrefixType length = read<LengthPrefixType>();
-
-    std::string str;
-    str.resize(length);
-
-    if (length != 0)
-        myStream.read(&str[0], length);
-
-    return str;
+    const auto length = static_cast<size_t>(read<LengthPrefixType>());
+    return std::string_view(reinterpret_cast<const char *>(advance(length)),
+                            length);
 }
 
 inline Version
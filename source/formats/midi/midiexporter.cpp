@@ -21,41 +21,48 @@
 #include <audio/settings.h>
 #include <midi/midifile.h>
 #include <score/generalmidi.h>
+#include <util/parallel.h>
 
-#include <array>
 #include <boost/endian/conversion.hpp>
 #include <boost/filesystem/fstream.hpp>
-#include <cstdint>
+#include <cassert>
+#include <ostream>
 
 template <typename T>
-static void write(std::ostream &os, T val)
+static void write(std::vector<uint8_t> &data, T val)
 {
     val = boost::endian::native_to_big(val);
-    os.write(reinterpret_cast<const char *>(&val), sizeof(T));
+    const auto bytes = reinterpret_cast<const uint8_t *>(&val);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
 }
 
-static void writeVariableLength(std::ostream &os, uint32_t val)
+static void writeChunkId(std::vector<uint8_t> &data, const char *id)
 {
-    std::array<uint8_t, 5> bytes;
-    for (int i = 0; i < 5; ++i)
-        bytes[i] = (val >> ((4 - i) * 7)) & 0x7f;
+    data.insert(data.end(), id, id + 4);
+}
 
-    // Find the first byte that needs to be written.
-    int i = 0;
-    for (i = 0; i < 4; ++i)
-    {
-        if (bytes[i] != 0)
-            break;
-    }
+/// Returns the number of bytes needed to encode the value as a variable
+/// length quantity.
+static size_t getVariableLengthSize(uint32_t val)
+{
+    size_t size = 1;
+    while (val >>= 7)
+        ++size;
 
-    for (; i < 5; ++i)
-    {
-        // Set the top bit to indicate that more bytes will follow it.
-        if (i < 4)
-            bytes[i] |= 0x80;
+    return size;
+}
 
-        write(os, bytes[i]);
+static void writeVariableLength(std::vector<uint8_t> &data, uint32_t val)
+{
+    // Write the bytes from the most significant group of 7 bits, and set the
+    // top bit to indicate that more bytes will follow.
+    for (int shift = static_cast<int>(getVariableLengthSize(val) - 1) * 7;
+         shift > 0; shift -= 7)
+    {
+        data.push_back(((val >> shift) & 0x7f) | 0x80);
     }
+
+    data.push_back(val & 0x7f);
 }
 
 MidiExporter::MidiExporter(const SettingsManager &settings_manager)
@@ -64,11 +71,17 @@ MidiExporter::MidiExporter(const SettingsManager &settings_manager)
 {
 }
 
-void MidiExporter::save(const boost::filesystem::path &filename, const Score &score)
+void MidiExporter::save(const boost::filesystem::path &filename,
+                        const Score &score)
 {
     boost::filesystem::ofstream os(filename, std::ios::out | std::ios::binary);
     os.exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
 
+    save(os, score);
+}
+
+void MidiExporter::save(std::ostream &os, const Score &score)
+{
     MidiFile::LoadOptions options;
     options.myEnableMetronome = false;
     options.myRecordPositionChanges = false;
@@ -86,50 +99,67 @@ void MidiExporter::save(const boost::filesystem::path &filename, const Score &sc
 
     MidiFile file;
     file.load(score, options);
-    writeHeader(os, file);
 
-    for (const MidiEventList &track : file.getTracks())
-        writeTrack(os, track);
+    // Encode the tracks independently, and then write out each chunk with a
+    // single call.
+    const std::vector<MidiEventList> &tracks = file.getTracks();
+    std::vector<std::vector<uint8_t>> chunks(tracks.size());
+    Util::parallelFor(tracks.size(),
+                      [&](size_t i) { chunks[i] = encodeTrack(tracks[i]); });
+
+    const std::vector<uint8_t> header = encodeHeader(file);
+    os.write(reinterpret_cast<const char *>(header.data()), header.size());
+
+    for (const std::vector<uint8_t> &chunk : chunks)
+        os.write(reinterpret_cast<const char *>(chunk.data()), chunk.size());
 }
 
-void MidiExporter::writeHeader(std::ostream &os, const MidiFile &file)
+std::vector<uint8_t> MidiExporter::encodeHeader(const MidiFile &file)
 {
+    std::vector<uint8_t> data;
+    data.reserve(14);
+
     // Chunk ID for the header chunk.
-    os << "MThd";
+    writeChunkId(data, "MThd");
     // 6 bytes will follow the chunk size.
-    write(os, static_cast<uint32_t>(6));
+    write(data, static_cast<uint32_t>(6));
 
     // A format type of 1 indicates that we'll have multiple tracks.
-    write(os, static_cast<uint16_t>(1));
-    write(os, static_cast<uint16_t>(file.getTracks().size()));
+    write(data, static_cast<uint16_t>(1));
+    write(data, static_cast<uint16_t>(file.getTracks().size()));
 
     // Time division.
-    write(os, static_cast<uint16_t>(file.getTicksPerBeat()));
+    write(data, static_cast<uint16_t>(file.getTicksPerBeat()));
+
+    return data;
 }
 
-void MidiExporter::writeTrack(std::ostream & os, const MidiEventList & events)
+std::vector<uint8_t> MidiExporter::encodeTrack(const MidiEventList &events)
 {
-    // Chunk ID for a track chunk.
-    os << "MTrk";
+    // Compute the size in bytes of the track's events, so that the chunk
+    // length is known up front and the buffer is only allocated once.
+    size_t length = 0;
+    for (const MidiEvent &event : events)
+    {
+        length +=
+            getVariableLengthSize(event.getTicks()) + event.getData().size();
+    }
 
-    // Size in bytes of the track chunk. This will be updated after writing out
-    // all of the data.
-    const std::iostream::pos_type chunk_len_pos = os.tellp();
-    write(os, static_cast<uint32_t>(0));
+    std::vector<uint8_t> data;
+    data.reserve(8 + length);
+
+    // Chunk ID for a track chunk, followed by its size in bytes.
+    writeChunkId(data, "MTrk");
+    write(data, static_cast<uint32_t>(length));
 
     // Write out the MIDI events.
-    const std::iostream::pos_type chunk_start_pos = os.tellp();
     for (const MidiEvent &event : events)
     {
-        writeVariableLength(os, event.getTicks());
-        os.write(reinterpret_cast<const char *>(event.getData().data()),
-                 event.getData().size());
+        writeVariableLength(data, event.getTicks());
+        data.insert(data.end(), event.getData().begin(),
+                    event.getData().end());
     }
 
-    const std::iostream::pos_type chunk_end_pos = os.tellp();
-
-    // Record the size in bytes of the track chunk.
-    os.seekp(chunk_len_pos);
-    write(os, static_cast<uint32_t>(chunk_end_pos - chunk_start_pos));
-    os.seekp(chunk_end_pos);
+    assert(data.size() == 8 + length);
+    return data;
 }
@@ -18,7 +18,10 @@
 #ifndef FORMATS_MIDIEXPORTER_H
 #define FORMATS_MIDIEXPORTER_H
 
+#include <cstdint>
 #include <formats/fileformatmanager.h>
+#include <iosfwd>
+#include <vector>
 
 class MidiEventList;
 class MidiFile;
@@ -31,9 +34,16 @@ public:
     virtual void save(const boost::filesystem::path &filename,
                       const Score &score) override;
 
+    /// Writes the score as a MIDI file. The stream is only written to
+    /// sequentially, so it does not need to be seekable (e.g. stdout or a
+    /// pipe).
+    void save(std::ostream &os, const Score &score);
+
 private:
-    static void writeHeader(std::ostream &os, const MidiFile &file);
-    static void writeTrack(std::ostream &os, const MidiEventList &events);
+    /// Encodes the header chunk.
+    static std::vector<uint8_t> encodeHeader(const MidiFile &file);
+    /// Encodes a complete track chunk, including its header and length.
+    static std::vector<uint8_t> encodeTrack(const MidiEventList &events);
 
     const SettingsManager &mySettingsManager;
 };
@@ -0,0 +1,58 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "midiimporter.h"
+
+#include "smfconverter.h"
+#include "smfparser.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <formats/scoremetadata.h>
+#include <score/score.h>
+
+MidiImporter::MidiImporter()
+    : FileFormatImporter(FileFormat("MIDI File", { "mid" }))
+{
+}
+
+/// Maps the entire file into memory and parses it.
+static Smf::Document parseFile(const boost::filesystem::path &filename)
+{
+    // Empty files cannot be mapped.
+    if (boost::filesystem::file_size(filename) == 0)
+        throw FileFormatException("The file is empty.");
+
+    const boost::iostreams::mapped_file_source file(filename);
+    return Smf::parse(reinterpret_cast<const std::byte *>(file.data()),
+                      file.size());
+}
+
+void MidiImporter::load(const boost::filesystem::path &filename, Score &score)
+{
+    Smf::convert(parseFile(filename), score);
+}
+
+ScoreMetadata MidiImporter::probe(const boost::filesystem::path &filename)
+{
+    return Smf::convertMetadata(parseFile(filename));
+}
+
+bool MidiImporter::canRead(std::string_view header) const
+{
+    return Smf::hasHeader(header);
+}
@@ -0,0 +1,33 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FORMATS_MIDIIMPORTER_H
+#define FORMATS_MIDIIMPORTER_H
+
+#include <formats/fileformat.h>
+
+class MidiImporter : public FileFormatImporter
+{
+public:
+    MidiImporter();
+
+    void load(const boost::filesystem::path &filename, Score &score) override;
+    ScoreMetadata probe(const boost::filesystem::path &filename) override;
+    bool canRead(std::string_view header) const override;
+};
+
+#endif
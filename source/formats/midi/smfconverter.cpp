@@ -0,0 +1,883 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "smfconverter.h"
+#include "smfparser.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <optional>
+
+#include <formats/fileformat.h>
+#include <formats/scoremetadata.h>
+#include <score/generalmidi.h>
+#include <score/irregulargrouping.h>
+#include <score/keysignature.h>
+#include <score/note.h>
+#include <score/playerchange.h>
+#include <score/position.h>
+#include <score/score.h>
+#include <score/system.h>
+#include <score/tempomarker.h>
+#include <score/timesignature.h>
+#include <score/utils.h>
+#include <score/utils/scorepolisher.h>
+
+namespace
+{
+/// Times are measured in units of 1/24 of a quarter note, which can exactly
+/// represent both 32nd notes and eighth note triplets.
+const int UNITS_PER_QUARTER = 24;
+/// Notes are quantized to sixteenth notes, or to eighth note triplets within
+/// a quarter note beat that fits a triplet rhythm more closely.
+const int STRAIGHT_GRID = UNITS_PER_QUARTER / 4;
+const int TRIPLET_GRID = UNITS_PER_QUARTER / 3;
+
+/// Start a new system once a system has this many positions.
+const int POSITION_LIMIT = 30;
+/// Protects against corrupt files with events at a huge time.
+const size_t MAX_BARS = 100000;
+/// The highest fret that notes are assigned to.
+const int MAX_FRET = 24;
+
+const int PERCUSSION_CHANNEL = 9;
+const int FIRST_BASS_PRESET = 32;
+const int LAST_BASS_PRESET = 39;
+
+struct Bar
+{
+    int64_t myStart = 0;
+    int myBeats = 4;
+    int myBeatValue = 4;
+    /// Index of the bar's first beat from the start of the song.
+    size_t myFirstBeat = 0;
+    /// The tempo change in this bar, in quarter notes per minute.
+    std::optional<int> myTempo;
+    std::optional<Smf::KeySignatureChange> myKeySignature;
+
+    int getBeatLength() const { return UNITS_PER_QUARTER * 4 / myBeatValue; }
+    int getLength() const { return myBeats * getBeatLength(); }
+    int64_t getEnd() const { return myStart + getLength(); }
+
+    int getStraightGrid() const
+    {
+        return std::min(STRAIGHT_GRID, getBeatLength());
+    }
+
+    /// Only quarter note beats can be divided into eighth note triplets.
+    bool allowsTriplets() const { return getBeatLength() == UNITS_PER_QUARTER; }
+};
+
+class TimeConverter
+{
+public:
+    explicit TimeConverter(int ticks_per_quarter)
+        : myUnitsPerTick(static_cast<double>(UNITS_PER_QUARTER) /
+                         ticks_per_quarter)
+    {
+    }
+
+    double toUnits(int64_t ticks) const { return ticks * myUnitsPerTick; }
+
+    int64_t toRoundedUnits(int64_t ticks) const
+    {
+        return std::llround(toUnits(ticks));
+    }
+
+private:
+    const double myUnitsPerTick;
+};
+
+bool isImported(const Smf::Part &part)
+{
+    return part.myChannel != PERCUSSION_CHANNEL;
+}
+
+bool isBass(const Smf::Part &part)
+{
+    return part.myProgram >= FIRST_BASS_PRESET &&
+           part.myProgram <= LAST_BASS_PRESET;
+}
+
+bool isValidTimeSignature(const Smf::TimeSignatureChange &change)
+{
+    return change.myBeats >= TimeSignature::MIN_BEATS_PER_MEASURE &&
+           change.myBeats <= TimeSignature::MAX_BEATS_PER_MEASURE &&
+           TimeSignature::isValidBeatValue(change.myBeatValue);
+}
+
+/// Divides the song into bars using the time signature changes. A change in
+/// the middle of a bar takes effect from the next bar.
+std::vector<Bar> computeBars(const Smf::Document &doc,
+                             const TimeConverter &time)
+{
+    int64_t end_ticks = 0;
+    for (const Smf::Part &part : doc.myParts)
+    {
+        if (!isImported(part))
+            continue;
+
+        for (const Smf::Note &note : part.myNotes)
+            end_ticks = std::max(end_ticks, note.myEnd);
+    }
+    const double end = time.toUnits(end_ticks);
+
+    auto time_sig = doc.myTimeSignatures.begin();
+    auto tempo = doc.myTempoChanges.begin();
+    auto key_sig = doc.myKeySignatures.begin();
+
+    std::vector<Bar> bars;
+    Bar bar;
+    do
+    {
+        for (; time_sig != doc.myTimeSignatures.end() &&
+               time.toRoundedUnits(time_sig->myTicks) <= bar.myStart;
+             ++time_sig)
+        {
+            if (isValidTimeSignature(*time_sig))
+            {
+                bar.myBeats = time_sig->myBeats;
+                bar.myBeatValue = time_sig->myBeatValue;
+            }
+        }
+
+        // Only the first tempo change in a bar is used, and it takes effect
+        // at the start of the bar.
+        bar.myTempo.reset();
+        for (; tempo != doc.myTempoChanges.end() &&
+               time.toRoundedUnits(tempo->myTicks) < bar.getEnd();
+             ++tempo)
+        {
+            if (!bar.myTempo)
+            {
+                bar.myTempo = static_cast<int>(
+                    std::lround(60e6 / tempo->myMicrosecondsPerQuarter));
+            }
+        }
+
+        bar.myKeySignature.reset();
+        for (; key_sig != doc.myKeySignatures.end() &&
+               time.toRoundedUnits(key_sig->myTicks) < bar.getEnd();
+             ++key_sig)
+        {
+            if (!bar.myKeySignature &&
+                std::abs(key_sig->myAccidentals) <=
+                    KeySignature::MAX_NUM_ACCIDENTALS)
+            {
+                bar.myKeySignature = *key_sig;
+            }
+        }
+
+        bars.push_back(bar);
+        if (bars.size() > MAX_BARS)
+            throw FileFormatException("The file is too long.");
+
+        bar.myFirstBeat += bar.myBeats;
+        bar.myStart = bar.getEnd();
+    } while (bar.myStart < end);
+
+    return bars;
+}
+
+/// Rounds note times to the nearest position that can be notated. Each beat
+/// is quantized either to sixteenth notes or to eighth note triplets,
+/// whichever fits the part's notes in that beat more closely.
+class Quantizer
+{
+public:
+    Quantizer(const std::vector<Bar> &bars, const Smf::Part &part,
+              const TimeConverter &time)
+        : myBars(bars),
+          myTripletBeats(bars.back().myFirstBeat + bars.back().myBeats, false)
+    {
+        // The notes are ordered by their start time, so the bar can be found
+        // by stepping forward.
+        size_t bar_idx = 0;
+        auto note = part.myNotes.begin();
+        while (note != part.myNotes.end())
+        {
+            const double start = time.toUnits(note->myStart);
+            while (bar_idx + 1 < myBars.size() &&
+                   myBars[bar_idx + 1].myStart <= start)
+            {
+                ++bar_idx;
+            }
+
+            const Bar &bar = myBars[bar_idx];
+            const int beat = getBeat(bar, start);
+            const int64_t beat_start =
+                bar.myStart + int64_t(beat) * bar.getBeatLength();
+
+            // Measure how far the notes in this beat are from each grid.
+            double straight_error = 0;
+            double triplet_error = 0;
+            const auto first_note = note;
+            for (; note != part.myNotes.end(); ++note)
+            {
+                // Notes past the end of the last bar are grouped with its
+                // last beat.
+                const double offset = time.toUnits(note->myStart) - beat_start;
+                if (offset >= bar.getBeatLength() && note != first_note)
+                    break;
+
+                straight_error += getError(offset, bar.getStraightGrid());
+                triplet_error += getError(offset, TRIPLET_GRID);
+            }
+
+            if (bar.allowsTriplets() && triplet_error < straight_error)
+                myTripletBeats[bar.myFirstBeat + beat] = true;
+        }
+    }
+
+    bool isTriplet(const Bar &bar, int beat) const
+    {
+        return myTripletBeats[bar.myFirstBeat + beat];
+    }
+
+    /// Rounds the time to the grid for the beat that it is in.
+    int64_t quantize(double units) const
+    {
+        auto bar = std::upper_bound(
+            myBars.begin(), myBars.end(), units,
+            [](double t, const Bar &bar) { return t < bar.myStart; });
+        if (bar != myBars.begin())
+            --bar;
+
+        const int beat = getBeat(*bar, units);
+        const int64_t beat_start =
+            bar->myStart + int64_t(beat) * bar->getBeatLength();
+        const int grid =
+            isTriplet(*bar, beat) ? TRIPLET_GRID : bar->getStraightGrid();
+
+        return beat_start + std::llround((units - beat_start) / grid) * grid;
+    }
+
+    /// Returns the grid size for the beat containing the time.
+    int getGrid(int64_t units) const
+    {
+        auto bar = std::upper_bound(
+            myBars.begin(), myBars.end(), units,
+            [](int64_t t, const Bar &bar) { return t < bar.myStart; });
+        if (bar != myBars.begin())
+            --bar;
+
+        return isTriplet(*bar, getBeat(*bar, static_cast<double>(units)))
+                   ? TRIPLET_GRID
+                   : bar->getStraightGrid();
+    }
+
+private:
+    static int getBeat(const Bar &bar, double units)
+    {
+        const int beat =
+            static_cast<int>((units - bar.myStart) / bar.getBeatLength());
+        return std::clamp(beat, 0, bar.myBeats - 1);
+    }
+
+    static double getError(double offset, int grid)
+    {
+        return std::abs(offset - std::round(offset / grid) * grid);
+    }
+
+    const std::vector<Bar> &myBars;
+    std::vector<bool> myTripletBeats;
+};
+
+/// Assigns the notes of each chord to strings, preferring frets that are close
+/// to the previous chord.
+class Fingering
+{
+public:
+    explicit Fingering(const Tuning &tuning)
+    {
+        for (int i = 0; i < tuning.getStringCount(); ++i)
+            myOpenPitches.push_back(tuning.getNote(i, false));
+
+        myLowestPitch =
+            *std::min_element(myOpenPitches.begin(), myOpenPitches.end());
+        myHighestPitch =
+            *std::max_element(myOpenPitches.begin(), myOpenPitches.end()) +
+            MAX_FRET;
+    }
+
+    std::vector<Note> assign(std::vector<int> pitches)
+    {
+        // Shift any notes that are out of range by octaves.
+        for (int &pitch : pitches)
+        {
+            while (pitch < myLowestPitch)
+                pitch += 12;
+            while (pitch > myHighestPitch)
+                pitch -= 12;
+        }
+
+        // The strings are ordered from highest to lowest, so assign the
+        // highest notes first.
+        std::sort(pitches.begin(), pitches.end(), std::greater<int>());
+        pitches.erase(std::unique(pitches.begin(), pitches.end()),
+                      pitches.end());
+        const int num_strings = static_cast<int>(myOpenPitches.size());
+        if (pitches.size() > myOpenPitches.size())
+            pitches.resize(myOpenPitches.size());
+
+        std::vector<Note> notes;
+        int next_string = 0;
+        int fret_total = 0;
+        int num_fretted = 0;
+        for (size_t i = 0; i < pitches.size(); ++i)
+        {
+            // Leave enough strings for the remaining notes.
+            const int last_string =
+                num_strings - static_cast<int>(pitches.size() - i);
+
+            int best_string = -1;
+            int best_fret = 0;
+            double best_cost = std::numeric_limits<double>::max();
+            for (int string = next_string; string <= last_string; ++string)
+            {
+                const int fret = pitches[i] - myOpenPitches[string];
+                if (fret < 0 || fret > MAX_FRET)
+                    continue;
+
+                const double cost = (fret == 0)
+                                        ? std::min(myHandPosition, 2.0)
+                                        : std::abs(fret - myHandPosition);
+                if (cost < best_cost)
+                {
+                    best_string = string;
+                    best_fret = fret;
+                    best_cost = cost;
+                }
+            }
+
+            // Skip the note if it can't be played on the remaining strings.
+            if (best_string < 0)
+                continue;
+
+            notes.emplace_back(best_string, best_fret);
+            next_string = best_string + 1;
+
+            if (best_fret > 0)
+            {
+                fret_total += best_fret;
+                ++num_fretted;
+            }
+        }
+
+        if (num_fretted > 0)
+            myHandPosition = static_cast<double>(fret_total) / num_fretted;
+
+        return notes;
+    }
+
+private:
+    std::vector<int> myOpenPitches;
+    int myLowestPitch;
+    int myHighestPitch;
+    double myHandPosition = 0;
+};
+
+struct QuantizedNote
+{
+    int64_t myStart;
+    int64_t myEnd;
+    int myPitch;
+};
+
+/// The positions of a part for one bar, numbered from the start of the bar.
+struct BarContent
+{
+    std::vector<Position> myPositions;
+    /// For each position, the start of the triplet beat that it is in (or -1).
+    std::vector<int64_t> myTripletBeats;
+};
+
+class PartConverter
+{
+public:
+    PartConverter(const std::vector<Bar> &bars, const Smf::Part &part,
+                  const Tuning &tuning, const TimeConverter &time)
+        : myQuantizer(bars, part, time), myFingering(tuning)
+    {
+        myNotes.reserve(part.myNotes.size());
+        for (const Smf::Note &note : part.myNotes)
+        {
+            const int64_t start = myQuantizer.quantize(time.toUnits(note.myStart));
+            int64_t end = myQuantizer.quantize(time.toUnits(note.myEnd));
+            if (end <= start)
+                end = start + myQuantizer.getGrid(start);
+
+            // Quantizing preserves the order of the notes.
+            assert(myNotes.empty() || myNotes.back().myStart <= start);
+            myNotes.push_back({ start, end, note.myPitch });
+        }
+    }
+
+    BarContent convertBar(const Bar &bar)
+    {
+        BarContent content;
+        const int64_t bar_end = bar.getEnd();
+        int64_t time = bar.myStart;
+
+        // Continue any notes that were held across the barline.
+        std::vector<Note> sounding = std::move(myHeldNotes);
+        int64_t sounding_end = myHeldEnd;
+        bool tied = !sounding.empty();
+        myHeldNotes.clear();
+
+        while (time < bar_end)
+        {
+            const int64_t next_onset =
+                (myNextNote < myNotes.size() &&
+                 myNotes[myNextNote].myStart < bar_end)
+                    ? myNotes[myNextNote].myStart
+                    : bar_end;
+
+            if (next_onset > time)
+            {
+                if (!sounding.empty() && sounding_end > time)
+                {
+                    const int64_t end = std::min(sounding_end, next_onset);
+                    addSegment(content, bar, time, end, &sounding, tied);
+                    time = end;
+                }
+
+                if (next_onset > time)
+                {
+                    addSegment(content, bar, time, next_onset, nullptr, false);
+                    time = next_onset;
+                }
+
+                continue;
+            }
+
+            // Start a chord with all of the notes at this time.
+            std::vector<int> pitches;
+            sounding_end = time;
+            for (; myNextNote < myNotes.size() &&
+                   myNotes[myNextNote].myStart == time;
+                 ++myNextNote)
+            {
+                pitches.push_back(myNotes[myNextNote].myPitch);
+                sounding_end = std::max(sounding_end, myNotes[myNextNote].myEnd);
+            }
+
+            sounding = myFingering.assign(std::move(pitches));
+            tied = false;
+        }
+
+        if (!sounding.empty() && sounding_end > bar_end)
+        {
+            myHeldNotes = std::move(sounding);
+            myHeldEnd = sounding_end;
+        }
+
+        return content;
+    }
+
+private:
+    /// Adds positions for the notes (or a rest) between the two times.
+    void addSegment(BarContent &content, const Bar &bar, int64_t start,
+                    int64_t end, const std::vector<Note> *notes, bool tied)
+    {
+        // Triplet beats must be split from their neighbours, but consecutive
+        // straight beats can be notated together.
+        int64_t time = start;
+        while (time < end)
+        {
+            const int beat_length = bar.getBeatLength();
+            int beat = static_cast<int>((time - bar.myStart) / beat_length);
+            const bool triplet = myQuantizer.isTriplet(bar, beat);
+
+            int64_t piece_end = end;
+            for (++beat; beat < bar.myBeats; ++beat)
+            {
+                const int64_t beat_start = bar.myStart + int64_t(beat) * beat_length;
+                if (beat_start >= end)
+                    break;
+
+                if (triplet || myQuantizer.isTriplet(bar, beat))
+                {
+                    piece_end = beat_start;
+                    break;
+                }
+            }
+
+            addPositions(content, piece_end - time,
+                         triplet ? (time - (time - bar.myStart) % beat_length)
+                                 : -1,
+                         notes, tied);
+
+            // Any later positions continue the same notes.
+            tied = true;
+            time = piece_end;
+        }
+    }
+
+    /// Adds positions with a total duration of the given length.
+    void addPositions(BarContent &content, int64_t length,
+                      int64_t triplet_beat, const std::vector<Note> *notes,
+                      bool tied)
+    {
+        struct Duration
+        {
+            int myLength;
+            Position::DurationType myType;
+            bool myDotted;
+        };
+
+        static const Duration theDurations[] = {
+            { 96, Position::WholeNote, false },
+            { 72, Position::HalfNote, true },
+            { 48, Position::HalfNote, false },
+            { 36, Position::QuarterNote, true },
+            { 24, Position::QuarterNote, false },
+            { 18, Position::EighthNote, true },
+            { 12, Position::EighthNote, false },
+            { 9, Position::SixteenthNote, true },
+            { 6, Position::SixteenthNote, false },
+            { 3, Position::ThirtySecondNote, false }
+        };
+
+        // A full triplet beat is just a quarter note.
+        if (length == UNITS_PER_QUARTER)
+            triplet_beat = -1;
+
+        while (length > 0)
+        {
+            Position pos(static_cast<int>(content.myPositions.size()));
+
+            if (triplet_beat >= 0)
+            {
+                // Triplet notes are notated with 3/2 of their duration.
+                const int64_t notated_length =
+                    std::min<int64_t>(length, 2 * TRIPLET_GRID);
+                pos.setDurationType(notated_length == TRIPLET_GRID
+                                        ? Position::EighthNote
+                                        : Position::QuarterNote);
+                length -= notated_length;
+            }
+            else
+            {
+                auto duration = std::find_if(
+                    std::begin(theDurations), std::end(theDurations),
+                    [&](const Duration &d) { return d.myLength <= length; });
+                assert(duration != std::end(theDurations));
+                if (duration == std::end(theDurations))
+                    break;
+
+                pos.setDurationType(duration->myType);
+                pos.setProperty(Position::Dotted, duration->myDotted);
+                length -= duration->myLength;
+            }
+
+            if (notes)
+            {
+                for (Note note : *notes)
+                {
+                    note.setProperty(Note::Tied, tied);
+                    pos.insertNote(note);
+                }
+            }
+            else
+                pos.setRest();
+
+            content.myPositions.push_back(pos);
+            content.myTripletBeats.push_back(triplet_beat);
+            tied = true;
+        }
+    }
+
+    Quantizer myQuantizer;
+    Fingering myFingering;
+    std::vector<QuantizedNote> myNotes;
+    size_t myNextNote = 0;
+    /// Notes from the previous bar that are still sounding.
+    std::vector<Note> myHeldNotes;
+    int64_t myHeldEnd = 0;
+};
+
+Tuning getTuning(const Smf::Part &part)
+{
+    Tuning tuning;
+    if (isBass(part))
+    {
+        tuning.setNotes({ Midi::MIDI_NOTE_G2, Midi::MIDI_NOTE_D2,
+                          Midi::MIDI_NOTE_A1, Midi::MIDI_NOTE_E1 });
+    }
+
+    return tuning;
+}
+
+std::string getName(const Smf::Part &part,
+                    const std::vector<std::string> &preset_names)
+{
+    return part.myName.empty() ? preset_names.at(part.myProgram)
+                               : part.myName;
+}
+
+/// Creates a new system with a staff for each player.
+System createSystem(const Score &score, const std::vector<Staff::ClefType> &clefs)
+{
+    System system;
+    for (size_t i = 0; i < score.getPlayers().size(); ++i)
+    {
+        Staff staff(score.getPlayers()[i].getTuning().getStringCount());
+        staff.setClefType(clefs[i]);
+        system.insertStaff(staff);
+    }
+
+    return system;
+}
+
+void setTimeSignature(Barline &start_bar, Barline &end_bar, const Bar &bar,
+                      const Bar *prev_bar)
+{
+    TimeSignature time_sig;
+    time_sig.setBeatsPerMeasure(bar.myBeats);
+    time_sig.setNumPulses(bar.myBeats);
+    time_sig.setBeatValue(bar.myBeatValue);
+
+    // Set the time signature on the end bar, for consistency, but leave it
+    // invisible.
+    end_bar.setTimeSignature(time_sig);
+
+    // Display the time signature for the first bar in the score, or if there
+    // was a time signature change.
+    if (!prev_bar || prev_bar->myBeats != bar.myBeats ||
+        prev_bar->myBeatValue != bar.myBeatValue)
+    {
+        time_sig.setVisible();
+    }
+
+    start_bar.setTimeSignature(time_sig);
+}
+
+KeySignature convertKeySignature(const Smf::KeySignatureChange &change)
+{
+    KeySignature key_sig;
+    key_sig.setKeyType(change.myMinor ? KeySignature::Minor
+                                      : KeySignature::Major);
+    key_sig.setNumAccidentals(std::abs(change.myAccidentals));
+    key_sig.setSharps(change.myAccidentals >= 0);
+    return key_sig;
+}
+
+void setKeySignature(Barline &start_bar, Barline &end_bar,
+                     const KeySignature &key_sig, const KeySignature &prev_key_sig)
+{
+    // Set the key signature on the end bar, for consistency, but leave it
+    // invisible.
+    end_bar.setKeySignature(key_sig);
+
+    // Display the key signature for the first bar in the system, or if there
+    // was a key signature change.
+    KeySignature start_key_sig = key_sig;
+    const bool changed = !(key_sig == prev_key_sig);
+    if (start_bar.getPosition() == 0 || changed)
+    {
+        start_key_sig.setVisible();
+
+        // Set up a cancellation if necessary.
+        if (changed && key_sig.getNumAccidentals() == 0 &&
+            prev_key_sig.getNumAccidentals() != 0)
+        {
+            start_key_sig.setCancellation();
+            start_key_sig.setNumAccidentals(prev_key_sig.getNumAccidentals());
+            start_key_sig.setSharps(prev_key_sig.usesSharps());
+        }
+    }
+
+    start_bar.setKeySignature(start_key_sig);
+}
+} // namespace
+
+void Smf::convert(const Document &doc, Score &score)
+{
+    const TimeConverter time(doc.myTicksPerQuarter);
+    const std::vector<Bar> bars = computeBars(doc, time);
+    const std::vector<std::string> preset_names = Midi::getPresetNames();
+
+    // Create a player, instrument, and staff for each part.
+    std::vector<PartConverter> parts;
+    std::vector<Staff::ClefType> clefs;
+    PlayerChange initial_player_change;
+    for (const Part &part : doc.myParts)
+    {
+        if (!isImported(part))
+            continue;
+
+        const int idx = static_cast<int>(score.getPlayers().size());
+
+        Player player;
+        player.setDescription(getName(part, preset_names));
+        player.setTuning(getTuning(part));
+        score.insertPlayer(player);
+
+        Instrument instrument;
+        instrument.setDescription(preset_names.at(part.myProgram));
+        instrument.setMidiPreset(static_cast<uint8_t>(part.myProgram));
+        score.insertInstrument(instrument);
+
+        initial_player_change.insertActivePlayer(idx, ActivePlayer(idx, idx));
+        clefs.push_back(isBass(part) ? Staff::BassClef : Staff::TrebleClef);
+        parts.emplace_back(bars, part, player.getTuning(), time);
+    }
+
+    if (parts.empty())
+        throw FileFormatException("The file does not contain any notes.");
+
+    // Fill in each system with as many bars as will fit.
+    System system = createSystem(score, clefs);
+    system.insertPlayerChange(initial_player_change);
+    int start_pos = 0;
+    int system_bar_idx = 0;
+    int tempo = TempoMarker::DEFAULT_BEATS_PER_MINUTE;
+    KeySignature key_sig;
+
+    for (size_t bar_idx = 0; bar_idx < bars.size(); ++bar_idx)
+    {
+        const Bar &bar = bars[bar_idx];
+
+        std::vector<BarContent> contents;
+        contents.reserve(parts.size());
+        int width = 0;
+        for (PartConverter &part : parts)
+        {
+            contents.push_back(part.convertBar(bar));
+            width = std::max(
+                width, static_cast<int>(contents.back().myPositions.size()));
+        }
+
+        if (system_bar_idx > 0 && start_pos + width > POSITION_LIMIT)
+        {
+            score.insertSystem(system);
+            system = createSystem(score, clefs);
+            start_pos = 0;
+            system_bar_idx = 0;
+        }
+
+        for (size_t i = 0; i < contents.size(); ++i)
+        {
+            Voice &voice = system.getStaves()[i].getVoices()[0];
+            const BarContent &content = contents[i];
+
+            for (size_t j = 0; j < content.myPositions.size(); ++j)
+            {
+                Position pos = content.myPositions[j];
+                pos.setPosition(start_pos + static_cast<int>(j));
+                voice.insertPosition(pos);
+            }
+
+            // Group the positions in each triplet beat.
+            for (size_t j = 0; j < content.myPositions.size();)
+            {
+                size_t k = j + 1;
+                while (k < content.myPositions.size() &&
+                       content.myTripletBeats[k] == content.myTripletBeats[j])
+                {
+                    ++k;
+                }
+
+                if (content.myTripletBeats[j] >= 0)
+                {
+                    voice.insertIrregularGrouping(IrregularGrouping(
+                        start_pos + static_cast<int>(j),
+                        static_cast<int>(k - j), 3, 2));
+                }
+
+                j = k;
+            }
+        }
+
+        // The previous bar's end bar becomes the start of this bar.
+        const int end_pos = start_pos + width;
+        if (system_bar_idx > 0)
+        {
+            Barline start_bar = system.getBarlines().back();
+            system.getBarlines().back().setPosition(end_pos);
+            system.insertBarline(start_bar);
+        }
+        else
+            system.getBarlines().back().setPosition(end_pos);
+
+        Barline &start_bar = system.getBarlines()[system_bar_idx];
+        Barline &end_bar = system.getBarlines().back();
+        if (bar_idx + 1 == bars.size())
+            end_bar.setBarType(Barline::DoubleBarFine);
+
+        setTimeSignature(start_bar, end_bar, bar,
+                         bar_idx > 0 ? &bars[bar_idx - 1] : nullptr);
+
+        const KeySignature prev_key_sig = key_sig;
+        if (bar.myKeySignature)
+            key_sig = convertKeySignature(*bar.myKeySignature);
+        setKeySignature(start_bar, end_bar, key_sig, prev_key_sig);
+
+        if (bar.myTempo && (*bar.myTempo != tempo || bar_idx == 0))
+        {
+            tempo = std::clamp(*bar.myTempo, TempoMarker::MIN_BEATS_PER_MINUTE,
+                               TempoMarker::MAX_BEATS_PER_MINUTE);
+
+            TempoMarker marker(start_bar.getPosition());
+            marker.setBeatsPerMinute(tempo);
+            system.insertTempoMarker(marker);
+        }
+
+        ++system_bar_idx;
+        start_pos = end_pos + 1;
+    }
+
+    score.insertSystem(system);
+
+    ScoreUtils::polishScore(score);
+    ScoreUtils::addStandardFilters(score);
+}
+
+ScoreMetadata Smf::convertMetadata(const Document &doc)
+{
+    ScoreMetadata metadata;
+
+    for (const Part &part : doc.myParts)
+    {
+        if (isImported(part))
+        {
+            metadata.myInstruments.push_back(
+                { getName(part, Midi::getPresetNames()),
+                  getTuning(part).getStringCount() });
+        }
+    }
+
+    const std::vector<Bar> bars =
+        computeBars(doc, TimeConverter(doc.myTicksPerQuarter));
+    metadata.myBarCount = static_cast<int>(bars.size());
+
+    DurationEstimator duration;
+    for (const Bar &bar : bars)
+    {
+        if (bar.myTempo)
+            duration.setTempo(*bar.myTempo);
+
+        duration.addBar(bar.myBeats, bar.myBeatValue);
+    }
+    metadata.myDuration = duration.getDuration();
+
+    return metadata;
+}
@@ -0,0 +1,38 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FORMATS_MIDI_SMFCONVERTER_H
+#define FORMATS_MIDI_SMFCONVERTER_H
+
+class Score;
+struct ScoreMetadata;
+
+namespace Smf
+{
+struct Document;
+
+/// Converts the MIDI file to a score. The notes are quantized to sixteenth
+/// notes or eighth note triplets, and are assigned to strings and frets
+/// using the tuning for each instrument. Percussion is not imported.
+/// @throw FileFormatException if there are no notes to import.
+void convert(const Document &doc, Score &score);
+
+/// Collects the summary information for the file.
+ScoreMetadata convertMetadata(const Document &doc);
+} // namespace Smf
+
+#endif
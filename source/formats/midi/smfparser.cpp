@@ -0,0 +1,360 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "smfparser.h"
+
+#include <algorithm>
+#include <array>
+#include <formats/fileformat.h>
+
+namespace
+{
+const int NUM_CHANNELS = 16;
+const int NUM_PITCHES = 128;
+
+enum StatusByte : uint8_t
+{
+    NoteOff = 0x80,
+    NoteOn = 0x90,
+    ProgramChange = 0xc0,
+    ChannelPressure = 0xd0,
+    SystemExclusive = 0xf0,
+    SystemExclusiveEscape = 0xf7,
+    MetaMessage = 0xff
+};
+
+enum MetaType : uint8_t
+{
+    TrackName = 0x03,
+    TrackEnd = 0x2f,
+    SetTempo = 0x51,
+    TimeSignature = 0x58,
+    KeySignature = 0x59
+};
+
+struct Chunk
+{
+    std::string_view myId;
+    const uint8_t *myData = nullptr;
+    size_t myLength = 0;
+};
+
+/// Steps through the chunks of the file without copying their contents.
+class ChunkReader
+{
+public:
+    ChunkReader(const uint8_t *data, size_t length)
+        : myData(data), myEnd(data + length)
+    {
+    }
+
+    /// Reads the next chunk.
+    /// @return False if there are no more chunks.
+    bool next(Chunk &chunk)
+    {
+        static constexpr size_t CHUNK_HEADER_SIZE = 8;
+        if (static_cast<size_t>(myEnd - myData) < CHUNK_HEADER_SIZE)
+            return false;
+
+        chunk.myId =
+            std::string_view(reinterpret_cast<const char *>(myData), 4);
+        const size_t length = (size_t(myData[4]) << 24) |
+                              (size_t(myData[5]) << 16) |
+                              (size_t(myData[6]) << 8) | size_t(myData[7]);
+        myData += CHUNK_HEADER_SIZE;
+
+        // Some files have incorrect lengths for the last chunk, so read
+        // whatever is available rather than rejecting the file.
+        chunk.myData = myData;
+        chunk.myLength =
+            std::min(length, static_cast<size_t>(myEnd - myData));
+        myData += chunk.myLength;
+
+        return true;
+    }
+
+private:
+    const uint8_t *myData;
+    const uint8_t *myEnd;
+};
+
+/// Reads the events from a track chunk.
+class TrackReader
+{
+public:
+    TrackReader(const Chunk &chunk)
+        : myData(chunk.myData), myEnd(chunk.myData + chunk.myLength)
+    {
+    }
+
+    bool atEnd() const { return myData == myEnd; }
+
+    size_t remaining() const { return static_cast<size_t>(myEnd - myData); }
+
+    uint8_t peek() const
+    {
+        checkAvailable(1);
+        return *myData;
+    }
+
+    uint8_t read()
+    {
+        checkAvailable(1);
+        return *myData++;
+    }
+
+    uint32_t readVariableLength()
+    {
+        // Variable length quantities are at most four bytes.
+        uint32_t val = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const uint8_t byte = read();
+            val = (val << 7) | (byte & 0x7f);
+
+            if (!(byte & 0x80))
+                return val;
+        }
+
+        throw FileFormatException("Invalid variable length quantity.");
+    }
+
+    const uint8_t *skip(size_t length)
+    {
+        checkAvailable(length);
+        const uint8_t *data = myData;
+        myData += length;
+        return data;
+    }
+
+private:
+    void checkAvailable(size_t length) const
+    {
+        if (length > remaining())
+            throw FileFormatException("Unexpected end of track.");
+    }
+
+    const uint8_t *myData;
+    const uint8_t *myEnd;
+};
+
+/// Collects the notes that are played on one channel of a track.
+struct ChannelState
+{
+    int myProgram = 0;
+    std::vector<Smf::Note> myNotes;
+    /// For each pitch, the index of the note that is currently sounding.
+    std::array<int, NUM_PITCHES> myActiveNotes;
+
+    ChannelState() { myActiveNotes.fill(-1); }
+
+    void startNote(int64_t ticks, uint8_t pitch, uint8_t velocity)
+    {
+        // If the note is struck again while still sounding, end the earlier
+        // note.
+        endNote(ticks, pitch);
+
+        myActiveNotes[pitch] = static_cast<int>(myNotes.size());
+        myNotes.push_back({ ticks, ticks, pitch, velocity });
+    }
+
+    void endNote(int64_t ticks, uint8_t pitch)
+    {
+        int &idx = myActiveNotes[pitch];
+        if (idx >= 0)
+        {
+            myNotes[idx].myEnd = ticks;
+            idx = -1;
+        }
+    }
+};
+
+void readMetaEvent(TrackReader &reader, int64_t ticks, Smf::Document &doc,
+                   std::string &track_name, bool &track_end)
+{
+    const uint8_t type = reader.read();
+    const uint32_t length = reader.readVariableLength();
+    const uint8_t *data = reader.skip(length);
+
+    switch (type)
+    {
+        case MetaType::TrackName:
+            if (track_name.empty())
+                track_name.assign(reinterpret_cast<const char *>(data), length);
+            break;
+
+        case MetaType::TrackEnd:
+            track_end = true;
+            break;
+
+        case MetaType::SetTempo:
+            if (length >= 3)
+            {
+                const int tempo = (data[0] << 16) | (data[1] << 8) | data[2];
+                if (tempo > 0)
+                    doc.myTempoChanges.push_back({ ticks, tempo });
+            }
+            break;
+
+        case MetaType::TimeSignature:
+            // The denominator is stored as a power of two.
+            if (length >= 2 && data[1] < 8)
+                doc.myTimeSignatures.push_back({ ticks, data[0], 1 << data[1] });
+            break;
+
+        case MetaType::KeySignature:
+            if (length >= 2)
+            {
+                doc.myKeySignatures.push_back(
+                    { ticks, static_cast<int8_t>(data[0]), data[1] != 0 });
+            }
+            break;
+    }
+}
+
+void readTrack(const Chunk &chunk, Smf::Document &doc)
+{
+    TrackReader reader(chunk);
+    std::array<ChannelState, NUM_CHANNELS> channels;
+    std::string track_name;
+
+    int64_t ticks = 0;
+    uint8_t running_status = 0;
+    bool track_end = false;
+
+    while (!track_end && !reader.atEnd())
+    {
+        ticks += reader.readVariableLength();
+
+        uint8_t status = reader.peek();
+        if (status & 0x80)
+            reader.read();
+        else if (running_status)
+        {
+            // The status byte can be omitted if it is the same as the
+            // previous channel message.
+            status = running_status;
+        }
+        else
+            throw FileFormatException("Invalid MIDI event.");
+
+        if (status == StatusByte::MetaMessage)
+        {
+            running_status = 0;
+            readMetaEvent(reader, ticks, doc, track_name, track_end);
+        }
+        else if (status == StatusByte::SystemExclusive ||
+                 status == StatusByte::SystemExclusiveEscape)
+        {
+            running_status = 0;
+            reader.skip(reader.readVariableLength());
+        }
+        else if (status < StatusByte::SystemExclusive)
+        {
+            running_status = status;
+
+            ChannelState &channel = channels[status & 0x0f];
+            const uint8_t type = status & 0xf0;
+            const uint8_t data1 = reader.read() & 0x7f;
+
+            if (type == StatusByte::ProgramChange)
+            {
+                if (channel.myNotes.empty())
+                    channel.myProgram = data1;
+                continue;
+            }
+            else if (type == StatusByte::ChannelPressure)
+                continue;
+
+            const uint8_t data2 = reader.read() & 0x7f;
+            if (type == StatusByte::NoteOn && data2 != 0)
+                channel.startNote(ticks, data1, data2);
+            else if (type == StatusByte::NoteOn || type == StatusByte::NoteOff)
+                channel.endNote(ticks, data1);
+        }
+        else
+            throw FileFormatException("Invalid MIDI event.");
+    }
+
+    doc.myEndTicks = std::max(doc.myEndTicks, ticks);
+
+    for (int i = 0; i < NUM_CHANNELS; ++i)
+    {
+        ChannelState &channel = channels[i];
+        if (channel.myNotes.empty())
+            continue;
+
+        // End any notes that are still sounding.
+        for (uint8_t pitch = 0; pitch < NUM_PITCHES; ++pitch)
+            channel.endNote(ticks, pitch);
+
+        Smf::Part part;
+        part.myName = track_name;
+        part.myChannel = i;
+        part.myProgram = channel.myProgram;
+        part.myNotes = std::move(channel.myNotes);
+        doc.myParts.push_back(std::move(part));
+    }
+}
+
+template <typename T>
+void sortByTime(std::vector<T> &changes)
+{
+    std::stable_sort(changes.begin(), changes.end(),
+                     [](const T &a, const T &b) { return a.myTicks < b.myTicks; });
+}
+} // namespace
+
+bool Smf::hasHeader(std::string_view data)
+{
+    return data.substr(0, 4) == "MThd";
+}
+
+Smf::Document Smf::parse(const std::byte *data, size_t length)
+{
+    ChunkReader chunks(reinterpret_cast<const uint8_t *>(data), length);
+
+    Chunk header;
+    if (!chunks.next(header) || header.myId != "MThd" || header.myLength < 6)
+        throw FileFormatException("Invalid MIDI file header.");
+
+    Document doc;
+    doc.myFormat = (header.myData[0] << 8) | header.myData[1];
+    if (doc.myFormat > 1)
+        throw FileFormatException("Unsupported MIDI file format.");
+
+    // Only a division in ticks per quarter note is supported, rather than
+    // SMPTE frames.
+    const int division = (header.myData[4] << 8) | header.myData[5];
+    if (division == 0 || (division & 0x8000))
+        throw FileFormatException("Unsupported MIDI time division.");
+    doc.myTicksPerQuarter = division;
+
+    // Any unknown chunk types are skipped.
+    Chunk chunk;
+    while (chunks.next(chunk))
+    {
+        if (chunk.myId == "MTrk")
+            readTrack(chunk, doc);
+    }
+
+    sortByTime(doc.myTempoChanges);
+    sortByTime(doc.myTimeSignatures);
+    sortByTime(doc.myKeySignatures);
+
+    return doc;
+}
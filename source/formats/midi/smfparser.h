@@ -0,0 +1,93 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FORMATS_MIDI_SMFPARSER_H
+#define FORMATS_MIDI_SMFPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Reads Standard MIDI Files (format 0 or 1) into a list of notes for each
+/// instrument, along with the tempo, time signature, and key signature
+/// changes. All times are in ticks from the start of the song.
+namespace Smf
+{
+struct Note
+{
+    int64_t myStart = 0;
+    int64_t myEnd = 0;
+    uint8_t myPitch = 0;
+    uint8_t myVelocity = 0;
+};
+
+/// The notes for a single channel of a track. A format 0 file stores all of
+/// the channels in one track, so it is split into a part per channel.
+struct Part
+{
+    std::string myName;
+    int myChannel = 0;
+    int myProgram = 0;
+    /// Ordered by start time.
+    std::vector<Note> myNotes;
+};
+
+struct TempoChange
+{
+    int64_t myTicks = 0;
+    int myMicrosecondsPerQuarter = 500000;
+};
+
+struct TimeSignatureChange
+{
+    int64_t myTicks = 0;
+    int myBeats = 4;
+    int myBeatValue = 4;
+};
+
+struct KeySignatureChange
+{
+    int64_t myTicks = 0;
+    /// Positive for sharps, negative for flats.
+    int myAccidentals = 0;
+    bool myMinor = false;
+};
+
+struct Document
+{
+    int myFormat = 0;
+    int myTicksPerQuarter = 0;
+    std::vector<Part> myParts;
+    /// The changes from all of the tracks, ordered by time.
+    std::vector<TempoChange> myTempoChanges;
+    std::vector<TimeSignatureChange> myTimeSignatures;
+    std::vector<KeySignatureChange> myKeySignatures;
+    /// The time of the last event in any track.
+    int64_t myEndTicks = 0;
+};
+
+/// Returns whether the data begins with a MIDI file header chunk.
+bool hasHeader(std::string_view data);
+
+/// Parses the contents of a MIDI file.
+/// @throw FileFormatException
+Document parse(const std::byte *data, size_t length);
+} // namespace Smf
+
+#endif
@@ -19,11 +19,21 @@
 
 #include "common.h"
 
+#include <algorithm>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/device/array.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
+#include <formats/scoremetadata.h>
+#include <optional>
+#include <rapidjson/error/en.h>
+#include <rapidjson/istreamwrapper.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include <score/score.h>
 #include <score/serialization.h>
+#include <sstream>
 
 PowerTabImporter::PowerTabImporter()
     : FileFormatImporter(getPowerTabFileFormat())
@@ -43,3 +53,325 @@ void PowerTabImporter::load(const boost::filesystem::path &filename,
     std::istream compressed_input(&in);
     ScoreUtils::load(compressed_input, "score", score);
 }
+
+namespace
+{
+/// Streams through the JSON document and copies out only the small sections
+/// that are needed for the metadata, rather than building the entire
+/// document in memory. The staves, which make up the bulk of the file, are
+/// skipped over.
+class MetadataReader
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, MetadataReader>
+{
+public:
+    MetadataReader(ScoreMetadata &metadata) : myMetadata(metadata)
+    {
+    }
+
+    /// Returns whether all of the metadata has been read.
+    bool isDone() const
+    {
+        return myIsDone;
+    }
+
+    bool Null()
+    {
+        return scalar([](Writer &w) { return w.Null(); });
+    }
+
+    bool Bool(bool b)
+    {
+        return scalar([=](Writer &w) { return w.Bool(b); });
+    }
+
+    bool Int(int i)
+    {
+        readVersion(i);
+        return scalar([=](Writer &w) { return w.Int(i); });
+    }
+
+    bool Uint(unsigned int i)
+    {
+        readVersion(static_cast<int>(i));
+        return scalar([=](Writer &w) { return w.Uint(i); });
+    }
+
+    bool Int64(int64_t i)
+    {
+        return scalar([=](Writer &w) { return w.Int64(i); });
+    }
+
+    bool Uint64(uint64_t i)
+    {
+        return scalar([=](Writer &w) { return w.Uint64(i); });
+    }
+
+    bool Double(double d)
+    {
+        return scalar([=](Writer &w) { return w.Double(d); });
+    }
+
+    bool String(const char *str, rapidjson::SizeType length, bool copy)
+    {
+        return scalar(
+            [=](Writer &w) { return w.String(str, length, copy); });
+    }
+
+    bool Key(const char *str, rapidjson::SizeType length, bool copy)
+    {
+        myScope.back().assign(str, length);
+        return !myWriter || myWriter->Key(str, length, copy);
+    }
+
+    bool StartObject()
+    {
+        return startContainer([](Writer &w) { return w.StartObject(); });
+    }
+
+    bool EndObject(rapidjson::SizeType count)
+    {
+        return endContainer([=](Writer &w) { return w.EndObject(count); });
+    }
+
+    bool StartArray()
+    {
+        return startContainer([](Writer &w) { return w.StartArray(); });
+    }
+
+    bool EndArray(rapidjson::SizeType count)
+    {
+        return endContainer([=](Writer &w) { return w.EndArray(count); });
+    }
+
+private:
+    using Writer = rapidjson::Writer<rapidjson::StringBuffer>;
+
+    /// The sections of the document that are copied out.
+    enum class Section
+    {
+        None,
+        ScoreInfo,
+        Players,
+        Barlines,
+        TempoMarkers
+    };
+
+    bool inScope(std::initializer_list<const char *> keys) const
+    {
+        return std::equal(myScope.begin(), myScope.end(), keys.begin(),
+                          keys.end());
+    }
+
+    Section findSection() const
+    {
+        if (inScope({ "score", "score_info" }))
+            return Section::ScoreInfo;
+        else if (inScope({ "score", "players" }))
+            return Section::Players;
+        else if (inScope({ "score", "systems", "", "barlines" }))
+            return Section::Barlines;
+        else if (inScope({ "score", "systems", "", "tempo_markers" }))
+            return Section::TempoMarkers;
+        else
+            return Section::None;
+    }
+
+    void readVersion(int version)
+    {
+        if (!myWriter && inScope({ "version" }))
+            myVersion = version;
+    }
+
+    template <typename F>
+    bool scalar(F write)
+    {
+        return !myWriter || write(*myWriter);
+    }
+
+    template <typename F>
+    bool startContainer(F write)
+    {
+        if (!myWriter)
+        {
+            mySection = findSection();
+            if (mySection != Section::None)
+            {
+                myBuffer.Clear();
+                myWriter.emplace(myBuffer);
+                mySectionDepth = myScope.size();
+            }
+        }
+
+        // Array elements are given an empty key.
+        myScope.emplace_back();
+        return !myWriter || write(*myWriter);
+    }
+
+    template <typename F>
+    bool endContainer(F write)
+    {
+        if (myWriter && !write(*myWriter))
+            return false;
+
+        myScope.pop_back();
+
+        if (myWriter && myScope.size() == mySectionDepth)
+        {
+            myWriter.reset();
+            return readSection();
+        }
+        else if (!myWriter && inScope({ "score", "systems", "" }))
+            finishSystem();
+
+        return true;
+    }
+
+    /// Deserializes the section that was just copied out.
+    template <typename T>
+    void load(T &obj) const
+    {
+        std::stringstream input;
+        input << "{\"version\":" << myVersion << ",\"value\":";
+        input.write(myBuffer.GetString(),
+                    static_cast<std::streamsize>(myBuffer.GetSize()));
+        input << "}";
+
+        ScoreUtils::load(input, "value", obj);
+    }
+
+    /// @return False if the rest of the document can be skipped.
+    bool readSection()
+    {
+        switch (mySection)
+        {
+            case Section::ScoreInfo:
+                load(myMetadata.myScoreInfo);
+                break;
+            case Section::Players:
+            {
+                std::vector<Player> players;
+                load(players);
+
+                for (const Player &player : players)
+                {
+                    myMetadata.myInstruments.push_back(
+                        { player.getDescription(),
+                          player.getTuning().getStringCount() });
+                }
+
+                // The players are stored after the systems, so there is
+                // nothing else to read.
+                myMetadata.myDuration = myDuration.getDuration();
+                myIsDone = true;
+                return false;
+            }
+            case Section::Barlines:
+                load(myBarlines);
+                break;
+            case Section::TempoMarkers:
+                load(myTempoMarkers);
+                break;
+            case Section::None:
+                break;
+        }
+
+        return true;
+    }
+
+    void finishSystem()
+    {
+        if (!myBarlines.empty())
+        {
+            myMetadata.myBarCount += static_cast<int>(myBarlines.size()) - 1;
+            myDuration.addSystem(myBarlines, myTempoMarkers);
+        }
+
+        myBarlines.clear();
+        myTempoMarkers.clear();
+    }
+
+    ScoreMetadata &myMetadata;
+    int myVersion = 0;
+    bool myIsDone = false;
+    /// The key for each object or array that is currently open.
+    std::vector<std::string> myScope;
+
+    rapidjson::StringBuffer myBuffer;
+    std::optional<Writer> myWriter;
+    Section mySection = Section::None;
+    size_t mySectionDepth = 0;
+
+    std::vector<Barline> myBarlines;
+    std::vector<TempoMarker> myTempoMarkers;
+    DurationEstimator myDuration;
+};
+} // namespace
+
+ScoreMetadata PowerTabImporter::probe(const boost::filesystem::path &filename)
+{
+    boost::filesystem::ifstream file(filename, std::ios::in | std::ios::binary);
+    boost::iostreams::filtering_istreambuf in;
+    in.push(boost::iostreams::gzip_decompressor());
+    in.push(file);
+
+    std::istream compressed_input(&in);
+    rapidjson::IStreamWrapper stream(compressed_input);
+
+    ScoreMetadata metadata;
+    MetadataReader handler(metadata);
+    rapidjson::Reader reader;
+    rapidjson::ParseResult result = reader.Parse(stream, handler);
+
+    if (!handler.isDone())
+    {
+        if (result.IsError())
+        {
+            throw FileFormatException(
+                "Parse error at offset " + std::to_string(result.Offset()) +
+                ": " + rapidjson::GetParseError_En(result.Code()));
+        }
+
+        throw FileFormatException("The file does not contain any players.");
+    }
+
+    return metadata;
+}
+
+bool PowerTabImporter::canRead(std::string_view header) const
+{
+    // Check for the gzip magic number.
+    if (header.substr(0, 2) != "\x1f\x8b")
+        return false;
+
+    // The uncompressed data is a JSON object, which begins with the file
+    // version. Only a few bytes need to be decompressed to check this.
+    char buffer[64];
+    std::streamsize length = 0;
+    try
+    {
+        boost::iostreams::filtering_istreambuf in;
+        in.push(boost::iostreams::gzip_decompressor());
+        in.push(boost::iostreams::array_source(header.data(), header.size()));
+        length = in.sgetn(buffer, sizeof(buffer));
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+
+    std::string_view json(buffer, static_cast<size_t>(length));
+    auto skip_whitespace = [&]() {
+        json.remove_prefix(std::min(json.size(),
+                                    json.find_first_not_of(" \t\r\n")));
+    };
+
+    skip_whitespace();
+    if (json.empty() || json.front() != '{')
+        return false;
+
+    json.remove_prefix(1);
+    skip_whitespace();
+
+    using namespace std::literals;
+    return json.substr(0, 9) == "\"version\""sv;
+}
@@ -27,6 +27,9 @@ public:
 
     virtual void load(const boost::filesystem::path &filename,
                       Score &score) override;
+    virtual ScoreMetadata probe(
+        const boost::filesystem::path &filename) override;
+    virtual bool canRead(std::string_view header) const override;
 };
 
 #endif
@@ -0,0 +1,117 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:            arena.h
+// Purpose:         Monotonic allocator for the objects in a Power Tab document
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace PowerTabDocument {
+
+/// Allocates memory for the objects read from a document by bumping a pointer
+/// through large blocks. Individual allocations are never freed - the memory
+/// for the entire document is released at once.
+class Arena
+{
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /// Allocates uninitialized memory with the given size and alignment.
+    void* Allocate(size_t size, size_t alignment)
+    {
+        void* ptr = m_current;
+        if (!std::align(alignment, size, ptr, m_remaining))
+        {
+            const size_t blockSize = std::max(BLOCK_SIZE, size + alignment);
+            m_blocks.emplace_back(new std::byte[blockSize]);
+
+            ptr = m_blocks.back().get();
+            m_remaining = blockSize;
+            std::align(alignment, size, ptr, m_remaining);
+        }
+
+        m_current = static_cast<std::byte*>(ptr) + size;
+        m_remaining -= size;
+        return ptr;
+    }
+
+    /// Releases all of the memory. Any objects in the arena must already have
+    /// been destroyed.
+    void Release()
+    {
+        m_blocks.clear();
+        m_current = nullptr;
+        m_remaining = 0;
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+    std::byte* m_current = nullptr;
+    size_t m_remaining = 0;
+};
+
+/// Standard allocator interface for an arena, e.g. for std::allocate_shared.
+template <class T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena) : m_arena(&arena)
+    {
+    }
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.m_arena)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(m_arena->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t)
+    {
+    }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return m_arena == other.m_arena;
+    }
+
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+        return m_arena != other.m_arena;
+    }
+
+private:
+    template <class U>
+    friend class ArenaAllocator;
+
+    Arena* m_arena;
+};
+
+/// Destroys an object that was constructed in an arena. The memory is
+/// reclaimed when the arena is released.
+template <class T>
+void DestroyArenaObject(T* object)
+{
+    if (object)
+        object->~T();
+}
+
+}
+
+#endif // ARENA_H
@@ -57,7 +57,7 @@ Position::~Position()
 {
     for (auto &note : m_noteArray)
     {
-        delete note;
+        DestroyArenaObject(note);
     }
 }
 
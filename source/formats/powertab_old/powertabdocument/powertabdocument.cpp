@@ -14,6 +14,7 @@
 #include "powertaboutputstream.h"
 
 #include <boost/filesystem/fstream.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include "score.h"
 
@@ -216,15 +217,16 @@ bool Document::Save(const PathType& fileName) const
 
 /// Loads a power tab file.
 /// @param fileName Full path of the file to load.
-/// @throw std::ifstream::failure
+/// @throw std::ios_base::failure
 void Document::Load(const boost::filesystem::path& fileName)
 {
-    boost::filesystem::ifstream fileStream(fileName, std::ifstream::in |
-                                                         std::ifstream::binary);
-    PowerTabInputStream stream(fileStream);
-
     DeleteContents();
 
+    // Read directly from the file's contents in memory.
+    boost::iostreams::mapped_file_source file(fileName);
+    PowerTabInputStream stream(reinterpret_cast<const std::byte*>(file.data()),
+                               file.size(), m_arena);
+
     // read the header
     if (!m_header.Deserialize(stream))
     {
@@ -288,6 +290,9 @@ void Document::DeleteScoreArrayContents()
     for (i = 0; i < count; i++)
         delete m_scoreArray[i];
     m_scoreArray.clear();
+
+    // All of the objects that were loaded from a file have been destroyed.
+    m_arena.Release();
 }
 
 }
@@ -12,6 +12,7 @@
 #ifndef POWER_TAB_DOCUMENT_H
 #define POWER_TAB_DOCUMENT_H
 
+#include "arena.h"
 #include "powertabfileheader.h"
 #include "fontsetting.h"
 
@@ -52,6 +53,7 @@ public:
 
     // Member Variables
 private:
+    Arena               m_arena;                                    ///< Owns the objects (systems, positions, etc) that are loaded from a file
     PowerTabFileHeader  m_header;                                   ///< The one and only header (contains file information)
     std::vector<Score*> m_scoreArray;                               ///< List of scores (zeroth element = guitar score, first element = bass score)
 
@@ -18,11 +18,15 @@ namespace PowerTabDocument {
 
 using std::string;
 
-PowerTabInputStream::PowerTabInputStream(std::istream& stream) :
-    m_stream(stream)
+PowerTabInputStream::PowerTabInputStream(const std::byte* data, size_t size,
+                                         Arena& arena) :
+    m_position(data), m_end(data + size), m_arena(arena)
 {
-    // ensure that the stream will throw std::ifstream::failure if any errors occur
-    stream.exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
+}
+
+void PowerTabInputStream::ThrowEndOfFile()
+{
+    throw std::ios_base::failure("Unexpected end of file");
 }
 
 // Read Functions
@@ -51,15 +55,12 @@ uint32_t PowerTabInputStream::ReadCount()
 /// @return True if the string was read, false if not
 void PowerTabInputStream::ReadMFCString(string& str)
 {
-    str.clear();
-
     const uint32_t length = ReadMFCStringLength();
-    str.resize(length);
+    if (length > static_cast<size_t>(m_end - m_position))
+        ThrowEndOfFile();
 
-	if (length != 0)
-	{
-		m_stream.read(&str[0], length);
-	}
+    str.assign(reinterpret_cast<const char*>(m_position), length);
+    m_position += length;
 }
 
 /// Reads a Win32 format COLORREF type from the stream
@@ -129,7 +130,9 @@ void PowerTabInputStream::ReadClassInformation()
 
         *this >> schema;
         *this >> length;
-        m_stream.seekg(length, std::ios_base::cur);
+        if (length > static_cast<size_t>(m_end - m_position))
+            ThrowEndOfFile();
+        m_position += length;
     }
 
     // otherwise, existing class index in obj_tag followed by new object
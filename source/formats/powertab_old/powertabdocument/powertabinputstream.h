@@ -12,10 +12,16 @@
 #ifndef POWERTABINPUTSTREAM_H
 #define POWERTABINPUTSTREAM_H
 
+#include "arena.h"
+
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
-#include <istream>
+#include <cstring>
+#include <ios>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace PowerTabDocument {
@@ -28,10 +34,14 @@ class PowerTabInputStream
 {
     // Member Variables
 private:
-    std::istream& m_stream;
+    const std::byte* m_position;    ///< Current read position in the data
+    const std::byte* m_end;         ///< End of the data
+    Arena& m_arena;                 ///< Owns the objects that are read
 
 public:
-    PowerTabInputStream(std::istream& stream);
+    /// Reads from the contents of a file, which must remain valid while the
+    /// stream is in use. Objects are allocated from the provided arena.
+    PowerTabInputStream(const std::byte* data, size_t size, Arena& arena);
 
     // Read Functions
     uint32_t ReadCount();
@@ -43,6 +53,19 @@ private:
     void ReadClassInformation();
     uint32_t ReadMFCStringLength();
 
+    /// Copies the next bytes from the stream
+    /// @throw std::ios_base::failure if there isn't enough data remaining
+    inline void Read(void* data, size_t size)
+    {
+        if (size > static_cast<size_t>(m_end - m_position))
+            ThrowEndOfFile();
+
+        std::memcpy(data, m_position, size);
+        m_position += size;
+    }
+
+    [[noreturn]] static void ThrowEndOfFile();
+
 public:
 
     template <class T>
@@ -50,8 +73,10 @@ public:
     {
         const uint32_t count = ReadCount();
 
+        // Each object takes at least one byte, so don't trust a count that
+        // is larger than the remaining data.
         vect.clear();
-        vect.reserve(count);
+        vect.reserve(std::min<size_t>(count, m_end - m_position));
 
         for (uint32_t i = 0; i < count; i++)
         {
@@ -61,11 +86,11 @@ public:
     }
 
     /// Read data from the input stream
-    /// @throw std::ifstream::failure if any errors occur
+    /// @throw std::ios_base::failure if any errors occur
     template<class T>
     inline PowerTabInputStream& operator>>(T& data)
     {
-        m_stream.read(reinterpret_cast<char *>(&data), sizeof(data));
+        Read(&data, sizeof(data));
         return *this;
     }
 
@@ -78,7 +103,7 @@ public:
         vect.clear();
         vect.resize(size);
 
-        m_stream.read((char*)&vect[0], size * sizeof(T));
+        Read(vect.data(), size * sizeof(T));
     }
 
     template <class T, size_t N>
@@ -87,25 +112,33 @@ public:
         uint8_t size = 0;
         *this >> size;
 
-        m_stream.read((char*)&array[0], size * sizeof(T));
+        if (size > N)
+            throw std::ios_base::failure("Invalid array size");
+
+        Read(array.data(), size * sizeof(T));
     }
 
 private:
+    /// The owner of the array must destroy the objects with
+    /// DestroyArenaObject().
     template <class T>
     inline void ReadObject(std::vector<T*>& vect, uint16_t version)
     {
-        std::unique_ptr<T> object(new T());
+        // Add the object before reading it, so that it is still destroyed by
+        // its owner if an error occurs.
+        T* object = new (m_arena.Allocate(sizeof(T), alignof(T))) T();
+        vect.push_back(object);
         object->Deserialize(*this, version);
-        vect.push_back(object.release());
     }
 
     template <class T>
     inline void ReadObject(std::vector<std::shared_ptr<T> >& vect,
                            uint16_t version)
     {
-        std::shared_ptr<T> object(std::make_shared<T>());
+        std::shared_ptr<T> object(
+            std::allocate_shared<T>(ArenaAllocator<T>(m_arena)));
         object->Deserialize(*this, version);
-        vect.push_back(object);
+        vect.push_back(std::move(object));
     }
 };
 
@@ -73,7 +73,7 @@ Staff::~Staff()
         std::vector<Position*>& positionArray = positionArrays[i];
         for (size_t j = 0; j < positionArray.size(); j++)
         {
-            delete positionArray[j];
+            DestroyArenaObject(positionArray[j]);
         }
     }
 }
@@ -32,12 +32,15 @@
 #include <formats/powertab_old/powertabdocument/staff.h>
 #include <formats/powertab_old/powertabdocument/system.h>
 #include <formats/powertab_old/powertabdocument/tempomarker.h>
+#include <formats/scoremetadata.h>
 #include <score/generalmidi.h>
 #include <score/score.h>
 #include <score/systemlocation.h>
 #include <score/utils/scoremerger.h>
 #include <score/utils/scorepolisher.h>
+#include <util/parallel.h>
 
+#include <algorithm>
 #include <cmath>
 
 PowerTabOldImporter::PowerTabOldImporter()
@@ -74,6 +77,110 @@ void PowerTabOldImporter::load(const boost::filesystem::path &filename,
     ScoreUtils::polishScore(score);
 }
 
+bool PowerTabOldImporter::canRead(std::string_view header) const
+{
+    // The file begins with a marker and file version, which are stored in
+    // little-endian order.
+    if (header.size() < 6)
+        return false;
+
+    auto byte = [&](size_t i) {
+        return static_cast<uint32_t>(static_cast<uint8_t>(header[i]));
+    };
+    const uint32_t marker =
+        byte(0) | (byte(1) << 8) | (byte(2) << 16) | (byte(3) << 24);
+    const auto version = static_cast<uint16_t>(byte(4) | (byte(5) << 8));
+
+    using PowerTabDocument::PowerTabFileHeader;
+    return PowerTabFileHeader::IsValidPowerTabFileMarker(marker) &&
+           PowerTabFileHeader::IsValidFileVersion(version);
+}
+
+ScoreMetadata PowerTabOldImporter::probe(
+    const boost::filesystem::path &filename)
+{
+    // The guitars for the bass score are stored after the guitar score's
+    // systems, so the whole file needs to be read. However, this is cheap
+    // compared to converting and merging the scores.
+    PowerTabDocument::Document document;
+    document.Load(filename);
+
+    ScoreMetadata metadata;
+    convert(document.GetHeader(), metadata.myScoreInfo);
+
+    // The guitar and bass scores are merged, so use whichever is longer for
+    // the bar count and duration.
+    const PowerTabDocument::Score *longest_score = nullptr;
+    int longest_bar_count = -1;
+
+    for (size_t score_idx = 0; score_idx < document.GetNumberOfScores();
+         ++score_idx)
+    {
+        const PowerTabDocument::Score &old_score =
+            *document.GetScore(score_idx);
+
+        for (size_t i = 0; i < old_score.GetGuitarCount(); ++i)
+        {
+            auto guitar = old_score.GetGuitar(i);
+            metadata.myInstruments.push_back(
+                { guitar->GetDescription(),
+                  static_cast<int>(guitar->GetTuning().GetStringCount()) });
+        }
+
+        int bar_count = 0;
+        for (size_t i = 0; i < old_score.GetSystemCount(); ++i)
+        {
+            bar_count +=
+                static_cast<int>(old_score.GetSystem(i)->GetBarlineCount()) + 1;
+        }
+
+        if (bar_count > longest_bar_count)
+        {
+            longest_score = &old_score;
+            longest_bar_count = bar_count;
+        }
+    }
+
+    if (longest_score)
+    {
+        metadata.myBarCount = longest_bar_count;
+
+        DurationEstimator duration;
+        for (size_t i = 0; i < longest_score->GetSystemCount(); ++i)
+        {
+            auto old_system = longest_score->GetSystem(i);
+
+            std::vector<Barline> barlines(1);
+            convert(*old_system->GetStartBar(), barlines.back());
+            for (size_t j = 0; j < old_system->GetBarlineCount(); ++j)
+            {
+                barlines.emplace_back();
+                convert(*old_system->GetBarline(j), barlines.back());
+            }
+            barlines.emplace_back();
+            convert(*old_system->GetEndBar(), barlines.back());
+
+            std::vector<std::shared_ptr<PowerTabDocument::TempoMarker>> tempos;
+            longest_score->GetTempoMarkersInSystem(tempos, old_system);
+            std::vector<TempoMarker> markers;
+            for (auto &tempo : tempos)
+            {
+                markers.emplace_back();
+                convert(*tempo, markers.back());
+            }
+            std::stable_sort(markers.begin(), markers.end(),
+                             [](const TempoMarker &a, const TempoMarker &b) {
+                                 return a.getPosition() < b.getPosition();
+                             });
+
+            duration.addSystem(barlines, markers);
+        }
+        metadata.myDuration = duration.getDuration();
+    }
+
+    return metadata;
+}
+
 void PowerTabOldImporter::convert(
         const PowerTabDocument::PowerTabFileHeader &header, ScoreInfo &info)
 {
@@ -154,12 +261,15 @@ void PowerTabOldImporter::convert(const PowerTabDocument::Score &oldScore,
     for (size_t i = 0; i < oldScore.GetGuitarCount(); ++i)
         convert(*oldScore.GetGuitar(i), score);
 
-    for (size_t i = 0; i < oldScore.GetSystemCount(); ++i)
-    {
-        System system;
-        convert(oldScore, oldScore.GetSystem(i), system);
+    // The systems are converted independently, so they can be done in
+    // parallel and then inserted in order.
+    std::vector<System> systems(oldScore.GetSystemCount());
+    Util::parallelFor(systems.size(), [&](size_t i) {
+        convert(oldScore, oldScore.GetSystem(i), systems[i]);
+    });
+
+    for (const System &system : systems)
         score.insertSystem(system);
-    }
 
     // Convert Guitar In's to player changes.
     convertGuitarIns(oldScore, score);
@@ -63,6 +63,9 @@ public:
     PowerTabOldImporter();
     virtual void load(const boost::filesystem::path &filename,
                       Score &score) override;
+    virtual ScoreMetadata probe(
+        const boost::filesystem::path &filename) override;
+    virtual bool canRead(std::string_view header) const override;
 
 private:
     static void convert(const PowerTabDocument::PowerTabFileHeader &header,
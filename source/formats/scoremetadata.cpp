@@ -0,0 +1,128 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scoremetadata.h"
+
+#include <score/score.h>
+
+ScoreMetadata
+ScoreMetadata::fromScore(const Score &score)
+{
+    ScoreMetadata metadata;
+    metadata.myScoreInfo = score.getScoreInfo();
+
+    for (const Player &player : score.getPlayers())
+    {
+        metadata.myInstruments.push_back(
+            { player.getDescription(), player.getTuning().getStringCount() });
+    }
+
+    DurationEstimator duration;
+    for (const System &system : score.getSystems())
+    {
+        metadata.myBarCount +=
+            static_cast<int>(system.getBarlines().size()) - 1;
+
+        duration.addSystem(
+            std::vector<Barline>(system.getBarlines().begin(),
+                                 system.getBarlines().end()),
+            std::vector<TempoMarker>(system.getTempoMarkers().begin(),
+                                     system.getTempoMarkers().end()));
+    }
+    metadata.myDuration = duration.getDuration();
+
+    return metadata;
+}
+
+/// Returns the length of the beat type, in quarter notes.
+static double
+getBeatLength(TempoMarker::BeatType beat_type)
+{
+    switch (beat_type)
+    {
+    case TempoMarker::Half:
+        return 2;
+    case TempoMarker::HalfDotted:
+        return 3;
+    case TempoMarker::Quarter:
+        return 1;
+    case TempoMarker::QuarterDotted:
+        return 1.5;
+    case TempoMarker::Eighth:
+        return 0.5;
+    case TempoMarker::EighthDotted:
+        return 0.75;
+    case TempoMarker::Sixteenth:
+        return 0.25;
+    case TempoMarker::SixteenthDotted:
+        return 0.375;
+    case TempoMarker::ThirtySecond:
+        return 0.125;
+    case TempoMarker::ThirtySecondDotted:
+        return 0.1875;
+    }
+
+    return 1;
+}
+
+void
+DurationEstimator::setTempo(int beats_per_minute,
+                            TempoMarker::BeatType beat_type)
+{
+    if (beats_per_minute > 0)
+        myQuarterNotesPerMinute = beats_per_minute * getBeatLength(beat_type);
+}
+
+void
+DurationEstimator::addBar(int num_beats, int beat_value)
+{
+    if (beat_value <= 0)
+        return;
+
+    const double quarter_notes = num_beats * 4.0 / beat_value;
+    myMinutes += quarter_notes / myQuarterNotesPerMinute;
+}
+
+void
+DurationEstimator::addSystem(const std::vector<Barline> &barlines,
+                             const std::vector<TempoMarker> &tempo_markers)
+{
+    auto tempo_it = tempo_markers.begin();
+
+    for (size_t i = 0; i + 1 < barlines.size(); ++i)
+    {
+        const int end_pos = barlines[i + 1].getPosition();
+        const bool last_bar = (i + 2 == barlines.size());
+
+        for (; tempo_it != tempo_markers.end() &&
+               (last_bar || tempo_it->getPosition() < end_pos);
+             ++tempo_it)
+        {
+            if (tempo_it->getMarkerType() == TempoMarker::StandardMarker)
+                setTempo(tempo_it->getBeatsPerMinute(), tempo_it->getBeatType());
+        }
+
+        const TimeSignature &time_sig = barlines[i].getTimeSignature();
+        addBar(time_sig.getBeatsPerMeasure(), time_sig.getBeatValue());
+    }
+}
+
+std::chrono::duration<double>
+DurationEstimator::getDuration() const
+{
+    return std::chrono::duration<double>(myMinutes * 60);
+}
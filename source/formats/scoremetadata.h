@@ -0,0 +1,78 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FORMATS_SCOREMETADATA_H
+#define FORMATS_SCOREMETADATA_H
+
+#include <chrono>
+#include <optional>
+#include <score/scoreinfo.h>
+#include <score/tempomarker.h>
+#include <string>
+#include <vector>
+
+class Barline;
+class Score;
+
+/// Summary information about a score, which is used for cataloguing files
+/// without importing the entire score.
+struct ScoreMetadata
+{
+    struct Instrument
+    {
+        std::string myName;
+        int myStringCount = 0;
+    };
+
+    ScoreInfo myScoreInfo;
+    std::vector<Instrument> myInstruments;
+    int myBarCount = 0;
+    /// Approximate playback time, ignoring repeats and any tempo changes in
+    /// the middle of a bar. This is empty if the file format does not provide
+    /// enough information to cheaply estimate the duration.
+    std::optional<std::chrono::duration<double>> myDuration;
+
+    /// Collects the metadata from an already imported score.
+    static ScoreMetadata fromScore(const Score &score);
+};
+
+/// Accumulates the approximate playback time of a sequence of bars.
+class DurationEstimator
+{
+public:
+    /// Changes the tempo for any following bars.
+    void setTempo(int beats_per_minute,
+                  TempoMarker::BeatType beat_type = TempoMarker::Quarter);
+
+    /// Adds a bar with the given time signature (e.g. 6/8).
+    void addBar(int num_beats, int beat_value);
+
+    /// Adds each bar of a system, along with its tempo markers. Tempo changes
+    /// take effect from the start of the bar that they occur in.
+    void addSystem(const std::vector<Barline> &barlines,
+                   const std::vector<TempoMarker> &tempo_markers);
+
+    std::chrono::duration<double> getDuration() const;
+
+private:
+    /// The current tempo, in quarter notes per minute.
+    double myQuarterNotesPerMinute = TempoMarker::DEFAULT_BEATS_PER_MINUTE;
+    /// The total length in minutes.
+    double myMinutes = 0;
+};
+
+#endif
@@ -19,8 +19,9 @@
 
 #include <QPainter>
 
-AntialiasedPathItem::AntialiasedPathItem(const QPainterPath &path)
-    : QGraphicsPathItem(path)
+AntialiasedPathItem::AntialiasedPathItem(ScoreColor color,
+                                         const QPainterPath &path)
+    : ThemedItem<QGraphicsPathItem>(color, path)
 {
 }
 
@@ -30,5 +31,5 @@ void AntialiasedPathItem::paint(QPainter *painter,
 
 {
     painter->setRenderHint(QPainter::Antialiasing);
-    QGraphicsPathItem::paint(painter, option, widget);
+    ThemedItem<QGraphicsPathItem>::paint(painter, option, widget);
 }
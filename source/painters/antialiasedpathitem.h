@@ -18,14 +18,14 @@
 #ifndef PAINTERS_ANTIALIASEDPATHITEM_H
 #define PAINTERS_ANTIALIASEDPATHITEM_H
 
-#include <QGraphicsPathItem>
+#include <painters/themeditem.h>
 
 /// Allows antialiasing to be selectively enabled for specific items,
 /// rather than for the entire scene.
-class AntialiasedPathItem : public QGraphicsPathItem
+class AntialiasedPathItem : public ThemedItem<QGraphicsPathItem>
 {
 public:
-    AntialiasedPathItem(const QPainterPath &path);
+    AntialiasedPathItem(ScoreColor color, const QPainterPath &path);
 
     virtual void paint(QPainter *painter,
                        const QStyleOptionGraphicsItem *option,
@@ -29,7 +29,7 @@ BarlinePainter::BarlinePainter(const LayoutConstPtr &layout,
                                const Barline &barline,
                                const ScoreLocation &location,
                                const std::shared_ptr<ClickPubSub> &pubsub,
-                               const QColor &barlineColor)
+                               ScoreColor barlineColor)
     : myLayout(layout),
       myBarline(barline),
       myLocation(location),
@@ -108,13 +108,14 @@ bool BarlinePainter::isInStdNotationStaff(double y)
 void BarlinePainter::paint(QPainter *painter, const QStyleOptionGraphicsItem *,
                            QWidget *)
 {
-    painter->setPen(QPen(myBarlineColor, 0.75));
-    painter->setBrush(myBarlineColor);
+    const QColor color = getScoreColor(*this, myBarlineColor);
+    painter->setPen(QPen(color, 0.75));
+    painter->setBrush(color);
 
     const Barline::BarType barType = myBarline.getBarType();
 
     if (barType == Barline::FreeTimeBar)
-        painter->setPen(Qt::DashLine);
+        painter->setPen(QPen(color, 0.75, Qt::DashLine));
 
     // Print the repeat count for repeat end bars.
     if (barType == Barline::RepeatEnd &&
@@ -137,7 +138,7 @@ void BarlinePainter::paint(QPainter *painter, const QStyleOptionGraphicsItem *,
     {
         // Make the line thicker for certain bar types.
         if (barType != Barline::DoubleBar)
-            painter->setPen(QPen(myBarlineColor, 2));
+            painter->setPen(QPen(color, 2));
 
         // Draw the second barline with an offset of the specified width.
         drawVerticalLines(painter, myX + myWidth);
@@ -146,7 +147,7 @@ void BarlinePainter::paint(QPainter *painter, const QStyleOptionGraphicsItem *,
     // Draw the dots for repeats.
     if (barType == Barline::RepeatEnd || barType == Barline::RepeatStart)
     {
-        painter->setPen(QPen(myBarlineColor, 0.75));
+        painter->setPen(QPen(color, 0.75));
         const double radius = 1.0;
         // x-coordinate for the location of the dots.
         const double dotLocation = myX - 1.5 * myWidth;
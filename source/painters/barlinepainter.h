@@ -21,9 +21,10 @@
 #include <QGraphicsItem>
 #include <memory>
 #include <painters/layoutinfo.h>
+#include <painters/scorecolor.h>
+#include <score/barline.h>
 #include <score/scorelocation.h>
 
-class Barline;
 class ClickPubSub;
 
 class BarlinePainter : public QGraphicsItem
@@ -32,7 +33,7 @@ public:
     BarlinePainter(const LayoutConstPtr& layout, const Barline &barline,
                    const ScoreLocation& location,
                    const std::shared_ptr<ClickPubSub> &pubsub,
-                   const QColor &barlineColor);
+                   ScoreColor barlineColor);
 
     virtual void paint(QPainter *painter,
                        const QStyleOptionGraphicsItem *option,
@@ -53,13 +54,13 @@ private:
     void drawVerticalLines(QPainter *painter, double myX);
 
     LayoutConstPtr myLayout;
-    const Barline &myBarline;
+    const Barline myBarline;
     QRectF myBounds;
     ScoreLocation myLocation;
     std::shared_ptr<ClickPubSub> myPubSub;
     double myX;
     double myWidth;
-    const QColor &myBarlineColor;
+    const ScoreColor myBarlineColor;
 
     static const double DOUBLE_BAR_WIDTH;
 };
@@ -21,6 +21,7 @@
 #include <painters/layoutinfo.h>
 #include <painters/musicfont.h>
 #include <painters/simpletextitem.h>
+#include <painters/themeditem.h>
 #include <QFontMetricsF>
 #include <QGraphicsItem>
 #include <QPainterPath>
@@ -45,7 +46,7 @@ BeamGroup::BeamGroup(NoteStem::StemType direction,
 
 void
 BeamGroup::drawStems(QGraphicsItem *parent, const std::vector<NoteStem> &stems,
-                     const QFont &musicFont, const QColor &color,
+                     const QFont &musicFont, ScoreColor color,
                      const LayoutInfo &layout) const
 {
     QList<QGraphicsItem *> symbols;
@@ -83,8 +84,8 @@ BeamGroup::drawStems(QGraphicsItem *parent, const std::vector<NoteStem> &stems,
         symbols.clear();
     }
 
-    auto stemPathItem = new QGraphicsPathItem(stemPath);
-    stemPathItem->setPen(QPen(color, 1.0, Qt::SolidLine));
+    auto stemPathItem = new ThemedItem<QGraphicsPathItem>(color, stemPath);
+    stemPathItem->setPen(makeThemedPen(1.0));
     stemPathItem->setParentItem(parent);
 
     QPainterPath beamPath;
@@ -100,8 +101,8 @@ BeamGroup::drawStems(QGraphicsItem *parent, const std::vector<NoteStem> &stems,
 
     drawExtraBeams(beamPath, begin, end);
 
-    auto beams = new QGraphicsPathItem(beamPath);
-    beams->setPen(QPen(color, 2.0, Qt::SolidLine, Qt::RoundCap));
+    auto beams = new ThemedItem<QGraphicsPathItem>(color, beamPath);
+    beams->setPen(makeThemedPen(2.0, Qt::SolidLine, Qt::RoundCap));
     beams->setParentItem(parent);
 
     // Draw a note flag for single notes (eighth notes or less) or grace notes.
@@ -178,7 +179,7 @@ void BeamGroup::drawExtraBeams(QPainterPath &path,
 
 QGraphicsItem *BeamGroup::createStaccato(const NoteStem &stem,
                                          const QFont &musicFont,
-                                         const QColor &color)
+                                         ScoreColor color)
 {
     // Draw the dot near either the top or bottom note of the position,
     // depending on stem direction.
@@ -192,7 +193,7 @@ QGraphicsItem *BeamGroup::createStaccato(const NoteStem &stem,
                          : stem.getX() + STEM_TO_NOTE_OFFSET;
 
     auto dot = new SimpleTextItem(QChar(MusicFont::Dot), musicFont, 
-                                    TextAlignment::Baseline,QPen(color));
+                                    TextAlignment::Baseline, color);
     dot->setPos(x, y);
     return dot;
 }
@@ -200,7 +201,7 @@ QGraphicsItem *BeamGroup::createStaccato(const NoteStem &stem,
 QGraphicsItem *BeamGroup::createFermata(const NoteStem &stem,
                                         const QFont &musicFont,
                                         const LayoutInfo &layout,
-                                        const QColor &color)
+                                        ScoreColor color)
 {
     static constexpr double padding = 4;
     // Position the fermata directly above/below the staff if possible, unless
@@ -218,7 +219,7 @@ QGraphicsItem *BeamGroup::createFermata(const NoteStem &stem,
 
     const QChar symbol = (stem.getStemType() == NoteStem::StemUp) ?
                 MusicFont::FermataUp : MusicFont::FermataDown;
-    auto fermata = new SimpleTextItem(symbol, musicFont, TextAlignment::Baseline,QPen(color));
+    auto fermata = new SimpleTextItem(symbol, musicFont, TextAlignment::Baseline, color);
     fermata->setPos(stem.getX(), y);
 
     return fermata;
@@ -227,7 +228,7 @@ QGraphicsItem *BeamGroup::createFermata(const NoteStem &stem,
 QGraphicsItem *BeamGroup::createAccent(const NoteStem &stem,
                                        const QFont &musicFont,
                                        const LayoutInfo &layout,
-                                       const QColor &color)
+                                       ScoreColor color)
 {
     static constexpr double padding = 7;
     static constexpr double staccato_offset = padding;
@@ -277,7 +278,7 @@ QGraphicsItem *BeamGroup::createAccent(const NoteStem &stem,
     }
 
     auto accent =
-	new SimpleTextItem(symbol, musicFont, TextAlignment::Baseline, QPen(color));
+	new SimpleTextItem(symbol, musicFont, TextAlignment::Baseline, color);
     accent->setPos(x, y);
 
     return accent;
@@ -285,7 +286,7 @@ QGraphicsItem *BeamGroup::createAccent(const NoteStem &stem,
 
 QGraphicsItem *
 BeamGroup::createNoteFlag(const NoteStem &stem, const QFont &musicFont,
-                                         const QColor &flagColor)
+                                         ScoreColor flagColor)
 {
     Q_ASSERT(NoteStem::canHaveFlag(stem));
 
@@ -342,7 +343,7 @@ BeamGroup::createNoteFlag(const NoteStem &stem, const QFont &musicFont,
     // Draw the symbol.
     const double y = stem.getStemEdge();
     auto flag = new SimpleTextItem(symbol, musicFont, TextAlignment::Baseline,
-        QPen(flagColor, 1.0));
+        flagColor);
     flag->setPos(stem.getX(), y);
 
     // For grace notes, add a slash through the stem.
@@ -356,7 +357,7 @@ BeamGroup::createNoteFlag(const NoteStem &stem, const QFont &musicFont,
                                        : MusicFont::GraceNoteSlashDown;
 
         auto slash = new SimpleTextItem(slash_symbol, musicFont, 
-	        TextAlignment::Baseline, QPen(flagColor));
+	        TextAlignment::Baseline, flagColor);
         slash->setPos(stem.getX() + 1, y);
         group->addToGroup(slash);
 
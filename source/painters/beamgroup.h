@@ -19,7 +19,7 @@
 #define PAINTERS_BEAMGROUP_H
 
 #include <painters/notestem.h>
-#include <QColor> 
+#include <painters/scorecolor.h>
 #include <vector>
 
 struct LayoutInfo;
@@ -35,7 +35,7 @@ public:
 
     /// Draws the stems for each note in the group.
     void drawStems(QGraphicsItem *parent, const std::vector<NoteStem> &stems,
-                   const QFont &musicFont, const QColor &color,
+                   const QFont &musicFont, ScoreColor color,
                    const LayoutInfo &layout) const;
 
 private:
@@ -47,23 +47,23 @@ private:
     /// Creates and positions a staccato symbol.
     static QGraphicsItem *createStaccato(const NoteStem& stem,
                                          const QFont &musicFont,
-                                         const QColor &color);
+                                         ScoreColor color);
 
     /// Creates and positions a fermata symbol.
     static QGraphicsItem *createFermata(const NoteStem& noteStem,
                                         const QFont &musicFont,
                                         const LayoutInfo &layout,
-                                        const QColor &color);
+                                        ScoreColor color);
 
     /// Creates and positions an accent symbol.
     static QGraphicsItem *createAccent(const NoteStem& stem,
                                        const QFont &musicFont,
                                        const LayoutInfo &layout,
-                                       const QColor &color);
+                                       ScoreColor color);
 
     static QGraphicsItem *createNoteFlag(const NoteStem& stem,
                                          const QFont &musicFont,
-                                         const QColor &color);
+                                         ScoreColor color);
 
     NoteStem::StemType myStemDirection;
     std::vector<size_t> myStems;
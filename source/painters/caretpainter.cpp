@@ -31,9 +31,11 @@
 const double CaretPainter::PEN_WIDTH = 0.75;
 const double CaretPainter::CARET_NOTE_SPACING = 6;
 
-CaretPainter::CaretPainter(const Caret &caret, const ViewOptions &view_options)
+CaretPainter::CaretPainter(const Caret &caret, const ViewOptions &view_options,
+                           const SystemRectFunction &get_system_rect)
     : myCaret(caret),
       myViewOptions(view_options),
+      myGetSystemRect(get_system_rect),
       myCaretConnection(caret.subscribeToChanges([=]() {
           onLocationChanged();
       }))
@@ -129,19 +131,19 @@ QRectF CaretPainter::boundingRect() const
         return QRectF();
 }
 
-void CaretPainter::addSystemRect(const QRectF &rect)
+void CaretPainter::addSystem(std::vector<LayoutConstPtr> layouts)
 {
-    mySystemRects.push_back(rect);
+    mySystemLayouts.push_back(std::move(layouts));
 }
 
-void CaretPainter::setSystemRect(int index, const QRectF &rect)
+void CaretPainter::setSystem(int index, std::vector<LayoutConstPtr> layouts)
 {
-    mySystemRects.at(index) = rect;
+    mySystemLayouts.at(index) = std::move(layouts);
 }
 
 QRectF CaretPainter::getCurrentSystemRect() const
 {
-    return mySystemRects.at(myCaret.getLocation().getSystemIndex());
+    return myGetSystemRect(myCaret.getLocation().getSystemIndex());
 }
 
 void CaretPainter::updatePosition()
@@ -166,7 +168,7 @@ void CaretPainter::onLocationChanged()
     if (system.getStaves().empty())
         return;
 
-    myLayout = std::make_unique<LayoutInfo>(location);
+    myLayout = getLayout(location);
 
     const ViewFilter *filter =
         myViewOptions.getFilter()
@@ -182,12 +184,12 @@ void CaretPainter::onLocationChanged()
         {
             ScoreLocation staff_location(location);
             staff_location.setStaffIndex(i);
-            offset += LayoutInfo(staff_location).getStaffHeight();
+            offset += getLayout(staff_location)->getStaffHeight();
         }
     }
 
     const QRectF oldRect = sceneBoundingRect();
-    setPos(0, mySystemRects.at(location.getSystemIndex()).top() + offset +
+    setPos(0, myGetSystemRect(location.getSystemIndex()).top() + offset +
            myLayout->getSystemSymbolSpacing() + myLayout->getStaffHeight() -
            myLayout->getTabStaffBelowSpacing() - myLayout->STAFF_BORDER_SPACING -
            myLayout->getTabStaffHeight());
@@ -200,3 +202,23 @@ void CaretPainter::onLocationChanged()
     // Notify anyone interested in the caret being redrawn.
     onMyLocationChanged();
 }
+
+LayoutConstPtr CaretPainter::getLayout(const ScoreLocation &location) const
+{
+    const size_t systemIndex = location.getSystemIndex();
+    const size_t staffIndex = location.getStaffIndex();
+
+    if (systemIndex < mySystemLayouts.size())
+    {
+        const std::vector<LayoutConstPtr> &layouts =
+            mySystemLayouts[systemIndex];
+        if (staffIndex < layouts.size() && layouts[staffIndex])
+            return layouts[staffIndex];
+    }
+
+    // The staff might not have been rendered (e.g. if it is hidden by the
+    // view filter).
+    auto layout = std::make_shared<LayoutInfo>(location);
+    layout->releaseScoreReferences();
+    return layout;
+}
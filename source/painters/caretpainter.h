@@ -19,25 +19,34 @@
 #define PAINTERS_CARETPAINTER_H
 
 #include <boost/signals2/signal.hpp>
+#include <functional>
 #include <memory>
+#include <painters/layoutinfo.h>
 #include <QGraphicsItem>
+#include <vector>
 
 class Caret;
-struct LayoutInfo;
+class ScoreLocation;
 class ViewOptions;
 
 class CaretPainter : public QGraphicsItem
 {
 public:
-    CaretPainter(const Caret &caret, const ViewOptions &view_options);
+    /// Returns the scene location of the specified system.
+    typedef std::function<QRectF(int)> SystemRectFunction;
+
+    CaretPainter(const Caret &caret, const ViewOptions &view_options,
+                 const SystemRectFunction &get_system_rect);
 
     virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
                        QWidget *) override;
 
     virtual QRectF boundingRect() const override;
 
-    void addSystemRect(const QRectF &rect);
-    void setSystemRect(int index, const QRectF &rect);
+    /// Records the staff layouts of a rendered system. The layouts are reused
+    /// when the caret moves within the system.
+    void addSystem(std::vector<LayoutConstPtr> layouts);
+    void setSystem(int index, std::vector<LayoutConstPtr> layouts);
     QRectF getCurrentSystemRect() const;
 
     void updatePosition();
@@ -51,10 +60,15 @@ private:
     /// Redraw the caret painter whenever the caret moves.
     void onLocationChanged();
 
+    /// Returns the layout of the specified staff, using the layout from
+    /// rendering the system when possible.
+    LayoutConstPtr getLayout(const ScoreLocation &location) const;
+
     const Caret &myCaret;
     const ViewOptions &myViewOptions;
-    std::unique_ptr<LayoutInfo> myLayout;
-    std::vector<QRectF> mySystemRects;
+    SystemRectFunction myGetSystemRect;
+    LayoutConstPtr myLayout;
+    std::vector<std::vector<LayoutConstPtr>> mySystemLayouts;
     boost::signals2::scoped_connection myCaretConnection;
     LocationChangedSlot onMyLocationChanged;
 
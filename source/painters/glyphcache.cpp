@@ -0,0 +1,123 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "glyphcache.h"
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <QFont>
+#include <QFontMetricsF>
+#include <QHash>
+#include <QPair>
+#include <QString>
+
+namespace
+{
+/// Limit the size of the cache in case there is a large amount of distinct
+/// text (e.g. from text items or chord names). The least recently used
+/// entries are removed first, so the common glyphs stay cached.
+const int MAX_ENTRIES = 10000;
+
+typedef QPair<QFont, QString> Key;
+
+struct CachedEntry
+{
+    std::shared_ptr<const GlyphCache::Entry> myEntry;
+    /// The entry's location in theRecentKeys.
+    std::list<Key>::iterator myRecentKey;
+};
+
+std::mutex theMutex;
+QHash<Key, CachedEntry> theEntries;
+/// The keys, ordered from most to least recently used.
+std::list<Key> theRecentKeys;
+
+std::atomic<uint64_t> theHitCount(0);
+std::atomic<uint64_t> theMissCount(0);
+
+std::shared_ptr<const GlyphCache::Entry> createEntry(const QFont &font,
+                                                     const QString &text)
+{
+    auto entry = std::make_shared<GlyphCache::Entry>();
+    entry->myText.setText(text);
+    entry->myText.setTextFormat(Qt::PlainText);
+    entry->myText.setPerformanceHint(QStaticText::AggressiveCaching);
+    entry->myText.prepare(QTransform(), font);
+
+    const QFontMetricsF fm(font);
+    entry->myAscent = fm.ascent();
+    entry->myLineRect = QRectF(0, 0, fm.horizontalAdvance(text), fm.height());
+    entry->myBounds = fm.boundingRect(text);
+
+    return entry;
+}
+} // namespace
+
+std::shared_ptr<const GlyphCache::Entry> GlyphCache::get(const QFont &font,
+                                                         const QString &text)
+{
+    const Key key(font, text);
+
+    {
+        std::lock_guard<std::mutex> lock(theMutex);
+        auto it = theEntries.find(key);
+        if (it != theEntries.end())
+        {
+            ++theHitCount;
+            theRecentKeys.splice(theRecentKeys.begin(), theRecentKeys,
+                                 it->myRecentKey);
+            return it->myEntry;
+        }
+    }
+
+    // Lay out the text without holding the lock. If another thread adds the
+    // same text in the meantime, its entry is equivalent.
+    ++theMissCount;
+    auto entry = createEntry(font, text);
+
+    std::lock_guard<std::mutex> lock(theMutex);
+    auto it = theEntries.find(key);
+    if (it != theEntries.end())
+        return it->myEntry;
+
+    if (theEntries.size() >= MAX_ENTRIES)
+    {
+        theEntries.remove(theRecentKeys.back());
+        theRecentKeys.pop_back();
+    }
+
+    theRecentKeys.push_front(key);
+    theEntries.insert(key, { entry, theRecentKeys.begin() });
+    return entry;
+}
+
+uint64_t GlyphCache::getHitCount()
+{
+    return theHitCount;
+}
+
+uint64_t GlyphCache::getMissCount()
+{
+    return theMissCount;
+}
+
+void GlyphCache::resetCounters()
+{
+    theHitCount = 0;
+    theMissCount = 0;
+}
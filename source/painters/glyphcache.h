@@ -0,0 +1,63 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_GLYPHCACHE_H
+#define PAINTERS_GLYPHCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <QRectF>
+#include <QStaticText>
+
+class QFont;
+class QString;
+
+/// Process-wide cache of the layout and metrics for the short strings of
+/// text that are drawn repeatedly when rendering a score (fret numbers, note
+/// heads, accidentals, dynamics, "H", "P", etc). This avoids shaping the
+/// text and querying the font metrics each time it is drawn.
+/// The cache can be used from multiple threads. However, QPainter updates a
+/// QStaticText's layout when drawing it with a different font or transform,
+/// so the entries (and the items that draw them) must not be painted from
+/// more than one thread at a time.
+namespace GlyphCache
+{
+struct Entry
+{
+    /// The text, laid out for the font.
+    QStaticText myText;
+    /// The font's ascent.
+    double myAscent = 0;
+    /// The rectangle given by the text's advance width and the font's line
+    /// height, relative to the top left corner of the text.
+    QRectF myLineRect;
+    /// The tight bounding rectangle of the glyphs, relative to the baseline.
+    QRectF myBounds;
+};
+
+/// Returns the cached layout for the text, creating it if necessary.
+std::shared_ptr<const Entry> get(const QFont &font, const QString &text);
+
+/// Returns the number of lookups that found an existing entry.
+uint64_t getHitCount();
+/// Returns the number of lookups that created a new entry.
+uint64_t getMissCount();
+/// Resets the hit and miss counters.
+void resetCounters();
+} // namespace GlyphCache
+
+#endif
@@ -20,6 +20,7 @@
 
 #include <app/pubsub/clickpubsub.h>
 #include <painters/musicfont.h>
+#include <painters/scorecolor.h>
 #include <QCursor>
 #include <QPainter>
 #include <score/keysignature.h>
@@ -63,6 +64,7 @@ void KeySignaturePainter::hoverLeaveEvent(QGraphicsSceneHoverEvent *)
 void KeySignaturePainter::paint(QPainter *painter,
                                 const QStyleOptionGraphicsItem*, QWidget*)
 {
+    painter->setPen(getScoreColor(*this, ScoreColor::Default));
     painter->setFont(myMusicFont);
 
     // Draw the appropriate accidentals.
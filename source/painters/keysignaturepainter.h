@@ -22,6 +22,7 @@
 #include <QFont>
 #include <QGraphicsItem>
 #include <painters/layoutinfo.h>
+#include <score/keysignature.h>
 #include <score/scorelocation.h>
 
 class ClickPubSub;
@@ -47,7 +48,7 @@ private:
     virtual void hoverLeaveEvent(QGraphicsSceneHoverEvent *) override;
 
     LayoutConstPtr myLayout;
-    const KeySignature &myKeySignature;
+    const KeySignature myKeySignature;
     const ScoreLocation myLocation;
     std::shared_ptr<ClickPubSub> myPubSub;
     QFont myMusicFont;
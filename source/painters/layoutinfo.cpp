@@ -18,6 +18,7 @@
 #include "layoutinfo.h"
 
 #include <algorithm>
+#include <painters/renderprofiler.h>
 #include <painters/verticallayout.h>
 #include <score/keysignature.h>
 #include <score/score.h>
@@ -52,17 +53,33 @@ LayoutInfo::LayoutInfo(const ScoreLocation &location)
       myStdNotationStaffAboveSpacing(0),
       myStdNotationStaffBelowSpacing(0)
 {
+    RenderProfiler::ScopedTimer timer(RenderProfiler::Phase::Layout);
+
     computePositionSpacing();
-    calculateTabStaffBelowLayout();
-    calculateTabStaffAboveLayout();
+    computePositionTable();
 
-    StdNotationNote::getNotesInStaff(
-        location.getScore(), location.getSystem(), location.getSystemIndex(),
-        location.getStaff(), location.getStaffIndex(), *this, myNotes, myStems,
-        myBeamGroups);
+    {
+        RenderProfiler::ScopedTimer symbols_timer(
+            RenderProfiler::Phase::SymbolGroups);
+        calculateTabStaffBelowLayout();
+        calculateTabStaffAboveLayout();
+    }
 
-    calculateStdNotationStaffAboveLayout();
-    calculateStdNotationStaffBelowLayout();
+    {
+        RenderProfiler::ScopedTimer notes_timer(
+            RenderProfiler::Phase::StdNotationNotes);
+        StdNotationNote::getNotesInStaff(
+            location.getScore(), location.getSystem(),
+            location.getSystemIndex(), location.getStaff(),
+            location.getStaffIndex(), *this, myNotes, myStems, myBeamGroups);
+    }
+
+    {
+        RenderProfiler::ScopedTimer symbols_timer(
+            RenderProfiler::Phase::SymbolGroups);
+        calculateStdNotationStaffAboveLayout();
+        calculateStdNotationStaffBelowLayout();
+    }
 
     // Update the locations of the stems based on the spacing we just computed.
     const double offset = getTopStdNotationLine();
@@ -216,12 +233,15 @@ double LayoutInfo::getFirstPositionX() const
 
 double LayoutInfo::getPositionX(int position) const
 {
-    double x = getFirstPositionX();
-    // Include the width of all key/time signatures.
-    x += getCumulativeBarlineWidths(position);
-    // Move over 'n' positions.
-    x += (position + 1) * getPositionSpacing();
-    return x;
+    // Positions past the end of the system (e.g. the end of a selection)
+    // don't have any further barlines to skip over.
+    if (position < 0 || position >= static_cast<int>(myPositionX.size()))
+    {
+        const int last = position < 0 ? 0 : myNumPositions;
+        return myPositionX[last] + (position - last) * getPositionSpacing();
+    }
+
+    return myPositionX[position];
 }
 
 int LayoutInfo::getPositionFromX(double x) const
@@ -230,14 +250,19 @@ int LayoutInfo::getPositionFromX(double x) const
         return 0;
 
     const int maxPosition = getNumPositions() - 1;
+    if (maxPosition < 1)
+        return maxPosition;
 
-    for (int i = 1; i <= maxPosition; ++i)
-    {
-        if (getPositionX(i) >= x)
-            return i - 1;
-    }
+    // Find the first position whose x-coordinate is at or beyond x, and then
+    // select the position to its left.
+    auto begin = myPositionX.begin() + 1;
+    auto end = myPositionX.begin() + maxPosition + 1;
+    auto it = std::lower_bound(begin, end, x);
 
-    return maxPosition;
+    if (it == end)
+        return maxPosition;
+
+    return static_cast<int>(it - myPositionX.begin()) - 1;
 }
 
 double LayoutInfo::getWidth(const KeySignature &key)
@@ -292,26 +317,41 @@ double LayoutInfo::getTabStaffBelowSpacing() const
     return myTabStaffBelowSpacing;
 }
 
-double LayoutInfo::getCumulativeBarlineWidths(int position) const
+double LayoutInfo::getCumulativeBarlineWidths() const
 {
-    const System &system = myLocation.getSystem();
+    const auto barlines = myLocation.getSystem().getBarlines();
     double width = 0;
 
-    const bool allBarlines = (position == -1);
+    // Skip the start and end bars.
+    for (size_t i = 1; i + 1 < barlines.size(); ++i)
+        width += getWidth(barlines[i]);
 
-    for (const Barline &barline : system.getBarlines())
+    return width;
+}
+
+void LayoutInfo::computePositionTable()
+{
+    const auto barlines = myLocation.getSystem().getBarlines();
+    const double firstX = getFirstPositionX();
+
+    // Accumulate the widths of the key and time signatures from the barlines
+    // in the middle of the system (i.e. excluding the start and end bars).
+    myPositionX.resize(myNumPositions + 1);
+    double barlineWidths = 0;
+    size_t barIndex = 1;
+
+    for (int position = 0; position <= myNumPositions; ++position)
     {
-        if (barline == system.getBarlines().front() ||
-            barline == system.getBarlines().back())
-            continue;
+        while (barIndex + 1 < barlines.size() &&
+               barlines[barIndex].getPosition() < position)
+        {
+            barlineWidths += getWidth(barlines[barIndex]);
+            ++barIndex;
+        }
 
-        if (allBarlines || barline.getPosition() < position)
-            width += getWidth(barline);
-        else
-            break;
+        myPositionX[position] =
+            firstX + barlineWidths + (position + 1) * getPositionSpacing();
     }
-
-    return width;
 }
 
 template <typename Range>
@@ -859,6 +899,22 @@ const std::vector<NoteStem> &LayoutInfo::getNoteStems(int voice) const
     return myStems.at(voice);
 }
 
+void LayoutInfo::releaseScoreReferences()
+{
+    for (std::vector<SymbolGroup> *symbols :
+         { &myTabStaffBelowSymbols, &myTabStaffAboveSymbols,
+           &myStdNotationStaffAboveSymbols, &myStdNotationStaffBelowSymbols })
+    {
+        *symbols = std::vector<SymbolGroup>();
+    }
+
+    myNotes = std::vector<StdNotationNote>();
+    for (auto &stems : myStems)
+        stems = std::vector<NoteStem>();
+    for (auto &groups : myBeamGroups)
+        groups = std::vector<BeamGroup>();
+}
+
 SymbolGroup::SymbolType SymbolGroup::getSymbolType() const
 {
     return mySymbolType;
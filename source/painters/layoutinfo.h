@@ -169,17 +169,26 @@ struct LayoutInfo
     const std::vector<BeamGroup> &getBeamGroups(int voice) const;
     const std::vector<NoteStem> &getNoteStems(int voice) const;
 
+    /// Discards the symbol groups, notes, stems and beam groups, which point
+    /// to voices, positions and notes in the score. These are only needed
+    /// while drawing the staff, and a layout that is kept afterwards (e.g. by
+    /// the caret) would otherwise be left with dangling pointers when the
+    /// score's systems are reallocated.
+    void releaseScoreReferences();
+
 private:
     static const double MIN_POSITION_SPACING;
 
     /// Gets the total width used by all key and time signatures that reside
-    /// within the system (does not include the start bar). If the position
-    /// is -1, traverse all barlines.
-    double getCumulativeBarlineWidths(int position = -1) const;
+    /// within the system (does not include the start bar).
+    double getCumulativeBarlineWidths() const;
 
     /// Compute an optimal position spacing for the system.
     void computePositionSpacing();
 
+    /// Compute the x-coordinate of each position in the system.
+    void computePositionTable();
+
     /// Compute the spacing and layout of symbols that are drawn below the
     /// tab staff.
     void calculateTabStaffBelowLayout();
@@ -215,6 +224,9 @@ private:
     int myLineSpacing;
     double myPositionSpacing;
     int myNumPositions;
+    /// The x-coordinate of each position, including the space taken by any
+    /// key and time signature changes before it.
+    std::vector<double> myPositionX;
 
     std::vector<SymbolGroup> myTabStaffBelowSymbols;
     double myTabStaffBelowSpacing;
@@ -0,0 +1,123 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "renderprofiler.h"
+
+#include <array>
+#include <atomic>
+
+namespace
+{
+struct AtomicStats
+{
+    std::atomic<uint64_t> myCalls{ 0 };
+    std::atomic<int64_t> myTotalTime{ 0 };
+    std::atomic<int64_t> mySelfTime{ 0 };
+};
+
+std::atomic<bool> theEnabled(false);
+std::array<AtomicStats, RenderProfiler::NUM_PHASES> theStats;
+/// The innermost timer that is running on this thread.
+thread_local RenderProfiler::ScopedTimer *theCurrentTimer = nullptr;
+} // namespace
+
+namespace RenderProfiler
+{
+void setEnabled(bool enabled)
+{
+    theEnabled = enabled;
+}
+
+bool isEnabled()
+{
+    return theEnabled;
+}
+
+const char *getPhaseName(Phase phase)
+{
+    switch (phase)
+    {
+        case Phase::Layout:
+            return "layout";
+        case Phase::StdNotationNotes:
+            return "std_notation_notes";
+        case Phase::Beaming:
+            return "beaming";
+        case Phase::SymbolGroups:
+            return "symbol_groups";
+        case Phase::ItemCreation:
+            return "item_creation";
+        case Phase::SceneInsertion:
+            return "scene_insertion";
+    }
+
+    return "";
+}
+
+PhaseStats getStats(Phase phase)
+{
+    const AtomicStats &stats = theStats[static_cast<int>(phase)];
+
+    PhaseStats result;
+    result.myCalls = stats.myCalls;
+    result.myTotalTime = std::chrono::nanoseconds(stats.myTotalTime);
+    result.mySelfTime = std::chrono::nanoseconds(stats.mySelfTime);
+    return result;
+}
+
+void resetStats()
+{
+    for (AtomicStats &stats : theStats)
+    {
+        stats.myCalls = 0;
+        stats.myTotalTime = 0;
+        stats.mySelfTime = 0;
+    }
+}
+
+ScopedTimer::ScopedTimer(Phase phase)
+    : myPhase(phase),
+      myActive(theEnabled.load(std::memory_order_relaxed)),
+      myParent(nullptr),
+      myNestedTime(0)
+{
+    if (!myActive)
+        return;
+
+    myParent = theCurrentTimer;
+    theCurrentTimer = this;
+    myStart = std::chrono::steady_clock::now();
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    if (!myActive)
+        return;
+
+    const std::chrono::nanoseconds elapsed =
+        std::chrono::steady_clock::now() - myStart;
+
+    theCurrentTimer = myParent;
+    if (myParent)
+        myParent->myNestedTime += elapsed;
+
+    AtomicStats &stats = theStats[static_cast<int>(myPhase)];
+    ++stats.myCalls;
+    stats.myTotalTime += elapsed.count();
+    stats.mySelfTime += (elapsed - myNestedTime).count();
+}
+} // namespace RenderProfiler
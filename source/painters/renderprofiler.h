@@ -0,0 +1,89 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_RENDERPROFILER_H
+#define PAINTERS_RENDERPROFILER_H
+
+#include <chrono>
+#include <cstdint>
+
+/// Process-wide timers for the phases of rendering a score, which are used by
+/// the rendering benchmark. Profiling is disabled by default, in which case
+/// the timers only check a flag.
+/// The timers can be used from multiple threads.
+namespace RenderProfiler
+{
+enum class Phase
+{
+    /// Constructing the layout for a staff.
+    Layout,
+    /// Finding the standard notation notes and stems (part of the layout).
+    StdNotationNotes,
+    /// Grouping the stems into beams (part of finding the notes).
+    Beaming,
+    /// Stacking the groups of symbols above and below the staves (part of the
+    /// layout).
+    SymbolGroups,
+    /// Creating the graphics items for a system.
+    ItemCreation,
+    /// Adding the rendered systems to a scene.
+    SceneInsertion
+};
+
+constexpr int NUM_PHASES = 6;
+
+struct PhaseStats
+{
+    uint64_t myCalls = 0;
+    /// The total time, including any phases nested inside this phase.
+    std::chrono::nanoseconds myTotalTime{ 0 };
+    /// The time spent in this phase, excluding any nested phases.
+    std::chrono::nanoseconds mySelfTime{ 0 };
+};
+
+void setEnabled(bool enabled);
+bool isEnabled();
+
+/// Returns a short name for the phase (e.g. "layout").
+const char *getPhaseName(Phase phase);
+
+PhaseStats getStats(Phase phase);
+/// Resets the statistics for all of the phases.
+void resetStats();
+
+/// Records the time until the end of the scope for the phase, if profiling is
+/// enabled. Timers that are nested on the same thread are subtracted from
+/// the enclosing timer's self time.
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Phase phase);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    const Phase myPhase;
+    const bool myActive;
+    ScopedTimer *myParent;
+    std::chrono::steady_clock::time_point myStart;
+    std::chrono::nanoseconds myNestedTime;
+};
+} // namespace RenderProfiler
+
+#endif
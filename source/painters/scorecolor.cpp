@@ -0,0 +1,76 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "scorecolor.h"
+
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+#include <QPalette>
+
+/// The weight of the background color when blending the staff line color.
+static const double STAFF_LINE_BACKGROUND_WEIGHT = 0.7;
+
+static int blend(int background, int text)
+{
+    return static_cast<int>(background * STAFF_LINE_BACKGROUND_WEIGHT +
+                            text * (1 - STAFF_LINE_BACKGROUND_WEIGHT));
+}
+
+QColor getScoreColor(const QPalette &palette, ScoreColor color)
+{
+    switch (color)
+    {
+        case ScoreColor::Default:
+            return palette.text().color();
+        case ScoreColor::Background:
+            return palette.light().color();
+        case ScoreColor::Muted:
+            return palette.dark().color();
+        case ScoreColor::StaffLine:
+        {
+            // Blending the background and text colors ensures that the staff
+            // lines are lighter than the notes with any palette.
+            const QColor text = palette.text().color();
+            const QColor background = palette.light().color();
+            return QColor(blend(background.red(), text.red()),
+                          blend(background.green(), text.green()),
+                          blend(background.blue(), text.blue()));
+        }
+        case ScoreColor::None:
+            break;
+    }
+
+    return Qt::transparent;
+}
+
+QColor getScoreColor(const QGraphicsItem &item, ScoreColor color)
+{
+    if (const QGraphicsScene *scene = item.scene())
+        return getScoreColor(scene->palette(), color);
+    else
+        return getScoreColor(QPalette(), color);
+}
+
+QPalette getPrintPalette()
+{
+    QPalette palette;
+    palette.setColor(QPalette::Text, Qt::black);
+    palette.setColor(QPalette::Light, Qt::white);
+    palette.setColor(QPalette::Dark, Qt::lightGray);
+    return palette;
+}
@@ -0,0 +1,58 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_SCORECOLOR_H
+#define PAINTERS_SCORECOLOR_H
+
+#include <QColor>
+
+class QGraphicsItem;
+class QPalette;
+
+/// The colors used for drawing the score. Rather than storing a specific
+/// color, graphics items store one of these roles and look up the color from
+/// the scene's palette when they are painted. This allows the score to be
+/// painted with a different palette (e.g. after the theme changes, or when
+/// printing) without rendering it again.
+enum class ScoreColor
+{
+    /// Notes, symbols, and text (the palette's text color).
+    Default,
+    /// Drawn behind text that covers a staff line (the palette's light
+    /// color).
+    Background,
+    /// Notes that are de-emphasized, such as tied notes (the palette's dark
+    /// color).
+    Muted,
+    /// The staff lines, which are a blend of the text and background colors.
+    StaffLine,
+    /// Nothing is drawn.
+    None
+};
+
+/// Returns the color for the role in the given palette.
+QColor getScoreColor(const QPalette &palette, ScoreColor color);
+
+/// Returns the color for the role in the palette of the item's scene, or the
+/// default palette if the item is not in a scene.
+QColor getScoreColor(const QGraphicsItem &item, ScoreColor color);
+
+/// Returns the palette used for printing or exporting the score, which has
+/// black notes on a white background.
+QPalette getPrintPalette();
+
+#endif
@@ -0,0 +1,260 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scoreexporter.h"
+
+#include <algorithm>
+#include <app/pubsub/clickpubsub.h>
+#include <cmath>
+#include <memory>
+#include <painters/scorecolor.h>
+#include <painters/scoreinforenderer.h>
+#include <painters/systemrenderer.h>
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+#include <QImage>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QPicture>
+#include <QSvgGenerator>
+#include <score/score.h>
+#include <stdexcept>
+#include <thread>
+#include <util/parallel.h>
+
+/// The vertical spacing between systems, which matches the score area.
+static const double SYSTEM_SPACING = 50;
+
+std::vector<std::vector<PageItem>> paginate(
+    const QList<QGraphicsItem *> &items, const QSizeF &page_size)
+{
+    std::vector<std::vector<PageItem>> pages(1);
+    double y = 0;
+
+    for (int i = 0, n = items.length(); i < n; ++i)
+    {
+        QGraphicsItem *item = items[i];
+        const QRectF source_rect = item->sceneBoundingRect();
+        const double ratio =
+            std::min(page_size.width() / source_rect.width(),
+                     page_size.height() / source_rect.height());
+
+        if (i > 0)
+        {
+            const double spacing =
+                source_rect.y() - items[i - 1]->sceneBoundingRect().bottom();
+            y += spacing * ratio;
+        }
+
+        // Figure out how much space the item will take up on the page, and
+        // determine if we need a page break.
+        const double height = source_rect.height() * ratio;
+        if (y + height > page_size.height() && !pages.back().empty())
+        {
+            pages.emplace_back();
+            y = 0;
+        }
+
+        pages.back().push_back(
+            { item, source_rect,
+              QRectF(0, y, source_rect.width() * ratio, height) });
+
+        // Set the location for the next item.
+        y += height;
+    }
+
+    return pages;
+}
+
+ScoreExporter::ScoreExporter(const Score &score,
+                             const ViewOptions &view_options,
+                             const QPageLayout &page_layout)
+    : myPageLayout(page_layout), myResolution(QPicture().logicalDpiX())
+{
+    QList<QGraphicsItem *> items;
+
+    QGraphicsItem *score_info =
+        ScoreInfoRenderer::render(score.getScoreInfo(), ScoreColor::Default);
+    items.append(score_info);
+    double height =
+        score_info->boundingRect().height() + 0.5 * SYSTEM_SPACING;
+
+    // The items aren't interactive, so nothing subscribes to the clicks.
+    auto click_pubsub = std::make_shared<ClickPubSub>();
+    for (int i = 0, n = static_cast<int>(score.getSystems().size()); i < n;
+         ++i)
+    {
+        SystemRenderer render(click_pubsub, score, view_options);
+        QGraphicsItem *system = render(score.getSystems()[i], i);
+        system->setPos(0, height);
+        height += system->boundingRect().height() + SYSTEM_SPACING;
+
+        items.append(system);
+    }
+
+    // Lay out the pages in the same units as the pictures, so that nothing
+    // is rescaled when the pictures are played back.
+    const QRect page_rect(QPoint(),
+                          myPageLayout.paintRectPixels(myResolution).size());
+    const std::vector<std::vector<PageItem>> pages =
+        paginate(items, page_rect.size());
+
+    // Record each page from its own scene, which deletes the items afterwards.
+    const QPalette palette = getPrintPalette();
+    for (const std::vector<PageItem> &page : pages)
+    {
+        QGraphicsScene scene;
+        // The items are only drawn once, so there is no need to maintain an
+        // index for finding items.
+        scene.setItemIndexMethod(QGraphicsScene::NoIndex);
+        scene.setPalette(palette);
+
+        for (const PageItem &item : page)
+            scene.addItem(item.myItem);
+
+        QPicture picture;
+        picture.setBoundingRect(page_rect);
+
+        QPainter painter(&picture);
+        for (const PageItem &item : page)
+            scene.render(&painter, item.myTarget, item.mySource);
+        painter.end();
+
+        myPages.push_back(std::move(picture));
+    }
+}
+
+ScoreExporter::~ScoreExporter() = default;
+
+int ScoreExporter::getPageCount() const
+{
+    return static_cast<int>(myPages.size());
+}
+
+QString ScoreExporter::getPageFilename(const QString &base_name, int page,
+                                       const QString &extension)
+{
+    return QStringLiteral("%1-%2.%3").arg(base_name).arg(page).arg(extension);
+}
+
+void ScoreExporter::exportPdf(const QString &filename) const
+{
+    QPdfWriter writer(filename);
+    writer.setPageLayout(myPageLayout);
+    writer.setResolution(myResolution);
+
+    QPainter painter;
+    if (!painter.begin(&writer))
+    {
+        throw std::runtime_error("Could not write to " +
+                                 filename.toStdString());
+    }
+
+    // The PDF can only be written one page at a time.
+    for (size_t i = 0; i < myPages.size(); ++i)
+    {
+        if (i > 0)
+            writer.newPage();
+
+        painter.drawPicture(0, 0, myPages[i]);
+    }
+
+    painter.end();
+}
+
+void ScoreExporter::exportSvg(const QString &base_name) const
+{
+    const QRect full_rect = myPageLayout.fullRectPixels(myResolution);
+    const QPoint origin = myPageLayout.paintRectPixels(myResolution).topLeft();
+
+    // Generating the SVG looks up the fonts of the recorded text, so this
+    // stays on the exporter's thread.
+    for (size_t i = 0; i < myPages.size(); ++i)
+    {
+        const QString filename =
+            getPageFilename(base_name, static_cast<int>(i) + 1, "svg");
+
+        QSvgGenerator generator;
+        generator.setFileName(filename);
+        generator.setResolution(myResolution);
+        generator.setSize(full_rect.size());
+        generator.setViewBox(QRect(QPoint(), full_rect.size()));
+
+        QPainter painter;
+        if (!painter.begin(&generator))
+        {
+            throw std::runtime_error("Could not write to " +
+                                     filename.toStdString());
+        }
+
+        painter.drawPicture(origin, myPages[i]);
+        painter.end();
+    }
+}
+
+void ScoreExporter::exportPng(const QString &base_name, int width,
+                              unsigned int num_threads) const
+{
+    const QRect full_rect = myPageLayout.fullRectPixels(myResolution);
+    const QPoint origin = myPageLayout.paintRectPixels(myResolution).topLeft();
+    const double scale = static_cast<double>(width) / full_rect.width();
+    const int height = static_cast<int>(std::lround(full_rect.height() * scale));
+
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Draw a batch of pages on this thread, and then compress them in
+    // parallel. Saving a QImage doesn't use any fonts, so it is safe from
+    // other threads. The batches limit how many full-size images are held in
+    // memory at once.
+    std::vector<QImage> images;
+    for (size_t first = 0; first < myPages.size(); first += num_threads)
+    {
+        const size_t count =
+            std::min<size_t>(num_threads, myPages.size() - first);
+
+        images.clear();
+        for (size_t i = first; i < first + count; ++i)
+        {
+            QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+            image.fill(Qt::white);
+
+            QPainter painter(&image);
+            painter.setRenderHints(QPainter::Antialiasing |
+                                   QPainter::TextAntialiasing |
+                                   QPainter::SmoothPixmapTransform);
+            painter.scale(scale, scale);
+            painter.drawPicture(origin, myPages[i]);
+            painter.end();
+
+            images.push_back(std::move(image));
+        }
+
+        Util::parallelFor(
+            count,
+            [&](size_t i) {
+                const QString filename = getPageFilename(
+                    base_name, static_cast<int>(first + i) + 1, "png");
+                if (!images[i].save(filename, "PNG"))
+                {
+                    throw std::runtime_error("Could not write to " +
+                                             filename.toStdString());
+                }
+            },
+            num_threads);
+    }
+}
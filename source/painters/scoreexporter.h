@@ -0,0 +1,97 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_SCOREEXPORTER_H
+#define PAINTERS_SCOREEXPORTER_H
+
+#include <QList>
+#include <QPageLayout>
+#include <QPicture>
+#include <QRectF>
+#include <vector>
+
+class QGraphicsItem;
+class QString;
+class Score;
+class ViewOptions;
+
+/// The location of a block of the score (the score information or a system)
+/// on a page.
+struct PageItem
+{
+    QGraphicsItem *myItem;
+    /// The item's bounding rectangle in the scene.
+    QRectF mySource;
+    /// The area of the page that the item is drawn into.
+    QRectF myTarget;
+};
+
+/// Splits the items, which are stacked vertically in the scene, into pages.
+/// Each item is scaled to fit the width of the page, and the spacing between
+/// the items is kept. A new page is started when an item does not fit below
+/// the previous item.
+std::vector<std::vector<PageItem>> paginate(
+    const QList<QGraphicsItem *> &items, const QSizeF &page_size);
+
+/// Renders a score to PDF, SVG, or PNG files without needing a view, so that
+/// it can be used from the command line with Qt's offscreen platform.
+/// The constructor lays out the score and records each page into a QPicture.
+/// The pages are recorded and played back on the thread that created the
+/// exporter (normally the GUI thread). The graphics items share cached text
+/// layouts (see GlyphCache), and playing back a picture draws its text with
+/// the fonts again, which is only safe from other threads on platforms whose
+/// font engines support it. Only the PNG compression, which doesn't touch any
+/// fonts, is done in parallel.
+class ScoreExporter
+{
+public:
+    ScoreExporter(const Score &score, const ViewOptions &view_options,
+                  const QPageLayout &page_layout);
+    ~ScoreExporter();
+
+    int getPageCount() const;
+
+    /// Writes a multi-page PDF file.
+    /// @throw std::runtime_error
+    void exportPdf(const QString &filename) const;
+
+    /// Writes an SVG file for each page, named "<base_name>-<page>.svg".
+    /// @throw std::runtime_error
+    void exportSvg(const QString &base_name) const;
+
+    /// Writes a PNG image of each page, named "<base_name>-<page>.png".
+    /// @param width The width of the images in pixels.
+    /// @param num_threads The number of images to compress at a time, or 0 to
+    /// use one thread per core.
+    /// @throw std::runtime_error
+    void exportPng(const QString &base_name, int width,
+                   unsigned int num_threads = 0) const;
+
+    /// Returns the file name for a page when writing a file per page.
+    static QString getPageFilename(const QString &base_name, int page,
+                                   const QString &extension);
+
+private:
+    QPageLayout myPageLayout;
+    /// The resolution of the pictures that the pages are recorded into.
+    int myResolution;
+    /// The drawing for each page, with the origin at the top left corner of
+    /// the page's printable area.
+    std::vector<QPicture> myPages;
+};
+
+#endif
@@ -47,10 +47,10 @@ static double getNextY(const QGraphicsItemGroup &group)
 }
 
 static void addCenteredText(QGraphicsItemGroup &group, QFont font,
-                            int font_size, const QColor &color, const QString &text)
+                            int font_size, ScoreColor color, const QString &text)
 {
     font.setPointSize(font_size);
-    auto text_item = new SimpleTextItem(text, font, TextAlignment::Top, QPen(color));
+    auto text_item = new SimpleTextItem(text, font, TextAlignment::Top, color);
 
     // Center horizontally.
     text_item->setX(LayoutInfo::centerItem(0.0, LayoutInfo::STAFF_WIDTH,
@@ -61,7 +61,7 @@ static void addCenteredText(QGraphicsItemGroup &group, QFont font,
 }
 
 static void renderReleaseInfo(QGraphicsItemGroup &group, const QFont &font,
-                              const QColor &color, const SongData &song_data)
+                              ScoreColor color, const SongData &song_data)
 {
     QString release_info;
 
@@ -112,7 +112,7 @@ static void renderReleaseInfo(QGraphicsItemGroup &group, const QFont &font,
 }
 
 static void addAuthorText(QGraphicsItemGroup &group, QFont font,
-                          const QColor &color, const QString &text, const double y,
+                          ScoreColor color, const QString &text, const double y,
                           bool right_align = false)
 {
     font.setPointSize(AUTHOR_SIZE);
@@ -136,7 +136,7 @@ static void addAuthorText(QGraphicsItemGroup &group, QFont font,
 }
 
 static void renderAuthorInfo(QGraphicsItemGroup &group, const QFont &font,
-                              const QColor &color, const SongData &song_data)
+                              ScoreColor color, const SongData &song_data)
 {
     const double y = getNextY(group);
     QStringList author_lines;
@@ -193,7 +193,7 @@ static void renderAuthorInfo(QGraphicsItemGroup &group, const QFont &font,
 }
 
 static void renderSongInfo(QGraphicsItemGroup &group, const QFont &font,
-                            const QColor &color, const SongData &song_data)
+                            ScoreColor color, const SongData &song_data)
 {
     if (!song_data.getTitle().empty())
     {
@@ -222,7 +222,7 @@ static void renderSongInfo(QGraphicsItemGroup &group, const QFont &font,
 }
 
 static void renderLessonInfo(QGraphicsItemGroup &group, const QFont &font,
-                           const QColor &color, const LessonData &lesson_data)
+                           ScoreColor color, const LessonData &lesson_data)
 {
     if (!lesson_data.getTitle().empty())
     {
@@ -253,7 +253,7 @@ static void renderLessonInfo(QGraphicsItemGroup &group, const QFont &font,
 }
 
 QGraphicsItem *
-ScoreInfoRenderer::render(const ScoreInfo &score_info, const QColor &color)
+ScoreInfoRenderer::render(const ScoreInfo &score_info, ScoreColor color)
 {
     QFont font(QStringLiteral("Liberation Serif"));
 
@@ -18,14 +18,14 @@
 #ifndef PAINTERS_SCOREINFO_H
 #define PAINTERS_SCOREINFO_H
 
-#include <QColor>
+#include <painters/scorecolor.h>
 
 class QGraphicsItem;
 class ScoreInfo;
 
 namespace ScoreInfoRenderer
 {
-QGraphicsItem *render(const ScoreInfo &score_info, const QColor &color);
+QGraphicsItem *render(const ScoreInfo &score_info, ScoreColor color);
 }
 
 #endif
@@ -20,23 +20,21 @@
 #include <QPainter>
 
 SimpleTextItem::SimpleTextItem(const QString &text, const QFont &font,
-                               TextAlignment alignment, const QPen &pen,
-                               const QBrush &background)
-    : myText(text),
+                               TextAlignment alignment, ScoreColor color,
+                               ScoreColor background)
+    : myGlyphs(GlyphCache::get(font, text)),
       myFont(font),
-      myPen(pen),
+      myColor(color),
       myBackground(background),
       myAlignment(alignment)
 {
-    QFontMetricsF fm(myFont);
-    myAscent = fm.ascent();
     switch (myAlignment)
     {
         case TextAlignment::Top:
-            myBoundingRect = QRectF(0, 0, fm.width(myText), fm.height());
+            myBoundingRect = myGlyphs->myLineRect;
             break;
         case TextAlignment::Baseline:
-            myBoundingRect = fm.boundingRect(text);
+            myBoundingRect = myGlyphs->myBounds;
             break;
     }
 }
@@ -46,23 +44,28 @@ void SimpleTextItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *,
 {
     // Draw the background rectangle. Avoid to cover other elements
     // by drawing only 1/3 of the rectangle, vertically centered.
-    painter->fillRect(
-                myBoundingRect.x(),
-                myBoundingRect.y() + myBoundingRect.height() / 3,
-                myBoundingRect.width(),
-                myBoundingRect.height() / 3,
-                myBackground);
+    if (myBackground != ScoreColor::None)
+    {
+        painter->fillRect(
+                    myBoundingRect.x(),
+                    myBoundingRect.y() + myBoundingRect.height() / 3,
+                    myBoundingRect.width(),
+                    myBoundingRect.height() / 3,
+                    getScoreColor(*this, myBackground));
+    }
 
-    painter->setPen(myPen);
+    painter->setPen(getScoreColor(*this, myColor));
     painter->setFont(myFont);
 
+    // The static text is positioned by its top left corner.
     switch (myAlignment)
     {
         case TextAlignment::Top:
-            painter->drawText(0, myAscent, myText);
+            painter->drawStaticText(QPointF(0, 0), myGlyphs->myText);
             break;
         case TextAlignment::Baseline:
-            painter->drawText(0, 0, myText);
+            painter->drawStaticText(QPointF(0, -myGlyphs->myAscent),
+                                    myGlyphs->myText);
             break;
     }
 }
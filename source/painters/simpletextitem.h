@@ -18,10 +18,11 @@
 #ifndef PAINTERS_SIMPLETEXTITEM_H
 #define PAINTERS_SIMPLETEXTITEM_H
 
-#include <QBrush>
+#include <memory>
+#include <painters/glyphcache.h>
+#include <painters/scorecolor.h>
 #include <QFont>
 #include <QGraphicsItem>
-#include <QPen>
 
 /// Specifies the text alignment for SimpleTextItem.
 enum class TextAlignment
@@ -41,8 +42,9 @@ class SimpleTextItem : public QGraphicsItem
 {
 public:
     SimpleTextItem(const QString &text, const QFont &font,
-                   TextAlignment alignment, const QPen &pen = QPen(),
-                   const QBrush &background = QBrush(QColor(0, 0, 0, 0)));
+                   TextAlignment alignment,
+                   ScoreColor color = ScoreColor::Default,
+                   ScoreColor background = ScoreColor::None);
 
     virtual QRectF boundingRect() const override { return myBoundingRect; }
 
@@ -51,13 +53,12 @@ public:
                        QWidget *widget) override;
 
 private:
-    const QString myText;
+    const std::shared_ptr<const GlyphCache::Entry> myGlyphs;
     const QFont myFont;
-    const QPen myPen;
-    const QBrush myBackground;
+    const ScoreColor myColor;
+    const ScoreColor myBackground;
     const TextAlignment myAlignment;
     QRectF myBoundingRect;
-    double myAscent;
 };
 
 #endif
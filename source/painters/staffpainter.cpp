@@ -18,22 +18,91 @@
 #include "staffpainter.h"
 
 #include <app/pubsub/clickpubsub.h>
+#include <algorithm>
 #include <cmath>
+#include <optional>
 #include <QGraphicsSceneMouseEvent>
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 StaffPainter::StaffPainter(const LayoutConstPtr &layout,
                            const ScoreLocation &location,
-                           const std::shared_ptr<ClickPubSub> &pubsub,
-                           const QColor staffColor)
+                           const std::shared_ptr<ClickPubSub> &pubsub)
     : myLayout(layout),
       myPubSub(pubsub),
       myLocation(location),
-      myBounds(0, 0, LayoutInfo::STAFF_WIDTH, layout->getStaffHeight()),
-      myStaffColor(staffColor)
+      myStaffBounds(0, 0, LayoutInfo::STAFF_WIDTH, layout->getStaffHeight()),
+      myBounds(myStaffBounds)
 {
     // Only use the left mouse button for making selections.
     setAcceptedMouseButtons(Qt::LeftButton);
+    // Provide the exposed area when painting so that the draw list can be
+    // culled.
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+QPainterPath StaffPainter::shape() const
+{
+    QPainterPath path;
+    path.addRect(myStaffBounds);
+    return path;
+}
+
+void StaffPainter::addText(const QPointF &pos, const QString &text,
+                           const QFont &font, TextAlignment alignment,
+                           ScoreColor color, ScoreColor background)
+{
+    const int index = getTextIndex(text, getFontIndex(font));
+    const TextLayout &layout = myTextLayouts[index];
+
+    // Convert to the top left corner of the text, which is where
+    // QStaticText is drawn from.
+    QPointF topLeft = pos;
+    if (alignment == TextAlignment::Baseline)
+        topLeft.ry() -= layout.myGlyphs->myAscent;
+
+    myTextEntries.push_back({ topLeft, index, color, background });
+
+    prepareGeometryChange();
+    myBounds |= layout.myBounds.translated(topLeft);
+}
+
+void StaffPainter::addPath(const QPainterPath &path, ScoreColor color)
+{
+    myPathEntries.push_back({ path, color });
+
+    prepareGeometryChange();
+    myBounds |= path.boundingRect();
+}
+
+int StaffPainter::getFontIndex(const QFont &font)
+{
+    auto it = std::find(myFonts.begin(), myFonts.end(), font);
+    if (it != myFonts.end())
+        return static_cast<int>(it - myFonts.begin());
+
+    myFonts.push_back(font);
+    return static_cast<int>(myFonts.size()) - 1;
+}
+
+int StaffPainter::getTextIndex(const QString &text, int font)
+{
+    const QPair<QString, int> key(text, font);
+    auto it = myTextLayoutIndices.constFind(key);
+    if (it != myTextLayoutIndices.constEnd())
+        return *it;
+
+    TextLayout layout;
+    layout.myGlyphs = GlyphCache::get(myFonts[font], text);
+    layout.myFont = font;
+    layout.myBounds =
+        layout.myGlyphs->myLineRect |
+        layout.myGlyphs->myBounds.translated(0, layout.myGlyphs->myAscent);
+
+    const int index = static_cast<int>(myTextLayouts.size());
+    myTextLayouts.push_back(std::move(layout));
+    myTextLayoutIndices.insert(key, index);
+    return index;
 }
 
 void StaffPainter::mousePressEvent(QGraphicsSceneMouseEvent *event)
@@ -64,10 +133,10 @@ void StaffPainter::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
     myPubSub->publish(ClickType::Selection, myLocation);
 }
 
-void StaffPainter::paint(QPainter *painter, const QStyleOptionGraphicsItem *,
-                         QWidget *)
+void StaffPainter::paint(QPainter *painter,
+                         const QStyleOptionGraphicsItem *option, QWidget *)
 {
-    painter->setPen(QPen(QBrush(myStaffColor), 0.75));
+    painter->setPen(QPen(getScoreColor(*this, ScoreColor::StaffLine), 0.75));
 
     // Draw standard notation staff.
     drawStaffLines(painter, LayoutInfo::NUM_STD_NOTATION_LINES,
@@ -77,6 +146,58 @@ void StaffPainter::paint(QPainter *painter, const QStyleOptionGraphicsItem *,
     // Draw tab staff.
     drawStaffLines(painter, myLayout->getStringCount(),
                    myLayout->getTabLineSpacing(), myLayout->getTopTabLine());
+
+    const QRectF exposed = option->exposedRect;
+
+    for (const PathEntry &entry : myPathEntries)
+    {
+        painter->setPen(getScoreColor(*this, entry.myColor));
+        painter->drawPath(entry.myPath);
+    }
+
+    // Fill in the backgrounds first so that they don't cover up any nearby
+    // text.
+    for (const TextEntry &entry : myTextEntries)
+    {
+        if (entry.myBackground == ScoreColor::None)
+            continue;
+
+        const QRectF rect =
+            myTextLayouts[entry.myText].myGlyphs->myLineRect.translated(
+                entry.myPos);
+        if (!rect.intersects(exposed))
+            continue;
+
+        painter->fillRect(QRectF(rect.x(), rect.y() + rect.height() / 3,
+                                 rect.width(), rect.height() / 3),
+                          getScoreColor(*this, entry.myBackground));
+    }
+
+    // Only change the pen and font when necessary, since consecutive
+    // entries (e.g. the fret numbers in a staff) usually share them.
+    std::optional<ScoreColor> currentColor;
+    int currentFont = -1;
+
+    for (const TextEntry &entry : myTextEntries)
+    {
+        const TextLayout &layout = myTextLayouts[entry.myText];
+        if (!layout.myBounds.translated(entry.myPos).intersects(exposed))
+            continue;
+
+        if (entry.myColor != currentColor)
+        {
+            currentColor = entry.myColor;
+            painter->setPen(getScoreColor(*this, entry.myColor));
+        }
+
+        if (layout.myFont != currentFont)
+        {
+            currentFont = layout.myFont;
+            painter->setFont(myFonts[currentFont]);
+        }
+
+        painter->drawStaticText(entry.myPos, layout.myGlyphs->myText);
+    }
 }
 
 void StaffPainter::drawStaffLines(QPainter *painter, int lineCount,
@@ -19,20 +19,29 @@
 #define PAINTERS_STAFFPAINTER_H
 
 #include <memory>
+#include <painters/glyphcache.h>
 #include <painters/layoutinfo.h>
+#include <painters/simpletextitem.h>
+#include <QFont>
 #include <QGraphicsItem>
+#include <QHash>
+#include <QPainterPath>
 #include <score/scorelocation.h>
+#include <vector>
 
 class ScoreLocation;
 class ClickPubSub;
 class Staff;
 
+/// Draws the staff lines, along with the notes and other symbols that are
+/// drawn frequently. Rather than creating a separate graphics item for each
+/// fret number or note head, they are added to a draw list which is painted
+/// in a single pass.
 class StaffPainter : public QGraphicsItem
 {
 public:
     StaffPainter(const LayoutConstPtr &layout, const ScoreLocation &location,
-                 const std::shared_ptr<ClickPubSub> &pubsub,
-                 const QColor staffColor);
+                 const std::shared_ptr<ClickPubSub> &pubsub);
 
     virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
                        QWidget *) override;
@@ -42,6 +51,23 @@ public:
         return myBounds;
     }
 
+    /// Only the staff itself handles clicks, rather than any symbols that are
+    /// drawn above or below it.
+    virtual QPainterPath shape() const override;
+
+    /// Adds text to the draw list, in the staff's local coordinates.
+    /// @param background If not ScoreColor::None, the middle third of the
+    /// text's bounding rectangle is filled in (e.g. to hide the staff line
+    /// behind a fret number).
+    void addText(const QPointF &pos, const QString &text, const QFont &font,
+                 TextAlignment alignment,
+                 ScoreColor color = ScoreColor::Default,
+                 ScoreColor background = ScoreColor::None);
+
+    /// Adds the outline of a path to the draw list.
+    void addPath(const QPainterPath &path,
+                 ScoreColor color = ScoreColor::Default);
+
 protected:
     virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
     virtual void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
@@ -51,11 +77,45 @@ private:
                         double startHeight);
     int getPositionFromX(double x) const;
 
+    int getFontIndex(const QFont &font);
+    int getTextIndex(const QString &text, int font);
+
+    /// A unique string of text in a particular font.
+    struct TextLayout
+    {
+        std::shared_ptr<const GlyphCache::Entry> myGlyphs;
+        int myFont;
+        /// The bounding rectangle relative to the top left corner, including
+        /// any glyphs that extend past the line.
+        QRectF myBounds;
+    };
+
+    struct TextEntry
+    {
+        /// The top left corner of the text.
+        QPointF myPos;
+        int myText;
+        ScoreColor myColor;
+        ScoreColor myBackground;
+    };
+
+    struct PathEntry
+    {
+        QPainterPath myPath;
+        ScoreColor myColor;
+    };
+
     LayoutConstPtr myLayout;
     std::shared_ptr<ClickPubSub> myPubSub;
     ScoreLocation myLocation;
-    const QRectF myBounds;
-    const QColor myStaffColor;
+    const QRectF myStaffBounds;
+    QRectF myBounds;
+
+    std::vector<QFont> myFonts;
+    std::vector<TextLayout> myTextLayouts;
+    QHash<QPair<QString, int>, int> myTextLayoutIndices;
+    std::vector<TextEntry> myTextEntries;
+    std::vector<PathEntry> myPathEntries;
 };
 
 #endif
@@ -22,6 +22,7 @@
 #include <numeric>
 #include <painters/layoutinfo.h>
 #include <painters/musicfont.h>
+#include <painters/renderprofiler.h>
 #include <QFontMetricsF>
 #include <score/generalmidi.h>
 #include <score/score.h>
@@ -216,6 +217,8 @@ void StdNotationNote::getNotesInStaff(
                     NoteStem(voice, pos, x, noteHeadWidth, noteLocations));
             }
 
+            RenderProfiler::ScopedTimer timer(
+                RenderProfiler::Phase::Beaming);
             computeBeaming(bar.getTimeSignature(), stems, firstStem, groups);
         }
 
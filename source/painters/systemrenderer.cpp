@@ -18,17 +18,19 @@
 #include "systemrenderer.h"
 
 #include <app/pubsub/clickpubsub.h>
-#include <app/scorearea.h>
 #include <app/viewoptions.h>
 #include <boost/range/adaptor/map.hpp>
 #include <boost/range/algorithm/find_if.hpp>
 #include <painters/antialiasedpathitem.h>
 #include <painters/barlinepainter.h>
 #include <painters/clickablegroup.h>
+#include <painters/glyphcache.h>
 #include <painters/keysignaturepainter.h>
 #include <painters/layoutinfo.h>
+#include <painters/renderprofiler.h>
 #include <painters/simpletextitem.h>
 #include <painters/staffpainter.h>
+#include <painters/themeditem.h>
 #include <painters/stdnotationnote.h>
 #include <painters/timesignaturepainter.h>
 #include <painters/verticallayout.h>
@@ -59,9 +61,10 @@ void SystemRenderer::centerSymbolVertically(QGraphicsItem &item, double y)
                          item.boundingRect().height()));
 }
 
-SystemRenderer::SystemRenderer(const ScoreArea *score_area, const Score &score,
+SystemRenderer::SystemRenderer(std::shared_ptr<ClickPubSub> click_pubsub,
+                               const Score &score,
                                const ViewOptions &view_options)
-    : myScoreArea(score_area),
+    : myClickPubSub(std::move(click_pubsub)),
       myScore(score),
       myViewOptions(view_options),
       myParentSystem(nullptr),
@@ -76,22 +79,27 @@ SystemRenderer::SystemRenderer(const ScoreArea *score_area, const Score &score,
     myPlainTextFont.setStyleStrategy(QFont::PreferAntialias);
     mySymbolTextFont.setPixelSize(9);
     myRehearsalSignFont.setPixelSize(12);
-
-    myPalette = *myScoreArea->getPalette();
 }
 
 QGraphicsItem *SystemRenderer::operator()(const System &system,
                                           int systemIndex)
 {
+    // Building the layout for each staff is recorded separately, as a nested
+    // phase.
+    RenderProfiler::ScopedTimer timer(RenderProfiler::Phase::ItemCreation);
+
     // Draw the bounding rectangle for the system.
-    myParentSystem = new QGraphicsRectItem();
-    myParentSystem->setPen(QPen(myPalette.text(), 0.5));
+    myParentSystem = new ThemedItem<QGraphicsRectItem>(ScoreColor::Default);
+    myParentSystem->setPen(makeThemedPen(0.5));
 
     const ViewFilter *filter =
         myViewOptions.getFilter()
             ? &myScore.getViewFilters()[*myViewOptions.getFilter()]
             : nullptr;
 
+    myLayouts.clear();
+    myLayouts.resize(system.getStaves().size());
+
     // Draw each staff.
     double height = 0;
     int i = 0;
@@ -105,7 +113,8 @@ QGraphicsItem *SystemRenderer::operator()(const System &system,
 
         const bool isFirstStaff = (height == 0);
         const ScoreLocation location(myScore, systemIndex, i);
-        LayoutConstPtr layout = std::make_shared<LayoutInfo>(location);
+        LayoutPtr layout = std::make_shared<LayoutInfo>(location);
+        myLayouts[i] = layout;
 
         if (isFirstStaff)
         {
@@ -113,29 +122,9 @@ QGraphicsItem *SystemRenderer::operator()(const System &system,
             height += layout->getSystemSymbolSpacing();
         }
 
-        // set a custom color for the staff, depending on
-        // the background color and the text/note color
-        // getting the staff color as an average of both colors
-        // ensures flexibility with different palettes
-        
-        //rgb value for text
-        int r1, g1, b1; 
-        //rgb value for background 
-        int r2, g2, b2; //rgb value for background
-        //ratio of the background color in the weighted average
-        double avgWeight = 0.7; 
-
-        myPalette.text().color().getRgb(&r1,&g1,&b1);
-        myPalette.light().color().getRgb(&r2,&g2,&b2);
-
-        QColor staffColor(r2*avgWeight+r1*(1-avgWeight),
-                    g2*avgWeight+g1*(1-avgWeight), 
-                    b2*avgWeight+b1*(1-avgWeight));
-
         myParentStaff = new StaffPainter(layout,
                                          ScoreLocation(myScore, systemIndex, i),
-                                         myScoreArea->getClickPubSub(),
-                                         staffColor);
+                                         myClickPubSub);
         myParentStaff->setPos(0, height);
         myParentStaff->setParentItem(myParentSystem);
         height += layout->getStaffHeight();
@@ -149,12 +138,11 @@ QGraphicsItem *SystemRenderer::operator()(const System &system,
         const double clef_y = (staff.getClefType() == Staff::TrebleClef)
                                   ? layout->getStdNotationLine(4)
                                   : layout->getStdNotationLine(2);
-        auto pubsub = myScoreArea->getClickPubSub();
+        auto pubsub = myClickPubSub;
         auto clef = new SimpleTextItem(staff.getClefType() == Staff::TrebleClef
                                            ? QChar(MusicFont::TrebleClef)
                                            : QChar(MusicFont::BassClef),
-                                           clef_font, TextAlignment::Baseline,
-                                           QPen(myPalette.text().color()));
+                                           clef_font, TextAlignment::Baseline);
         auto group = new ClickableGroup(
             QObject::tr("Click to change clef type."), [=]() {
             pubsub->publish(ClickType::Clef, location);
@@ -178,6 +166,10 @@ QGraphicsItem *SystemRenderer::operator()(const System &system,
         drawPlayerChanges(system, i, *layout);
         drawStdNotation(system, staff, *layout);
 
+        // The layout is shared with the painters and the caret, which only
+        // need its spacing.
+        layout->releaseScoreReferences();
+
         ++i;
     }
 
@@ -196,9 +188,9 @@ void SystemRenderer::drawTabClef(double x, const LayoutInfo &layout,
 
     QFont font = MusicFont::getFont(pixel_size);
 
-    auto clef = new SimpleTextItem(QChar(MusicFont::TabClef), font, TextAlignment::Baseline, QPen(myPalette.text().color()));
+    auto clef = new SimpleTextItem(QChar(MusicFont::TabClef), font, TextAlignment::Baseline);
 
-    auto pubsub = myScoreArea->getClickPubSub();
+    auto pubsub = myClickPubSub;
     auto group = new ClickableGroup(
         QObject::tr("Click to edit the number of strings."), [=]() {
         pubsub->publish(ClickType::TabClef, location);
@@ -220,7 +212,7 @@ void SystemRenderer::drawBarNumber(int systemIndex, const LayoutInfo &layout)
         number += static_cast<int>(system.getBarlines().size()) - 1;
     }
 
-    auto text = new SimpleTextItem(QString::number(number), myPlainTextFont,TextAlignment::Top ,QPen(myPalette.text().color()));
+    auto text = new SimpleTextItem(QString::number(number), myPlainTextFont,TextAlignment::Top);
     text->setPos(-text->boundingRect().width() - LayoutInfo::BAR_NUMBER_PADDING,
                  layout.getTopStdNotationLine());
     text->setParentItem(myParentStaff);
@@ -239,7 +231,7 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
         const TimeSignature &timeSig = barline.getTimeSignature();
 
         BarlinePainter *barlinePainter = new BarlinePainter(layout, barline,
-                location, myScoreArea->getClickPubSub(), myPalette.text().color());
+                location, myClickPubSub, ScoreColor::Default);
 
         double x = layout->getPositionX(barline.getPosition());
         double keySigX = x + barlinePainter->boundingRect().width() - 1;
@@ -286,7 +278,7 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
         {
             KeySignaturePainter *keySigPainter = new KeySignaturePainter(
                         layout, keySig, location,
-                        myScoreArea->getClickPubSub());
+                        myClickPubSub);
 
             keySigPainter->setPos(keySigX, layout->getTopStdNotationLine());
             keySigPainter->setParentItem(myParentStaff);
@@ -296,7 +288,7 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
         {
             TimeSignaturePainter *timeSigPainter = new TimeSignaturePainter(
                         layout, timeSig, location,
-                        myScoreArea->getClickPubSub());
+                        myClickPubSub);
 
             timeSigPainter->setPos(timeSigX, layout->getTopStdNotationLine());
             timeSigPainter->setParentItem(myParentStaff);
@@ -308,7 +300,7 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
             const int RECTANGLE_OFFSET = 4;
 
             auto signLetters = new SimpleTextItem(
-                QString::fromStdString(sign.getLetters()), myRehearsalSignFont, TextAlignment::Top, QPen(myPalette.text().color()));
+                QString::fromStdString(sign.getLetters()), myRehearsalSignFont, TextAlignment::Top);
             signLetters->setX(rehearsalSignX + RECTANGLE_OFFSET);
             centerSymbolVertically(*signLetters, 0);
 
@@ -324,7 +316,7 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
                     RECTANGLE_OFFSET);
 
             auto signText =
-                new SimpleTextItem(shortenedSignText, myRehearsalSignFont, TextAlignment::Top, QPen(myPalette.text().color()));
+                new SimpleTextItem(shortenedSignText, myRehearsalSignFont, TextAlignment::Top);
             signText->setX(signTextX);
             centerSymbolVertically(*signText, 0);
             // The tooltip should contain the full description.
@@ -361,17 +353,19 @@ void SystemRenderer::drawTabNotes(const Staff &staff,
                 const QString text =
                     QString::fromStdString(Util::toString(note));
 
-                auto tabNote = new SimpleTextItem(
-                    text, myPlainTextFont, TextAlignment::Top,
-                    QPen(note.hasProperty(Note::Tied) ? myPalette.dark().color()
-                                                      : myPalette.text().color()),
-                    QBrush(myPalette.light().color()));
-
-                centerHorizontally(*tabNote, location,
-                                   location + layout->getPositionSpacing());
-                tabNote->setY(layout->getTabLine(note.getString() + 1) -
-                              0.6 * myPlainTextFont.pixelSize());
-                tabNote->setParentItem(myParentStaff);
+                // Center the fret number horizontally within the position.
+                const double width =
+                    GlyphCache::get(myPlainTextFont, text)->myLineRect.width();
+                const double x =
+                    location + 0.5 * (layout->getPositionSpacing() - width);
+                const double y = layout->getTabLine(note.getString() + 1) -
+                                 0.6 * myPlainTextFont.pixelSize();
+
+                myParentStaff->addText(
+                    QPointF(x, y), text, myPlainTextFont, TextAlignment::Top,
+                    note.hasProperty(Note::Tied) ? ScoreColor::Muted
+                                                 : ScoreColor::Default,
+                    ScoreColor::Background);
             }
 
             // Draw arpeggios if necessary.
@@ -402,7 +396,7 @@ void SystemRenderer::drawArpeggio(const Position &position, double x,
     const int numSymbols = height / symbolWidth;
 
     auto arpeggio = new SimpleTextItem(QString(numSymbols, arpeggioSymbol),
-                                       myMusicNotationFont, TextAlignment::Top ,QPen(myPalette.text().color()));
+                                       myMusicNotationFont, TextAlignment::Top);
     arpeggio->setPos(x + arpeggio->boundingRect().height() / 2.0 - 3.0, top);
     arpeggio->setRotation(90);
     arpeggio->setParentItem(myParentStaff);
@@ -412,7 +406,7 @@ void SystemRenderer::drawArpeggio(const Position &position, double x,
                 MusicFont::ArpeggioUp : MusicFont::ArpeggioDown;
 
     auto endPoint = new SimpleTextItem(arpeggioEnd, myMusicNotationFont,
-                                       TextAlignment::Top, QPen(myPalette.text().color()));
+                                       TextAlignment::Top);
     const double y = position.hasProperty(Position::ArpeggioUp) ? top : bottom;
     endPoint->setPos(x, y - 1.45 * myMusicNotationFont.pixelSize());
     endPoint->setParentItem(myParentStaff);
@@ -472,10 +466,10 @@ void SystemRenderer::drawSystemSymbols(const System &system,
 
 void SystemRenderer::drawDividerLine(double y)
 {
-    auto line = new QGraphicsLineItem();
+    auto line = new ThemedItem<QGraphicsLineItem>(ScoreColor::Default);
     line->setLine(0, y, LayoutInfo::STAFF_WIDTH, y);
     line->setOpacity(0.5);
-    line->setPen(QPen(myPalette.text(), 0.5, Qt::DashLine));
+    line->setPen(makeThemedPen(0.5, Qt::DashLine));
 
     line->setParentItem(myParentSystem);
 }
@@ -493,16 +487,15 @@ void SystemRenderer::drawAlternateEndings(const System &system,
                                 0.5 * layout.getPositionSpacing();
 
         // Draw the vertical line.
-        auto vertLine = new QGraphicsLineItem();
+        auto vertLine = new ThemedItem<QGraphicsLineItem>(ScoreColor::Default);
         vertLine->setLine(0, TOP_LINE_OFFSET, 0,
                           LayoutInfo::SYSTEM_SYMBOL_SPACING - TOP_LINE_OFFSET);
         vertLine->setPos(location, height);
-        vertLine->setPen(myPalette.text().color());
         vertLine->setParentItem(myParentSystem);
 
         // Draw the text indicating the repeat numbers.
         auto text = new SimpleTextItem(
-            QString::fromStdString(Util::toString(ending)), myPlainTextFont, TextAlignment::Top ,QPen(myPalette.text().color()));
+            QString::fromStdString(Util::toString(ending)), myPlainTextFont, TextAlignment::Top);
         text->setPos(location + TEXT_PADDING, height + TEXT_PADDING / 2.0);
         text->setParentItem(myParentSystem);
 
@@ -532,10 +525,9 @@ void SystemRenderer::drawAlternateEndings(const System &system,
         // Ensure that the line doesn't extend past the edge of the system.
         endX = std::clamp(endX, 0.0, LayoutInfo::STAFF_WIDTH);
 
-        auto horizLine = new QGraphicsLineItem();
+        auto horizLine = new ThemedItem<QGraphicsLineItem>(ScoreColor::Default);
         horizLine->setLine(0, TOP_LINE_OFFSET, endX - location, TOP_LINE_OFFSET);
         horizLine->setPos(location, height);
-        horizLine->setPen(myPalette.text().color());
         horizLine->setParentItem(myParentSystem);
     }
 }
@@ -641,23 +633,10 @@ void SystemRenderer::drawTempoMarkers(const System &system,
             // Add the beat type image.
             QFontMetricsF fm(font);
             QPixmap image(getBeatTypeImage(tempo.getBeatType()));
-
-            //set the color of the beat type image according to theme
-            QImage tmp = image.toImage();
-            QColor color(myPalette.text().color());
-            for(int y = 0; y < tmp.height(); y++)
-            {
-                for(int x= 0; x < tmp.width(); x++)
-                {
-                    color.setAlpha(tmp.pixelColor(x,y).alpha());
-                    tmp.setPixelColor(x,y,color);
-                }
-            }
-            image = QPixmap::fromImage(tmp);
-
-            auto pixmap = new QGraphicsPixmapItem(image.scaled(
-                fm.width(imageSpacing), NOTE_HEIGHT,
-                Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+            auto pixmap = new ThemedPixmapItem(
+                ScoreColor::Default,
+                image.scaled(fm.width(imageSpacing), NOTE_HEIGHT,
+                             Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
             pixmap->setX(fm.width(text));
             centerSymbolVertically(*pixmap, height);
             group->addToGroup(pixmap);
@@ -669,9 +648,11 @@ void SystemRenderer::drawTempoMarkers(const System &system,
             {
                 // Add the second beat type image.
                 QPixmap image(getBeatTypeImage(tempo.getListessoBeatType()));
-                auto pixmap = new QGraphicsPixmapItem(image.scaled(
-                    fm.width(imageSpacing), NOTE_HEIGHT,
-                    Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+                auto pixmap = new ThemedPixmapItem(
+                    ScoreColor::Default,
+                    image.scaled(fm.width(imageSpacing), NOTE_HEIGHT,
+                                 Qt::IgnoreAspectRatio,
+                                 Qt::SmoothTransformation));
                 pixmap->setX(fm.width(text));
                 centerSymbolVertically(*pixmap, height);
                 group->addToGroup(pixmap);
@@ -688,9 +669,11 @@ void SystemRenderer::drawTempoMarkers(const System &system,
 
                 const QString imageSpacing(12, ' ');
                 QPixmap image(getTripletFeelImage(tempo));
-                pixmap = new QGraphicsPixmapItem(image.scaled(
-                    fm.width(imageSpacing), 21,
-                    Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+                pixmap = new ThemedPixmapItem(
+                    ScoreColor::Default,
+                    image.scaled(fm.width(imageSpacing), 21,
+                                 Qt::IgnoreAspectRatio,
+                                 Qt::SmoothTransformation));
                 pixmap->setX(fm.width(text));
                 centerSymbolVertically(*pixmap, height);
                 group->addToGroup(pixmap);
@@ -699,7 +682,7 @@ void SystemRenderer::drawTempoMarkers(const System &system,
             }
         }
 
-        auto textItem = new SimpleTextItem(text, font, TextAlignment::Top ,QPen(myPalette.text().color()));
+        auto textItem = new SimpleTextItem(text, font, TextAlignment::Top);
         centerSymbolVertically(*textItem, height);
         group->addToGroup(textItem);
 
@@ -717,7 +700,7 @@ void SystemRenderer::drawChordText(const System &system,
         const std::string text = Util::toString(chord.getChordName());
 
         auto textItem =
-            new SimpleTextItem(QString::fromStdString(text), myPlainTextFont, TextAlignment::Top, QPen(myPalette.text().color()));
+            new SimpleTextItem(QString::fromStdString(text), myPlainTextFont, TextAlignment::Top);
         textItem->setX(x);
         centerSymbolVertically(*textItem, height);
         textItem->setParentItem(myParentSystem);
@@ -733,10 +716,10 @@ void SystemRenderer::drawTextItems(const System &system,
 
         // Note: the SimpleTextItem class is not used here since multi-line
         // support is needed.
-        auto text_item = new QGraphicsSimpleTextItem();
+        auto text_item =
+            new ThemedItem<QGraphicsSimpleTextItem>(ScoreColor::Default);
         text_item->setFont(myPlainTextFont);
         text_item->setText(contents);
-        text_item->setBrush(myPalette.text());
 
         text_item->setX(layout.getPositionX(text.getPosition()));
         centerSymbolVertically(*text_item, height);
@@ -772,10 +755,9 @@ void SystemRenderer::drawRhythmSlashes()
             path.moveTo(xDiff, System::RHYTHM_SLASH_SPACING / 4.0);
             path.arcTo(0, 0, xDiff, System::RHYTHM_SLASH_SPACING / 2.0, 0, 180);
 
-            QGraphicsPathItem* arc = new QGraphicsPathItem(path);
+            auto arc = new ThemedItem<QGraphicsPathItem>(ScoreColor::Default, path);
             arc->setPos(prevSlash->x() + RhythmSlashPainter::STEM_OFFSET,
                         y + RhythmSlashPainter::NOTE_HEAD_OFFSET - arc->boundingRect().height());
-            arc->setPen(QPen(myPalette.text().color()));
             arc->setParentItem(parentSystem);
         }
     }
@@ -791,7 +773,7 @@ void SystemRenderer::drawRhythmSlashes()
 
 static QGraphicsItem *
 drawArc(const LayoutInfo &layout, const int string, const int start_pos,
-        const int end_pos, const QColor &color)
+        const int end_pos)
 {
     const double left = layout.getPositionX(start_pos);
     const double width = layout.getPositionX(end_pos) - left;
@@ -810,9 +792,8 @@ drawArc(const LayoutInfo &layout, const int string, const int start_pos,
     path.moveTo(width, height / 2);
     path.arcTo(0, 0, width, height, 0, 180);
 
-    auto arc = new AntialiasedPathItem(path);
+    auto arc = new AntialiasedPathItem(ScoreColor::Default, path);
     arc->setPos(left + layout.getPositionSpacing() / 2, y);
-    arc->setPen(QPen(color));
     return arc;
 }
 
@@ -842,8 +823,7 @@ void SystemRenderer::drawLegato(const Staff &staff, const LayoutInfo &layout)
                 else if (arcs.find(string) != arcs.end())
                 {
                     const int start_pos = arcs.find(string)->second;
-                    auto arc = drawArc(layout, string, start_pos, position,
-                                       myPalette.text().color());
+                    auto arc = drawArc(layout, string, start_pos, position);
                     arc->setParentItem(myParentStaff);
 
                     arcs.erase(arcs.find(string));
@@ -860,11 +840,11 @@ void SystemRenderer::drawLegato(const Staff &staff, const LayoutInfo &layout)
                     path.moveTo(width, height / 2);
                     path.arcTo(0, 0, width, height, 0, 180);
 
-                    auto arc = new AntialiasedPathItem(path);
+                    auto arc =
+                        new AntialiasedPathItem(ScoreColor::Default, path);
                     arc->setPos(layout.getPositionX(position) + 2,
                                 layout.getTabLine(string) - 2);
                     arc->setParentItem(myParentStaff);
-                    arc->setPen(myPalette.text().color());
 
                     if (arcs.find(string) != arcs.end())
                         arcs.erase(arcs.find(string));
@@ -877,8 +857,7 @@ void SystemRenderer::drawLegato(const Staff &staff, const LayoutInfo &layout)
         for (auto [string, start_pos] : arcs)
         {
             const int end_pos = layout.getNumPositions() - 1;
-            auto arc = drawArc(layout, string, start_pos, end_pos,
-                               myPalette.text().color());
+            auto arc = drawArc(layout, string, start_pos, end_pos);
             arc->setParentItem(myParentStaff);
         }
     }
@@ -908,7 +887,7 @@ void SystemRenderer::drawPlayerChanges(const System &system, int staffIndex,
         else
             description = QStringLiteral("(No Players)");
 
-        auto text = new SimpleTextItem(description, myPlainTextFont, TextAlignment::Top,QPen(myPalette.text().color()));
+        auto text = new SimpleTextItem(description, myPlainTextFont, TextAlignment::Top);
         text->setPos(layout.getPositionX(change.getPosition()),
                      layout.getBottomStdNotationLine() +
                      LayoutInfo::STAFF_BORDER_SPACING +
@@ -1006,10 +985,9 @@ void SystemRenderer::drawSlide(const LayoutInfo &layout, int string,
     path.moveTo(0, 0);
     path.lineTo(width - layout.getPositionSpacing() / 2, height);
 
-    auto slide = new AntialiasedPathItem(path);
+    auto slide = new AntialiasedPathItem(ScoreColor::Default, path);
     slide->setPos(left + layout.getPositionSpacing() / 1.5 + 1,
                   y + height / 2);
-    slide->setPen(QPen(myPalette.text().color()));
     slide->setParentItem(myParentStaff);
 }
 
@@ -1078,7 +1056,7 @@ void SystemRenderer::drawSymbolsBelowTabStaff(const LayoutInfo &layout)
 QGraphicsItem *SystemRenderer::createPickStroke(const QString &text)
 {
     auto textItem =
-	new SimpleTextItem(text, myMusicNotationFont, TextAlignment::Baseline ,QPen(myPalette.text().color()));
+	new SimpleTextItem(text, myMusicNotationFont, TextAlignment::Baseline);
     textItem->setPos(2, 2);
 
     // Sticking the text in a QGraphicsItemGroup allows us to offset the
@@ -1094,7 +1072,7 @@ QGraphicsItem *SystemRenderer::createPlainTextSymbol(const QString &text,
     myPlainTextFont.setStyle(style);
 
     auto textItem =
-	new SimpleTextItem(text, myPlainTextFont, TextAlignment::Top, QPen(myPalette.text().color()));
+	new SimpleTextItem(text, myPlainTextFont, TextAlignment::Top);
     textItem->setPos(0, -8);
 
     auto group = new QGraphicsItemGroup();
@@ -1280,7 +1258,7 @@ QGraphicsItem *SystemRenderer::createConnectedSymbolGroup(
 
     // Render the description (i.e. "let ring").
     auto description =
-        new SimpleTextItem(text, mySymbolTextFont, TextAlignment::Top, QPen(myPalette.text().color()));
+        new SimpleTextItem(text, mySymbolTextFont, TextAlignment::Top);
 
     auto group = new QGraphicsItemGroup();
     group->addToGroup(description);
@@ -1301,15 +1279,16 @@ QGraphicsItem *SystemRenderer::createConnectedSymbolGroup(
 void SystemRenderer::createDashedLine(QGraphicsItemGroup *group, double left,
                                       double right, double y)
 {
-    auto line = new QGraphicsLineItem(left, y, right, y);
-    line->setPen(QPen(myPalette.text().color(), 1, Qt::DashLine));
+    auto line = new ThemedItem<QGraphicsLineItem>(ScoreColor::Default, left,
+                                                  y, right, y);
+    line->setPen(makeThemedPen(1, Qt::DashLine));
     group->addToGroup(line);
 
     // Draw a vertical line at the end of the dotted lines.
-    auto lineEnd = new QGraphicsLineItem(
-        line->boundingRect().right(), y, line->boundingRect().right(),
+    auto lineEnd = new ThemedItem<QGraphicsLineItem>(
+        ScoreColor::Default, line->boundingRect().right(), y,
+        line->boundingRect().right(),
         y + 0.5 * LayoutInfo::TAB_SYMBOL_SPACING);
-    lineEnd->setPen(QPen(myPalette.text().color()));
     group->addToGroup(lineEnd);
 }
 
@@ -1337,9 +1316,7 @@ SystemRenderer::createVolumeSwell(const SymbolGroup &group,
     path.lineTo(start_x, LayoutInfo::TAB_SYMBOL_SPACING * 0.5);
     path.lineTo(end_x, (1.0 - padding) * LayoutInfo::TAB_SYMBOL_SPACING);
 
-    auto path_item = new QGraphicsPathItem(path);
-    path_item->setPen(myPalette.text().color());
-    return path_item;
+    return new ThemedItem<QGraphicsPathItem>(ScoreColor::Default, path);
 }
 
 QGraphicsItem *SystemRenderer::drawContinuousFontSymbols(QChar symbol,
@@ -1347,9 +1324,10 @@ QGraphicsItem *SystemRenderer::drawContinuousFontSymbols(QChar symbol,
 {
     QFont font = MusicFont::getFont(25);
 
-    const double symbolWidth = QFontMetricsF(font).width(symbol);
+    const double symbolWidth =
+        GlyphCache::get(font, symbol)->myLineRect.width();
     const int numSymbols = width / symbolWidth;
-    auto text = new SimpleTextItem(QString(numSymbols, symbol), font, TextAlignment::Baseline, QPen(myPalette.text().color()));
+    auto text = new SimpleTextItem(QString(numSymbols, symbol), font, TextAlignment::Baseline);
     text->setPos(0, 0.5 * LayoutInfo::TAB_SYMBOL_SPACING);
 
     // A bit of a hack for getting around the height offset caused by the
@@ -1369,7 +1347,7 @@ QGraphicsItem *SystemRenderer::createTremoloPicking(const LayoutInfo& layout)
     {
         auto line =
             new SimpleTextItem(QChar(MusicFont::TremoloPicking),
-                                       myMusicNotationFont, TextAlignment::Baseline ,QPen(myPalette.text().color()));
+                                       myMusicNotationFont, TextAlignment::Baseline);
         centerHorizontally(*line, 0, layout.getPositionSpacing() * 1.25);
         line->setY(-7 + i * offset);
         group->addToGroup(line);
@@ -1383,7 +1361,7 @@ QGraphicsItem *SystemRenderer::createTrill(const LayoutInfo& layout)
     QFont font(MusicFont::getFont(21));
 
     auto text = new SimpleTextItem(QChar(MusicFont::Trill), font,
-                                   TextAlignment::Baseline, QPen(myPalette.text().color()));
+                                   TextAlignment::Baseline);
     centerHorizontally(*text, 0, layout.getPositionSpacing());
     text->setY(0.5 * LayoutInfo::TAB_SYMBOL_SPACING);
 
@@ -1427,7 +1405,7 @@ QGraphicsItem *SystemRenderer::createDynamic(const Dynamic &dynamic)
     }
 
     auto textItem =
-	new SimpleTextItem(text, myMusicNotationFont, TextAlignment::Baseline, QPen(myPalette.text().color()));
+	new SimpleTextItem(text, myMusicNotationFont, TextAlignment::Baseline);
     textItem->setY(0.5 * LayoutInfo::TAB_SYMBOL_SPACING);
 
     // Sticking the text in a QGraphicsItemGroup allows us to offset the
@@ -1472,19 +1450,20 @@ void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
 
     QFont default_font(MusicFont::getFont(MusicFont::DEFAULT_FONT_SIZE));
     QFont grace_font(MusicFont::getFont(MusicFont::GRACE_NOTE_SIZE));
-    QFontMetricsF default_fm(default_font);
-    QFontMetricsF grace_fm(grace_font);
+
+    auto getWidth = [](const QFont &font, const QString &text) {
+        return GlyphCache::get(font, text)->myLineRect.width();
+    };
 
     for (const StdNotationNote &note : notes)
     {
         const QFont *font = note.isGraceNote() ? &grace_font : &default_font;
-        const QFontMetricsF *fm = note.isGraceNote() ? &grace_fm : &default_fm;
 
         const QChar note_head_char = note.getNoteHeadSymbol();
-        const double note_head_width = fm->width(note_head_char);
+        const double note_head_width = getWidth(*font, note_head_char);
 
         const QString accidental_text = note.getAccidentalText();
-        const double accidental_width = fm->width(accidental_text);
+        const double accidental_width = getWidth(*font, accidental_text);
 
         const double x = layout.getPositionX(note.getPosition()) +
                 0.5 * (layout.getPositionSpacing() - note_head_width) -
@@ -1492,37 +1471,26 @@ void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
         const double y = note.getY() + layout.getTopStdNotationLine();
         const QString note_text = accidental_text + note_head_char;
 
-        QGraphicsItemGroup *group = nullptr;
-        auto text_item =
-            new SimpleTextItem(note_text, *font, TextAlignment::Baseline, QPen(myPalette.text().color()));
+        myParentStaff->addText(QPointF(x, y), note_text, *font,
+                               TextAlignment::Baseline);
 
         if (note.isDotted() || note.isDoubleDotted())
         {
-            group = new QGraphicsItemGroup();
-            const double dotX = fm->width(note_text) + 2;
+            const double dotX = x + getWidth(*font, note_text) + 2;
 
             const QChar dot(MusicFont::Dot);
-            auto dotText =
-		    new SimpleTextItem(dot, *font, TextAlignment::Baseline ,QPen(myPalette.text().color()));
-            dotText->setPos(dotX, 0);
-            group->addToGroup(dotText);
+            myParentStaff->addText(QPointF(dotX, y), dot, *font,
+                                   TextAlignment::Baseline);
 
             if (note.isDoubleDotted())
             {
-                auto dotText2 =
-		    new SimpleTextItem(dot, *font, TextAlignment::Baseline, QPen(myPalette.text().color()));
-                dotText2->setPos(dotX + 4, 0);
-                group->addToGroup(dotText2);
+                myParentStaff->addText(QPointF(dotX + 4, y), dot, *font,
+                                       TextAlignment::Baseline);
             }
         }
 
         if (note.getNote()->hasLeftHandFingering())
         {
-            if (!group)
-            {
-                group = new QGraphicsItemGroup();
-            }
-
             const auto &fingering = note.getNote()->getLeftHandFingering();
             auto finger = fingering.getFinger();
 
@@ -1532,8 +1500,6 @@ void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
             else
                 finger_text = QString::number(static_cast<int>(finger));
 
-            auto item = new SimpleTextItem(finger_text, myPlainTextFont, TextAlignment::Baseline, QPen(myPalette.text().color()));
-
             static const double y_left = -note_head_width - 1;
             static const double y_right = note_head_width + 3;
             static constexpr double y_above = -4;
@@ -1576,20 +1542,9 @@ void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
                     break;
             }
 
-            item->setPos(numberX, numberY);
-            group->addToGroup(item);
-        }
-
-        if (group)
-        {
-            group->addToGroup(text_item);
-            group->setPos(x, y);
-            group->setParentItem(myParentStaff);
-        }
-        else
-        {
-            text_item->setPos(x, y);
-            text_item->setParentItem(myParentStaff);
+            myParentStaff->addText(QPointF(x + numberX, y + numberY),
+                                   finger_text, myPlainTextFont,
+                                   TextAlignment::Baseline);
         }
 
         const int position = note.getPosition();
@@ -1611,7 +1566,7 @@ void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
         for (const BeamGroup &group : beamGroups)
         {
             group.drawStems(myParentStaff, stems, myMusicNotationFont,
-                            myPalette.text().color(), layout);
+                            ScoreColor::Default, layout);
         }
 
         const Voice &voice = staff.getVoices()[v];
@@ -1655,9 +1610,8 @@ void SystemRenderer::drawTies(const Voice &voice,
                               ? -1.25 * LayoutInfo::STD_NOTATION_LINE_SPACING
                               : 0.25 * LayoutInfo::STD_NOTATION_LINE_SPACING);
 
-        auto arc = new AntialiasedPathItem(path);
+        auto arc = new AntialiasedPathItem(ScoreColor::Default, path);
         arc->setPos(prevX, y);
-        arc->setPen(QPen(myPalette.text().color()));
         arc->setParentItem(myParentStaff);
     }
 }
@@ -1714,11 +1668,11 @@ void SystemRenderer::drawIrregularGroups(const Voice &voice,
         font.setItalic(true);
         font.setPixelSize(18);
 
-        QFontMetricsF fm(font);
-        const double textWidth = fm.width(text);
+        const double textWidth =
+            GlyphCache::get(font, text)->myLineRect.width();
         const double centreX = leftX + (rightX - (leftX + textWidth)) / 2.0;
 
-        auto textItem = new SimpleTextItem(text, font, TextAlignment::Top, QPen(myPalette.text().color()));
+        auto textItem = new SimpleTextItem(text, font, TextAlignment::Top);
         textItem->setPos(centreX, y2 - font.pixelSize());
         textItem->setParentItem(myParentStaff);
 
@@ -1727,25 +1681,21 @@ void SystemRenderer::drawIrregularGroups(const Voice &voice,
 
         // Draw the two horizontal line segments across the group, and the two
         // vertical lines on either end.
-        QGraphicsLineItem *horizLine1 = new QGraphicsLineItem();
+        auto horizLine1 = new ThemedItem<QGraphicsLineItem>(ScoreColor::Default);
         horizLine1->setLine(leftX, y2, leftX + lineWidth, y2);
-        horizLine1->setPen(QPen(myPalette.text().color()));
         horizLine1->setParentItem(myParentStaff);
 
-        QGraphicsLineItem *horizLine2 = new QGraphicsLineItem();
+        auto horizLine2 = new ThemedItem<QGraphicsLineItem>(ScoreColor::Default);
         horizLine2->setLine(rightX - lineWidth, y2, rightX, y2);
         horizLine2->setParentItem(myParentStaff);
-        horizLine2->setPen(QPen(myPalette.text().color()));
 
-        QGraphicsLineItem *vertLine1 = new QGraphicsLineItem();
+        auto vertLine1 = new ThemedItem<QGraphicsLineItem>(ScoreColor::Default);
         vertLine1->setLine(leftX, y1, leftX, y2);
         vertLine1->setParentItem(myParentStaff);
-        vertLine1->setPen(QPen(myPalette.text().color()));
 
-        QGraphicsLineItem *vertLine2 = new QGraphicsLineItem();
+        auto vertLine2 = new ThemedItem<QGraphicsLineItem>(ScoreColor::Default);
         vertLine2->setLine(rightX, y1, rightX, y2);
         vertLine2->setParentItem(myParentStaff);
-        vertLine2->setPen(QPen(myPalette.text().color()));
 
     }
 }
@@ -1768,31 +1718,29 @@ void SystemRenderer::drawMultiBarRest(const System &system,
 
     // Draw the measure count.
     auto measureCountText =
-        new SimpleTextItem(QString::number(measureCount), myMusicNotationFont, TextAlignment::Baseline, QPen(myPalette.text().color()));
+        new SimpleTextItem(QString::number(measureCount), myMusicNotationFont, TextAlignment::Baseline);
 
     centerHorizontally(*measureCountText, leftX, rightX);
     measureCountText->setY(layout.getTopStdNotationLine());
     measureCountText->setParentItem(myParentStaff);
 
     // Draw symbol across std. notation staff.
-    auto vertLineLeft =
-        new QGraphicsLineItem(leftX, layout.getStdNotationLine(2), leftX,
-                              layout.getStdNotationLine(4));
-    vertLineLeft->setPen(myPalette.text().color());
+    auto vertLineLeft = new ThemedItem<QGraphicsLineItem>(
+        ScoreColor::Default, leftX, layout.getStdNotationLine(2), leftX,
+        layout.getStdNotationLine(4));
     vertLineLeft->setParentItem(myParentStaff);
 
-    auto vertLineRight =
-        new QGraphicsLineItem(rightX, layout.getStdNotationLine(2), rightX,
-                              layout.getStdNotationLine(4));
-    vertLineRight->setPen(myPalette.text().color());
+    auto vertLineRight = new ThemedItem<QGraphicsLineItem>(
+        ScoreColor::Default, rightX, layout.getStdNotationLine(2), rightX,
+        layout.getStdNotationLine(4));
     vertLineRight->setParentItem(myParentStaff);
 
-    auto horizontalLine = new QGraphicsRectItem(
-        leftX, layout.getStdNotationLine(2) +
-                   0.5 * LayoutInfo::STD_NOTATION_LINE_SPACING,
+    auto horizontalLine = new ThemedItem<QGraphicsRectItem>(
+        ScoreColor::Default, leftX,
+        layout.getStdNotationLine(2) +
+            0.5 * LayoutInfo::STD_NOTATION_LINE_SPACING,
         rightX - leftX, LayoutInfo::STD_NOTATION_LINE_SPACING * 0.9);
 
-    horizontalLine->setPen(myPalette.text().color());
     horizontalLine->setParentItem(myParentStaff);
 }
 
@@ -1831,10 +1779,10 @@ SystemRenderer::drawRest(const Position &pos, double x,
             break;
     }
 
-    auto group = new QGraphicsItemGroup();
-    auto text = new SimpleTextItem(symbol, font, TextAlignment::Baseline, QPen(myPalette.text().color()));
-    text->setPos(0, y);
-    group->addToGroup(text);
+    // Record the offset of each symbol from the rest's origin, along with
+    // the total bounds, so that they can be centered as a group.
+    std::vector<std::pair<QChar, QPointF>> symbols;
+    symbols.emplace_back(symbol, QPointF(0, y));
 
     // Draw dots if necessary.
     const QChar dot = MusicFont::Dot;
@@ -1845,22 +1793,25 @@ SystemRenderer::drawRest(const Position &pos, double x,
     if (pos.hasProperty(Position::Dotted) ||
         pos.hasProperty(Position::DoubleDotted))
     {
-        auto dotText = new SimpleTextItem(dot, font, TextAlignment::Baseline, QPen(myPalette.text().color()));
-        dotText->setPos(dotX, dotY);
-        group->addToGroup(dotText);
+        symbols.emplace_back(dot, QPointF(dotX, dotY));
 
         if (pos.hasProperty(Position::DoubleDotted))
-        {
-            auto dotText2 =
-		    new SimpleTextItem(dot, font, TextAlignment::Baseline, QPen(myPalette.text().color()));
-            dotText2->setPos(dotX + 4, dotY);
-            group->addToGroup(dotText2);
-        }
+            symbols.emplace_back(dot, QPointF(dotX + 4, dotY));
     }
 
-    centerHorizontally(*group, x, x + layout.getPositionSpacing() * 1.25);
+    QRectF bounds;
+    for (auto &&[text, offset] : symbols)
+        bounds |= GlyphCache::get(font, text)->myBounds.translated(offset);
 
-    group->setParentItem(myParentStaff);
+    const double xmin = x;
+    const double xmax = x + layout.getPositionSpacing() * 1.25;
+    const double left = xmin + ((xmax - (xmin + bounds.width())) / 2);
+
+    for (auto &&[text, offset] : symbols)
+    {
+        myParentStaff->addText(offset + QPointF(left, 0), text, font,
+                               TextAlignment::Baseline);
+    }
 }
 
 void SystemRenderer::drawLedgerLines(
@@ -1915,9 +1866,7 @@ void SystemRenderer::drawLedgerLines(
         }
     }
 
-    auto ledgerlines = new QGraphicsPathItem(path);
-    ledgerlines->setPen(QPen(myPalette.text().color()));
-    ledgerlines->setParentItem(myParentStaff);
+    myParentStaff->addPath(path);
 }
 
 static double getBendHeight(Bend::DrawPoint point, const Note &note,
@@ -1955,8 +1904,7 @@ void SystemRenderer::createBend(QGraphicsItemGroup *group, double left,
         path.lineTo(right, yEnd);
     }
 
-    auto bendPath = new AntialiasedPathItem(path);
-    bendPath->setPen(QPen(myPalette.text().color()));
+    auto bendPath = new AntialiasedPathItem(ScoreColor::Default, path);
     group->addToGroup(bendPath);
 
     // Draw arrow head, and choose the correct orientation depending on whether
@@ -1968,9 +1916,9 @@ void SystemRenderer::createBend(QGraphicsItemGroup *group, double left,
                << QPointF(right, (yEnd < yStart) ? yEnd - ARROW_WIDTH
                                                  : yEnd + ARROW_WIDTH);
 
-    auto *arrow = new QGraphicsPolygonItem(arrowShape);
-    arrow->setBrush(myPalette.text());
-    arrow->setPen(myPalette.text().color());
+    auto arrow = new ThemedItem<QGraphicsPolygonItem>(ScoreColor::Default,
+                                                      arrowShape);
+    arrow->setBrushColor(ScoreColor::Default);
     group->addToGroup(arrow);
 
     // Draw text for the bent pitch (e.g. "Full", "3/4", etc). Don't draw the
@@ -1980,7 +1928,7 @@ void SystemRenderer::createBend(QGraphicsItemGroup *group, double left,
         mySymbolTextFont.setStyle(QFont::StyleNormal);
         auto bendText = new SimpleTextItem(
             QString::fromStdString(Bend::getPitchText(pitch)),
-            mySymbolTextFont, TextAlignment::Top, QPen(myPalette.text().color()));
+            mySymbolTextFont, TextAlignment::Top);
         bendText->setPos(right - 0.5 * bendText->boundingRect().width(),
                          yEnd - 1.75 * mySymbolTextFont.pixelSize());
         group->addToGroup(bendText);
@@ -2047,9 +1995,10 @@ QGraphicsItem *SystemRenderer::createBendGroup(const SymbolGroup &group,
             else if (type == Bend::GradualRelease)
             {
                 // Draw a dashed line to the original bend.
-                auto line = new QGraphicsLineItem(
-                    prevX, yStart, x + layout.getPositionSpacing(), yStart);
-                line->setPen(QPen(myPalette.text().color(), 1, Qt::DashLine));
+                auto line = new ThemedItem<QGraphicsLineItem>(
+                    ScoreColor::Default, prevX, yStart,
+                    x + layout.getPositionSpacing(), yStart);
+                line->setPen(makeThemedPen(1, Qt::DashLine));
                 itemGroup->addToGroup(line);
 
                 // Draw the bend down to the new pitch.
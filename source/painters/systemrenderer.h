@@ -19,29 +19,34 @@
 #define PAINTERS_SYSTEMRENDERER_H
 
 #include <map>
+#include <memory>
 #include <painters/layoutinfo.h>
 #include <painters/musicfont.h>
 #include <QFontMetricsF>
 #include <score/staff.h>
-#include <QPalette>
 
+class ClickPubSub;
 class QGraphicsItem;
 class QGraphicsItemGroup;
 class QGraphicsRectItem;
 class Score;
-class ScoreArea;
 class ScoreLocation;
+class StaffPainter;
 class System;
 class ViewOptions;
 
 class SystemRenderer
 {
 public:
-    SystemRenderer(const ScoreArea *score_area, const Score &score,
-                   const ViewOptions &view_options);
+    SystemRenderer(std::shared_ptr<ClickPubSub> click_pubsub,
+                   const Score &score, const ViewOptions &view_options);
 
     QGraphicsItem *operator()(const System &system, int systemIndex);
 
+    /// Returns the layout for each staff in the most recently rendered
+    /// system. Staves that were hidden by the view filter have no layout.
+    const std::vector<LayoutConstPtr> &getLayouts() const { return myLayouts; }
+
 private:
     /// Draws the tab clef.
     void drawTabClef(double x, const LayoutInfo &layout,
@@ -194,21 +199,19 @@ private:
     void drawSlide(const LayoutInfo &layout, int string, bool slideUp,
                    int position1, int position2) const;
 
-    const ScoreArea *myScoreArea;
+    const std::shared_ptr<ClickPubSub> myClickPubSub;
     const Score &myScore;
     const ViewOptions &myViewOptions;
 
     QGraphicsRectItem *myParentSystem;
-    QGraphicsItem *myParentStaff;
+    StaffPainter *myParentStaff;
+    std::vector<LayoutConstPtr> myLayouts;
 
     QFont myMusicNotationFont;
     QFontMetricsF myMusicFontMetrics;
     QFont myPlainTextFont;
     QFont mySymbolTextFont;
     QFont myRehearsalSignFont;
-
-    QPalette myPalette;
-
 };
 
 #endif
@@ -0,0 +1,48 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "themeditem.h"
+
+#include <QImage>
+
+ThemedPixmapItem::ThemedPixmapItem(ScoreColor color, const QPixmap &pixmap)
+    : QGraphicsPixmapItem(pixmap), myColor(color)
+{
+}
+
+void ThemedPixmapItem::paint(QPainter *painter,
+                             const QStyleOptionGraphicsItem *, QWidget *)
+{
+    const QColor color = getScoreColor(*this, myColor);
+
+    // Only recolor the pixmap when the palette changes.
+    if (myColoredImage.isNull() || color != myImageColor)
+    {
+        myColoredImage = pixmap().toImage().convertToFormat(
+            QImage::Format_ARGB32_Premultiplied);
+
+        QPainter image_painter(&myColoredImage);
+        image_painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+        image_painter.fillRect(myColoredImage.rect(), color);
+        image_painter.end();
+
+        myImageColor = color;
+    }
+
+    painter->drawImage(offset(), myColoredImage);
+}
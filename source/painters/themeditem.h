@@ -0,0 +1,134 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PAINTERS_THEMEDITEM_H
+#define PAINTERS_THEMEDITEM_H
+
+#include <painters/scorecolor.h>
+#include <QGraphicsLineItem>
+#include <QGraphicsPathItem>
+#include <QGraphicsPixmapItem>
+#include <QGraphicsPolygonItem>
+#include <QGraphicsRectItem>
+#include <QGraphicsSimpleTextItem>
+#include <QImage>
+#include <QPainter>
+#include <utility>
+
+namespace ThemedItemDetail
+{
+inline void draw(QPainter &painter, const QGraphicsLineItem &item)
+{
+    painter.drawLine(item.line());
+}
+
+inline void draw(QPainter &painter, const QGraphicsPathItem &item)
+{
+    painter.drawPath(item.path());
+}
+
+inline void draw(QPainter &painter, const QGraphicsRectItem &item)
+{
+    painter.drawRect(item.rect());
+}
+
+inline void draw(QPainter &painter, const QGraphicsPolygonItem &item)
+{
+    painter.drawPolygon(item.polygon(), item.fillRule());
+}
+
+inline void draw(QPainter &painter, const QGraphicsSimpleTextItem &item)
+{
+    // The text is drawn with the pen's color, rather than being filled with
+    // the brush.
+    painter.setPen(painter.pen().color());
+    painter.setFont(item.font());
+    painter.drawText(item.boundingRect(), Qt::AlignLeft | Qt::AlignTop,
+                     item.text());
+}
+} // namespace ThemedItemDetail
+
+/// Wraps one of Qt's standard items (lines, paths, rectangles, etc) so that
+/// its colors are looked up from the scene's palette when it is painted. The
+/// color of the item's pen is ignored, but its width and style are used.
+template <typename Item>
+class ThemedItem : public Item
+{
+public:
+    template <typename... Args>
+    explicit ThemedItem(ScoreColor pen_color, Args &&... args)
+        : Item(std::forward<Args>(args)...),
+          myPenColor(pen_color),
+          myBrushColor(ScoreColor::None)
+    {
+    }
+
+    /// Fills in the item's shape with the color.
+    void setBrushColor(ScoreColor color)
+    {
+        myBrushColor = color;
+        this->update();
+    }
+
+    virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
+                       QWidget *) override
+    {
+        QPen pen = this->pen();
+        pen.setColor(getScoreColor(*this, myPenColor));
+        painter->setPen(pen);
+
+        if (myBrushColor == ScoreColor::None)
+            painter->setBrush(Qt::NoBrush);
+        else
+            painter->setBrush(getScoreColor(*this, myBrushColor));
+
+        ThemedItemDetail::draw(*painter, *this);
+    }
+
+private:
+    ScoreColor myPenColor;
+    ScoreColor myBrushColor;
+};
+
+/// Creates a pen for a themed item. The color is filled in when painting.
+inline QPen makeThemedPen(double width, Qt::PenStyle style = Qt::SolidLine,
+                          Qt::PenCapStyle cap = Qt::SquareCap)
+{
+    return QPen(QBrush(), width, style, cap);
+}
+
+/// Draws a pixmap (e.g. a symbol that isn't available in the music font)
+/// using a color from the scene's palette, keeping only its transparency.
+class ThemedPixmapItem : public QGraphicsPixmapItem
+{
+public:
+    ThemedPixmapItem(ScoreColor color, const QPixmap &pixmap);
+
+    virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
+                       QWidget *) override;
+
+private:
+    const ScoreColor myColor;
+    /// The pixmap filled with the color that it was last painted with. This
+    /// is drawn as an image rather than a pixmap, so that recordings of the
+    /// item (see ScoreExporter) can be played back from other threads.
+    QImage myColoredImage;
+    QColor myImageColor;
+};
+
+#endif
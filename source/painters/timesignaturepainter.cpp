@@ -19,6 +19,7 @@
 
 #include <app/pubsub/clickpubsub.h>
 #include <painters/musicfont.h>
+#include <painters/scorecolor.h>
 #include <QCursor>
 #include <QPainter>
 #include <score/timesignature.h>
@@ -46,6 +47,8 @@ void TimeSignaturePainter::mouseReleaseEvent(QGraphicsSceneMouseEvent *)
 void TimeSignaturePainter::paint(QPainter *painter,
                                  const QStyleOptionGraphicsItem *, QWidget *)
 {
+    painter->setPen(getScoreColor(*this, ScoreColor::Default));
+
     const TimeSignature::MeterType meterType = myTimeSignature.getMeterType();
     if (meterType == TimeSignature::CommonTime ||
         meterType == TimeSignature::CutTime)
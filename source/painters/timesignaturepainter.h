@@ -22,9 +22,9 @@
 #include <painters/layoutinfo.h>
 #include <QGraphicsItem>
 #include <score/scorelocation.h>
+#include <score/timesignature.h>
 
 class ClickPubSub;
-class TimeSignature;
 
 class TimeSignaturePainter : public QGraphicsItem
 {
@@ -52,7 +52,7 @@ private:
     void drawNumber(QPainter* painter, const double y, const int number) const;
 
     LayoutConstPtr myLayout;
-    const TimeSignature &myTimeSignature;
+    const TimeSignature myTimeSignature;
     const ScoreLocation myLocation;
     std::shared_ptr<ClickPubSub> myPubSub;
     const QRectF myBounds;
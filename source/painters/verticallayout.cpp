@@ -19,12 +19,134 @@
 
 #include <algorithm>
 
+/// The number of positions above which the segment tree is used. Below this,
+/// scanning the range of each box is faster, even for boxes that span a
+/// quarter of the layout.
+static const int DENSE_MAX_SIZE = 1024;
+
 int VerticalLayout::addBox(int left, int right, int height)
 {
-    heights.resize(std::max<size_t>(heights.size(), right + 1));
-    const int newHeight =
-        *std::max_element(heights.begin() + left, heights.begin() + right) +
-        height;
-    std::fill_n(heights.begin() + left, right - left, newHeight);
+    const int size = std::max(left, right) + 1;
+    if (mySize == 0 && size <= DENSE_MAX_SIZE)
+        return addDenseBox(left, right, height);
+
+    reserve(size);
+
+    // An empty range just stacks on top of the existing height at that
+    // position.
+    if (right <= left)
+        return getMaxHeight(left, left + 1) + height;
+
+    const int newHeight = getMaxHeight(left, right) + height;
+
+    // Record the box in the nodes that exactly cover the range, and then
+    // update their ancestors.
+    const int leftLeaf = left + mySize;
+    const int rightLeaf = right - 1 + mySize;
+    for (int l = leftLeaf, r = rightLeaf + 1; l < r; l /= 2, r /= 2)
+    {
+        if (l & 1)
+        {
+            myBoxHeights[l] = newHeight;
+            myMaxHeights[l] = newHeight;
+            ++l;
+        }
+        if (r & 1)
+        {
+            --r;
+            myBoxHeights[r] = newHeight;
+            myMaxHeights[r] = newHeight;
+        }
+    }
+
+    for (int l = leftLeaf / 2, r = rightLeaf / 2; l > 0; l /= 2, r /= 2)
+    {
+        myMaxHeights[l] = std::max(myMaxHeights[l], newHeight);
+        myMaxHeights[r] = std::max(myMaxHeights[r], newHeight);
+    }
+
+    return newHeight;
+}
+
+int VerticalLayout::addDenseBox(int left, int right, int height)
+{
+    const int size = std::max(left, right) + 1;
+    if (static_cast<int>(myHeights.size()) < size)
+        myHeights.resize(size, 0);
+
+    // An empty range just stacks on top of the existing height at that
+    // position.
+    if (right <= left)
+        return myHeights[left] + height;
+
+    const int newHeight = *std::max_element(myHeights.begin() + left,
+                                            myHeights.begin() + right) +
+                          height;
+    std::fill(myHeights.begin() + left, myHeights.begin() + right, newHeight);
+
     return newHeight;
 }
+
+int VerticalLayout::getMaxHeight(int left, int right) const
+{
+    int height = 0;
+
+    const int leftLeaf = left + mySize;
+    const int rightLeaf = right - 1 + mySize;
+    for (int l = leftLeaf, r = rightLeaf + 1; l < r; l /= 2, r /= 2)
+    {
+        if (l & 1)
+            height = std::max(height, myMaxHeights[l++]);
+        if (r & 1)
+            height = std::max(height, myMaxHeights[--r]);
+    }
+
+    // Include any boxes that cover a larger range.
+    for (int l = leftLeaf / 2, r = rightLeaf / 2; l > 0; l /= 2, r /= 2)
+        height = std::max({ height, myBoxHeights[l], myBoxHeights[r] });
+
+    return height;
+}
+
+void VerticalLayout::reserve(int size)
+{
+    if (size <= mySize)
+        return;
+
+    int newSize = std::max(mySize, DENSE_MAX_SIZE);
+    while (newSize < size)
+        newSize *= 2;
+
+    // Find the current height at each position by pushing the boxes down to
+    // the leaves.
+    for (int node = 1; node < mySize; ++node)
+    {
+        for (int child : { 2 * node, 2 * node + 1 })
+        {
+            myBoxHeights[child] =
+                std::max(myBoxHeights[child], myBoxHeights[node]);
+        }
+    }
+
+    // The first time the tree is built, start from the dense heights.
+    std::vector<int> heights = std::move(myHeights);
+    myHeights = std::vector<int>();
+    heights.resize(newSize, 0);
+    for (int i = 0; i < mySize; ++i)
+    {
+        heights[i] = std::max(myMaxHeights[mySize + i],
+                              myBoxHeights[mySize + i]);
+    }
+
+    // Rebuild the tree, with the existing heights as the leaves.
+    mySize = newSize;
+    myMaxHeights.assign(2 * newSize, 0);
+    myBoxHeights.assign(2 * newSize, 0);
+
+    std::copy(heights.begin(), heights.end(), myMaxHeights.begin() + newSize);
+    for (int node = newSize - 1; node > 0; --node)
+    {
+        myMaxHeights[node] =
+            std::max(myMaxHeights[2 * node], myMaxHeights[2 * node + 1]);
+    }
+}
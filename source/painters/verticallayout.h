@@ -20,6 +20,7 @@
 
 #include <vector>
 
+/// Stacks boxes spanning ranges of positions so that they do not overlap.
 class VerticalLayout
 {
 public:
@@ -28,7 +29,33 @@ public:
     int addBox(int left, int right, int height);
 
 private:
-    std::vector<int> heights;
+    /// Adds a box to a layout that stores the height at each position.
+    int addDenseBox(int left, int right, int height);
+
+    /// Ensures that the tree can hold at least the given number of positions,
+    /// moving any heights from the dense layout into it.
+    void reserve(int size);
+
+    /// Returns the largest height in the range [left, right) of the tree.
+    int getMaxHeight(int left, int right) const;
+
+    /// The height at each position, while the layout is small. Scanning a
+    /// range of a typical staff is faster than updating the tree.
+    std::vector<int> myHeights;
+
+    /// Once the layout is too large for the dense heights, they are stored
+    /// in a segment tree so that finding the height of a range and raising
+    /// it are logarithmic in the number of positions.
+    /// Node 1 is the root, the children of node i are 2i and 2i + 1, and the
+    /// leaves start at mySize.
+    /// A box is always placed above everything in its range, so heights only
+    /// ever increase. This means a box can be recorded in the nodes that
+    /// cover its range without pushing the height down to their children.
+    int mySize = 0;
+    /// The largest height within each node's range.
+    std::vector<int> myMaxHeights;
+    /// The height of any box that covers the entire range of the node.
+    std::vector<int> myBoxHeights;
 };
 
 #endif
@@ -17,6 +17,7 @@
 
 #include "score.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 const int Score::MIN_LINE_SPACING = 6;
@@ -36,6 +37,55 @@ bool Score::operator==(const Score &other) const
            myViewFilters == other.myViewFilters;
 }
 
+Score Score::clone() const
+{
+    return Score(*this);
+}
+
+void Score::copyChangesFrom(const Score &other)
+{
+    myScoreInfo = other.myScoreInfo;
+    myPlayers = other.myPlayers;
+    myInstruments = other.myInstruments;
+    myLineSpacing = other.myLineSpacing;
+    myViewFilters = other.myViewFilters;
+
+    // Skip over the unchanged systems at the start and end of the score, so
+    // that inserting or removing a system doesn't require copying the systems
+    // after it.
+    const size_t min_size = std::min(mySystems.size(), other.mySystems.size());
+    size_t prefix = 0;
+    while (prefix < min_size && mySystems[prefix] == other.mySystems[prefix])
+        ++prefix;
+
+    size_t suffix = 0;
+    while (suffix < min_size - prefix &&
+           mySystems[mySystems.size() - suffix - 1] ==
+               other.mySystems[other.mySystems.size() - suffix - 1])
+    {
+        ++suffix;
+    }
+
+    const size_t old_end = mySystems.size() - suffix;
+    const size_t new_end = other.mySystems.size() - suffix;
+    if (old_end > new_end)
+    {
+        mySystems.erase(mySystems.begin() + new_end,
+                        mySystems.begin() + old_end);
+    }
+    else
+    {
+        mySystems.insert(mySystems.begin() + old_end, new_end - old_end,
+                         System());
+    }
+
+    for (size_t i = prefix; i < new_end; ++i)
+    {
+        if (!(mySystems[i] == other.mySystems[i]))
+            mySystems[i] = other.mySystems[i];
+    }
+}
+
 const ScoreInfo &Score::getScoreInfo() const
 {
     return myScoreInfo;
@@ -42,10 +42,19 @@ public:
     typedef std::vector<ViewFilter>::const_iterator ViewFilterConstIterator;
 
     Score();
-    Score(const Score &other) = delete;
     Score &operator=(const Score &other) = delete;
     bool operator==(const Score &other) const;
 
+    /// Returns an independent copy of the score (e.g. a snapshot for saving
+    /// in the background). Implicit copies are disallowed since scores can be
+    /// very large.
+    Score clone() const;
+
+    /// Makes this score equal to the other score. Only the systems that
+    /// differ are copied, which is much cheaper than clone() when updating an
+    /// older snapshot of the same score.
+    void copyChangesFrom(const Score &other);
+
     template <class Archive>
     void serialize(Archive &ar, const FileVersion version);
 
@@ -105,6 +114,8 @@ public:
     static const int MAX_LINE_SPACING;
 
 private:
+    Score(const Score &other) = default;
+
     // TODO - add font settings, chord diagrams, etc.
     ScoreInfo myScoreInfo;
     std::vector<System> mySystems;
@@ -20,6 +20,8 @@
 
 #include <array>
 #include <bitset>
+#include <boost/functional/hash.hpp>
+#include <cstdint>
 #include "fileversion.h"
 #include <istream>
 #include <map>
@@ -183,6 +185,119 @@ void save(std::ostream &output, const std::string &name, const T &obj)
     ar(name, obj);
 }
 
+/// Two independent hashes of an object's contents, along with the number of
+/// values that were hashed. This is wide enough to assume that objects with
+/// the same digest have the same contents, without keeping a copy of the
+/// object to compare against.
+struct Digest
+{
+    size_t myHash = 0;
+    uint64_t myCheck = 0;
+    size_t mySize = 0;
+
+    bool operator==(const Digest &other) const
+    {
+        return myHash == other.myHash && myCheck == other.myCheck &&
+               mySize == other.mySize;
+    }
+
+    bool operator!=(const Digest &other) const
+    {
+        return !operator==(other);
+    }
+};
+
+/// Computes a hash from the same values that are written to a file, so that
+/// it changes whenever the object's contents would be saved differently.
+/// This is much cheaper than laying out or rendering the object, and can be
+/// used to detect whether it has changed.
+class HashArchive
+{
+public:
+    HashArchive() : mySeed(0), myCheck(0), myCount(0)
+    {
+    }
+
+    template <typename T>
+    void operator()(const std::string_view &, const T &obj)
+    {
+        write(obj);
+    }
+
+    size_t getHash() const
+    {
+        return mySeed;
+    }
+
+    Digest getDigest() const
+    {
+        return { mySeed, myCheck, myCount };
+    }
+
+private:
+    /// Adds a value to the second hash.
+    inline void mixCheck(uint64_t val);
+
+    inline void write(int val);
+    inline void write(unsigned int val);
+    inline void write(bool val);
+    inline void write(const std::string &str);
+
+    template <typename T>
+    void write(const std::vector<T> &vec);
+
+    template <typename K, typename V, typename C>
+    void write(const std::map<K, V, C> &map);
+
+    template <typename T, size_t N>
+    void write(const std::array<T, N> &arr);
+
+    template <size_t N>
+    void write(const std::bitset<N> &bits);
+
+    template <typename T>
+    void write(const std::optional<T> &val);
+
+    inline void write(const Util::Date &date);
+
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value>::type write(const T &val)
+    {
+        write(static_cast<int>(val));
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_class<T>::value>::type write(const T &obj)
+    {
+        const_cast<T &>(obj).serialize(*this, FileVersion::LATEST_VERSION);
+    }
+
+    size_t mySeed;
+    /// A second hash, which uses a different mixing function from
+    /// boost::hash_combine.
+    uint64_t myCheck;
+    /// The number of values that have been hashed.
+    size_t myCount;
+};
+
+/// Returns a hash of the object's contents.
+template <typename T>
+size_t hash(const T &obj)
+{
+    HashArchive ar;
+    ar("", obj);
+    return ar.getHash();
+}
+
+/// Returns a digest of the object's contents.
+template <typename T>
+Digest digest(const T &obj)
+{
+    HashArchive ar;
+    ar("", obj);
+    return ar.getDigest();
+}
+
 void InputArchive::read(int &val)
 {
     val = value().GetInt();
@@ -349,6 +464,97 @@ void OutputArchive::write(const std::optional<T> &val)
     else
         myStream.Null();
 }
+
+void HashArchive::mixCheck(uint64_t val)
+{
+    // Mix in the value's index, so that the order of the values matters, and
+    // then apply the splitmix64 finalizer.
+    val += 0x9e3779b97f4a7c15ULL * ++myCount;
+    val = (val ^ (val >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    val = (val ^ (val >> 27)) * 0x94d049bb133111ebULL;
+    val ^= val >> 31;
+
+    myCheck = (myCheck ^ val) * 0x100000001b3ULL;
+}
+
+void HashArchive::write(int val)
+{
+    boost::hash_combine(mySeed, val);
+    mixCheck(static_cast<uint32_t>(val));
+}
+
+void HashArchive::write(unsigned int val)
+{
+    boost::hash_combine(mySeed, val);
+    mixCheck(val);
+}
+
+void HashArchive::write(bool val)
+{
+    boost::hash_combine(mySeed, val);
+    mixCheck(val);
+}
+
+void HashArchive::write(const std::string &str)
+{
+    boost::hash_combine(mySeed, str);
+    mixCheck(str.size());
+    mixCheck(std::hash<std::string>()(str));
+}
+
+template <typename T>
+void HashArchive::write(const std::vector<T> &vec)
+{
+    // Include the size so that e.g. moving an item between two adjacent
+    // lists changes the hash.
+    write(static_cast<unsigned int>(vec.size()));
+    for (const T &obj : vec)
+        write(obj);
+}
+
+template <typename K, typename V, typename C>
+void HashArchive::write(const std::map<K, V, C> &map)
+{
+    write(static_cast<unsigned int>(map.size()));
+    for (const auto &pair : map)
+    {
+        write(pair.first);
+        write(pair.second);
+    }
+}
+
+template <typename T, size_t N>
+void HashArchive::write(const std::array<T, N> &arr)
+{
+    for (const T &obj : arr)
+        write(obj);
+}
+
+template <size_t N>
+void HashArchive::write(const std::bitset<N> &bits)
+{
+    boost::hash_combine(mySeed, std::hash<std::bitset<N>>()(bits));
+
+    if constexpr (N <= 64)
+        mixCheck(bits.to_ullong());
+    else
+        mixCheck(std::hash<std::string>()(bits.to_string()));
+}
+
+template <typename T>
+void HashArchive::write(const std::optional<T> &val)
+{
+    write(val.has_value());
+    if (val)
+        write(*val);
+}
+
+void HashArchive::write(const Util::Date &date)
+{
+    write(date.year());
+    write(date.month());
+    write(date.day());
+}
 }
 
 #endif
@@ -17,9 +17,11 @@
 
 #include "repeatindexer.h"
 
+#include <algorithm>
 #include <optional>
 #include <score/score.h>
 #include <score/utils.h>
+#include <set>
 #include <stack>
 
 RepeatedSection::RepeatedSection(const SystemLocation &startBar)
@@ -133,6 +135,8 @@ RepeatIndexer::RepeatIndexer(const Score &score)
     // There may be nested repeats, so maintain a stack of the active repeats
     // as we go through the score.
     std::stack<RepeatedSection> repeats;
+    // The completed repeats, ordered by their start bars.
+    std::set<RepeatedSection> sections;
 
     // The start of the score can always act as a repeat start bar.
     repeats.push(SystemLocation(0, 0));
@@ -174,7 +178,7 @@ RepeatIndexer::RepeatIndexer(const Score &score)
                     activeRepeat.getAlternateEndingCount() >=
                         activeRepeat.getTotalRepeatCount())
                 {
-                    myRepeats.insert(activeRepeat);
+                    sections.insert(activeRepeat);
                     repeats.pop();
                 }
             }
@@ -198,7 +202,7 @@ RepeatIndexer::RepeatIndexer(const Score &score)
                 // done with this repeat.
                 if (activeRepeat.getAlternateEndingCount() == 0)
                 {
-                    myRepeats.insert(activeRepeat);
+                    sections.insert(activeRepeat);
                     repeats.pop();
                 }
             }
@@ -209,19 +213,32 @@ RepeatIndexer::RepeatIndexer(const Score &score)
 
     // TODO - report mismatched repeat start bars.
     // TODO - report missing / extra alternate endings.
+
+    myRepeats.assign(sections.begin(), sections.end());
+    myMaxEndBars.reserve(myRepeats.size());
+    for (const RepeatedSection &section : myRepeats)
+    {
+        const SystemLocation &end_bar = section.getLastEndBarLocation();
+        myMaxEndBars.push_back(myMaxEndBars.empty()
+                                   ? end_bar
+                                   : std::max(myMaxEndBars.back(), end_bar));
+    }
 }
 
 const RepeatedSection *RepeatIndexer::findRepeat(
     const SystemLocation &loc) const
 {
-    auto repeat = myRepeats.upper_bound(loc);
+    // Find the last repeat that starts at or before this location.
+    auto repeat = std::upper_bound(myRepeats.begin(), myRepeats.end(),
+                                   RepeatedSection(loc));
+    size_t i = std::distance(myRepeats.begin(), repeat);
 
     // Search for a pair of start and end bars that surrounds this location.
-    while (repeat != myRepeats.begin())
+    while (i > 0 && myMaxEndBars[i - 1] >= loc)
     {
-        --repeat;
-        if (repeat->getLastEndBarLocation() >= loc)
-            return &(*repeat);
+        --i;
+        if (myRepeats[i].getLastEndBarLocation() >= loc)
+            return &myRepeats[i];
     }
 
     return nullptr;
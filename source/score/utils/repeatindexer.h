@@ -22,8 +22,8 @@
 #include <map>
 #include <optional>
 #include <score/systemlocation.h>
-#include <set>
 #include <unordered_map>
+#include <vector>
 
 class AlternateEnding;
 class Score;
@@ -78,7 +78,8 @@ private:
 class RepeatIndexer
 {
 public:
-    typedef std::set<RepeatedSection>::const_iterator RepeatedSectionIterator;
+    typedef std::vector<RepeatedSection>::const_iterator
+        RepeatedSectionIterator;
 
     RepeatIndexer(const Score &score);
 
@@ -91,7 +92,12 @@ public:
     boost::iterator_range<RepeatedSectionIterator> getRepeats() const;
 
 private:
-    std::set<RepeatedSection> myRepeats;
+    /// The repeated sections, ordered by their start bars.
+    std::vector<RepeatedSection> myRepeats;
+    /// For each repeated section, the furthest end bar of it or any earlier
+    /// section. This allows findRepeat() to stop searching once no earlier
+    /// section can surround the location.
+    std::vector<SystemLocation> myMaxEndBars;
 };
 
 #endif
@@ -19,6 +19,7 @@
 
 #include <list>
 #include <unordered_set>
+#include <vector>
 
 #include <app/caret.h>
 #include <app/viewoptions.h>
@@ -425,6 +426,45 @@ static int copyContent(ScoreLocation &dest_loc, int &num_guitar_staves,
     }
 }
 
+/// Finds the active players at a location without scanning through all of
+/// the previous systems (see ScoreUtils::getCurrentPlayers).
+class CurrentPlayerIndex
+{
+public:
+    explicit CurrentPlayerIndex(const Score &score) : myScore(score)
+    {
+        const PlayerChange *last_change = nullptr;
+        myPrevChanges.reserve(score.getSystems().size());
+
+        for (const System &system : score.getSystems())
+        {
+            myPrevChanges.push_back(last_change);
+            if (!system.getPlayerChanges().empty())
+                last_change = &system.getPlayerChanges().back();
+        }
+    }
+
+    const PlayerChange *getCurrentPlayers(int system_index,
+                                          int position_index) const
+    {
+        const PlayerChange *last_change = myPrevChanges[system_index];
+
+        for (const PlayerChange &change :
+             myScore.getSystems()[system_index].getPlayerChanges())
+        {
+            if (change.getPosition() <= position_index)
+                last_change = &change;
+        }
+
+        return last_change;
+    }
+
+private:
+    const Score &myScore;
+    /// For each system, the last player change in any of the earlier systems.
+    std::vector<const PlayerChange *> myPrevChanges;
+};
+
 static const PlayerChange *findPlayerChange(
     const ScoreLocation &dest_loc, const ScoreLocation &src_loc,
     ExpandedBarList::const_iterator src_bar,
@@ -445,6 +485,8 @@ static const PlayerChange *findPlayerChange(
 static void mergePlayerChanges(ScoreLocation &dest_loc,
                                const ScoreLocation &guitar_loc,
                                const ScoreLocation &bass_loc,
+                               const CurrentPlayerIndex &guitar_players,
+                               const CurrentPlayerIndex &bass_players,
                                ExpandedBarList::const_iterator guitar_bar,
                                ExpandedBarList::const_iterator end_guitar_bar,
                                ExpandedBarList::const_iterator bass_bar,
@@ -471,18 +513,16 @@ static void mergePlayerChanges(ScoreLocation &dest_loc,
         {
             // If there is only a player change in the bass score, carry over
             // the current active players from the guitar score.
-            guitar_change = ScoreUtils::getCurrentPlayers(
-                guitar_loc.getScore(), guitar_loc.getSystemIndex(),
-                guitar_loc.getPositionIndex());
+            guitar_change = guitar_players.getCurrentPlayers(
+                guitar_loc.getSystemIndex(), guitar_loc.getPositionIndex());
         }
 
         if (!bass_change && bass_bar != end_bass_bar)
         {
             // If there is only a player change in the guitar score, carry over
             // the current active players from the bass score.
-            bass_change = ScoreUtils::getCurrentPlayers(
-                bass_loc.getScore(), bass_loc.getSystemIndex(),
-                bass_loc.getPositionIndex());
+            bass_change = bass_players.getCurrentPlayers(
+                bass_loc.getSystemIndex(), bass_loc.getPositionIndex());
         }
 
         // Merge in data from only the active staves.
@@ -621,6 +661,9 @@ static void combineScores(Score &dest_score, Score &guitar_score,
     Caret bass_caret(bass_score, theDefaultViewOptions);
     const ScoreLocation &bass_loc = bass_caret.getLocation();
 
+    const CurrentPlayerIndex guitar_players(guitar_score);
+    const CurrentPlayerIndex bass_players(bass_score);
+
     auto guitar_bar = guitar_bars.begin();
     const auto end_guitar_bar = guitar_bars.end();
     auto bass_bar = bass_bars.begin();
@@ -690,9 +733,10 @@ static void combineScores(Score &dest_score, Score &guitar_score,
                                                  bass_caret, *bass_bar, true));
         }
 
-        mergePlayerChanges(dest_loc, guitar_loc, bass_loc, guitar_bar,
-                           end_guitar_bar, bass_bar, end_bass_bar,
-                           num_guitar_staves, prev_num_guitar_staves);
+        mergePlayerChanges(dest_loc, guitar_loc, bass_loc, guitar_players,
+                           bass_players, guitar_bar, end_guitar_bar, bass_bar,
+                           end_bass_bar, num_guitar_staves,
+                           prev_num_guitar_staves);
 
         // Advance to the next bar in the source scores.
         if (guitar_bar != end_guitar_bar)
@@ -0,0 +1,154 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UTIL_DISPLACEMENTS_H
+#define UTIL_DISPLACEMENTS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <util/fenwicktree.h>
+
+namespace Util
+{
+/// Tracks how far each item in a list is from its correct location, for
+/// lists where items are only moved when they are needed (e.g. when they
+/// become visible). Consecutive items with the same displacement are stored
+/// as a single run, so shifting every item after an index only updates the
+/// runs after it rather than each item.
+template <typename T>
+class Displacements
+{
+public:
+    Displacements() = default;
+
+    /// Creates a list of items that are all at their correct locations.
+    explicit Displacements(size_t size) : mySize(size)
+    {
+        if (mySize > 0)
+            myRuns.emplace(0, T());
+    }
+
+    size_t size() const { return mySize; }
+
+    /// Returns whether every item is at its correct location.
+    bool empty() const
+    {
+        return myRuns.size() <= 1 &&
+               (myRuns.empty() || myRuns.begin()->second == T());
+    }
+
+    /// Returns how far the item needs to move to reach its correct location.
+    const T &get(size_t index) const
+    {
+        return std::prev(myRuns.upper_bound(index))->second;
+    }
+
+    /// Records that the correct locations of the items from the index onward
+    /// have moved by the delta, without the items being moved.
+    void shift(size_t index, const T &delta)
+    {
+        if (index >= mySize || delta == T())
+            return;
+
+        auto first = split(index);
+        for (auto it = first; it != myRuns.end(); ++it)
+            it->second += delta;
+
+        merge(first);
+    }
+
+    /// Records that the item has been moved to its correct location.
+    void reset(size_t index)
+    {
+        if (index >= mySize || get(index) == T())
+            return;
+
+        auto it = split(index);
+        auto next = split(index + 1);
+        it->second = T();
+
+        if (next != myRuns.end())
+            merge(next);
+        merge(it);
+    }
+
+    /// Calls f(index) for each displaced item whose current location
+    /// overlaps the range [top, bottom]. The correct location of an item
+    /// starts at the sum of the sizes of the items before it. The time taken
+    /// depends on the number of runs and the number of items found, rather
+    /// than the total number of items.
+    template <typename Function>
+    void findOverlapping(const FenwickTree<T> &sizes, const T &top,
+                         const T &bottom, Function f) const
+    {
+        for (auto it = myRuns.begin(); it != myRuns.end(); ++it)
+        {
+            const T &displacement = it->second;
+            if (displacement == T())
+                continue;
+
+            const auto next = std::next(it);
+            const size_t end = (next == myRuns.end()) ? mySize : next->first;
+
+            // An item is currently at its correct location minus the
+            // displacement, so find the first item whose correct location
+            // contains top + displacement.
+            size_t i = std::max(it->first, sizes.find(top + displacement));
+            T offset = sizes.getPrefixSum(i) - displacement;
+            for (; i < end && !(bottom < offset); ++i)
+            {
+                f(i);
+                offset += sizes.get(i);
+            }
+        }
+    }
+
+private:
+    using Runs = std::map<size_t, T>;
+
+    /// Ensures that a run starts at the index, and returns it.
+    typename Runs::iterator split(size_t index)
+    {
+        if (index >= mySize)
+            return myRuns.end();
+
+        auto next = myRuns.upper_bound(index);
+        auto prev = std::prev(next);
+        if (prev->first == index)
+            return prev;
+
+        return myRuns.emplace_hint(next, index, prev->second);
+    }
+
+    /// Combines the run with the previous run if they have the same
+    /// displacement.
+    void merge(typename Runs::iterator it)
+    {
+        if (it != myRuns.begin() && std::prev(it)->second == it->second)
+            myRuns.erase(it);
+    }
+
+    size_t mySize = 0;
+    /// Maps the first index of each run to the displacement of its items.
+    /// The runs cover every item.
+    Runs myRuns;
+};
+} // namespace Util
+
+#endif
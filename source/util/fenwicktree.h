@@ -0,0 +1,107 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UTIL_FENWICKTREE_H
+#define UTIL_FENWICKTREE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace Util
+{
+/// Stores a list of non-negative values (e.g. the heights of a sequence of
+/// items) and provides the prefix sums of the list. Changing a value and
+/// computing a prefix sum both take logarithmic time, rather than needing to
+/// update the offset of every item after the one that changed.
+template <typename T>
+class FenwickTree
+{
+public:
+    FenwickTree() = default;
+
+    explicit FenwickTree(const std::vector<T> &values)
+        : myValues(values), myTree(values.size() + 1, T())
+    {
+        // Build the tree in linear time by pushing each partial sum to its
+        // parent.
+        for (size_t i = 1; i <= myValues.size(); ++i)
+        {
+            myTree[i] += myValues[i - 1];
+            const size_t parent = i + lowestBit(i);
+            if (parent <= myValues.size())
+                myTree[parent] += myTree[i];
+        }
+    }
+
+    size_t size() const { return myValues.size(); }
+
+    const T &get(size_t index) const { return myValues[index]; }
+
+    void set(size_t index, const T &value)
+    {
+        const T delta = value - myValues[index];
+        myValues[index] = value;
+
+        for (size_t i = index + 1; i < myTree.size(); i += lowestBit(i))
+            myTree[i] += delta;
+    }
+
+    /// Returns the sum of the first 'count' values.
+    T getPrefixSum(size_t count) const
+    {
+        T sum = T();
+        for (size_t i = count; i > 0; i -= lowestBit(i))
+            sum += myTree[i];
+        return sum;
+    }
+
+    /// Returns the sum of all of the values.
+    T getTotal() const { return getPrefixSum(myValues.size()); }
+
+    /// Returns the index of the item that contains the offset, i.e. the
+    /// largest index whose prefix sum is less than or equal to the offset.
+    /// Returns size() if the offset is past the end of the list.
+    size_t find(T offset) const
+    {
+        size_t index = 0;
+        size_t step = 1;
+        while (step * 2 < myTree.size())
+            step *= 2;
+
+        for (; step > 0; step /= 2)
+        {
+            const size_t next = index + step;
+            if (next < myTree.size() && !(offset < myTree[next]))
+            {
+                index = next;
+                offset -= myTree[next];
+            }
+        }
+
+        return index;
+    }
+
+private:
+    static size_t lowestBit(size_t i) { return i & (~i + 1); }
+
+    std::vector<T> myValues;
+    /// Node i stores the sum of the values in (i - lowestBit(i), i].
+    std::vector<T> myTree;
+};
+} // namespace Util
+
+#endif
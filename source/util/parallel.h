@@ -0,0 +1,111 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UTIL_PARALLEL_H
+#define UTIL_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace Util
+{
+namespace Detail
+{
+/// Set on the threads that are running a parallelFor() loop.
+inline thread_local bool theIsWorker = false;
+} // namespace Detail
+
+/// Returns whether the current thread is one of parallelFor()'s workers.
+inline bool isParallelWorker()
+{
+    return Detail::theIsWorker;
+}
+
+/// Calls f(i) for each i in [0, count) from a pool of worker threads, and
+/// blocks until all of the calls have finished. Work is handed out one index
+/// at a time, so uneven tasks (e.g. files of very different sizes) are
+/// balanced across the threads.
+/// If this is called from inside another parallelFor() loop, the calls are
+/// made serially on the current thread, since the outer loop already keeps
+/// every core busy.
+/// If any call throws, the remaining indices are skipped and the first
+/// exception is rethrown once the workers have stopped.
+/// @param num_threads The number of workers, or 0 to use one per core.
+template <typename F>
+void parallelFor(size_t count, F f, unsigned int num_threads = 0)
+{
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = static_cast<unsigned int>(
+        std::min<size_t>(num_threads, count));
+
+    if (num_threads <= 1 || isParallelWorker())
+    {
+        for (size_t i = 0; i < count; ++i)
+            f(i);
+        return;
+    }
+
+    std::atomic<size_t> next_index(0);
+    std::atomic<bool> failed(false);
+
+    auto worker = [&]() {
+        Detail::theIsWorker = true;
+        size_t i;
+        while (!failed && (i = next_index++) < count)
+        {
+            try
+            {
+                f(i);
+            }
+            catch (...)
+            {
+                failed = true;
+                throw;
+            }
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    for (unsigned int i = 0; i < num_threads; ++i)
+        workers.push_back(std::async(std::launch::async, worker));
+
+    std::exception_ptr error;
+    for (auto &&w : workers)
+    {
+        try
+        {
+            w.get();
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+} // namespace Util
+
+#endif
@@ -0,0 +1,253 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <doctest/doctest.h>
+
+#include <app/autosavejournal.h>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <score/score.h>
+
+namespace
+{
+struct JournalFixture
+{
+    JournalFixture()
+        : myDir(boost::filesystem::temp_directory_path() /
+                boost::filesystem::unique_path("pte-autosave-%%%%-%%%%"))
+    {
+        System system;
+        system.insertStaff(Staff(6));
+        myScore.insertSystem(system);
+        myScore.insertSystem(system);
+    }
+
+    ~JournalFixture()
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(myDir, ec);
+    }
+
+    boost::filesystem::path myDir;
+    Score myScore;
+};
+} // namespace
+
+TEST_CASE_FIXTURE(JournalFixture, "App/AutosaveJournal/ReplaySystemChanges")
+{
+    AutosaveJournal journal(myDir);
+    journal.setDocumentFilename("test.pt2");
+
+    // The first change creates a checkpoint.
+    journal.recordSystemChange(myScore, 0);
+
+    myScore.getSystems()[1].insertStaff(Staff(7));
+    journal.recordSystemChange(myScore, 1);
+    myScore.getSystems()[0].insertBarline(Barline(4, Barline::DoubleBar));
+    journal.recordSystemChange(myScore, 0);
+    journal.waitForCheckpoint();
+
+    Score recovered;
+    auto filename = AutosaveJournal::recover(journal.getDirectory(), recovered);
+    REQUIRE(filename);
+    REQUIRE(*filename == "test.pt2");
+    REQUIRE(recovered == myScore);
+}
+
+TEST_CASE_FIXTURE(JournalFixture, "App/AutosaveJournal/ScoreChanges")
+{
+    AutosaveJournal journal(myDir);
+    journal.recordSystemChange(myScore, 0);
+
+    myScore.removeSystem(0);
+    journal.recordScoreChange(myScore);
+    myScore.getSystems()[0].insertStaff(Staff(4));
+    journal.recordSystemChange(myScore, 0);
+    journal.waitForCheckpoint();
+
+    Score recovered;
+    REQUIRE(!AutosaveJournal::recover(journal.getDirectory(), recovered));
+    REQUIRE(recovered == myScore);
+}
+
+TEST_CASE_FIXTURE(JournalFixture, "App/AutosaveJournal/IncompleteRecord")
+{
+    AutosaveJournal journal(myDir);
+    journal.recordSystemChange(myScore, 0);
+    journal.waitForCheckpoint();
+
+    Score expected;
+    expected.insertSystem(myScore.getSystems()[0]);
+    expected.insertSystem(myScore.getSystems()[1]);
+
+    // Simulate a crash while the last record was being written.
+    myScore.getSystems()[1].insertStaff(Staff(7));
+    journal.recordSystemChange(myScore, 1);
+
+    boost::filesystem::path segment;
+    for (auto &entry :
+         boost::filesystem::directory_iterator(journal.getDirectory()))
+    {
+        if (entry.path().extension() == ".log")
+            segment = entry.path();
+    }
+    REQUIRE(!segment.empty());
+    boost::filesystem::resize_file(segment,
+                                   boost::filesystem::file_size(segment) - 1);
+
+    Score recovered;
+    AutosaveJournal::recover(journal.getDirectory(), recovered);
+    REQUIRE(recovered == expected);
+}
+
+TEST_CASE_FIXTURE(JournalFixture, "App/AutosaveJournal/Cleanup")
+{
+    boost::filesystem::path journal_dir;
+    {
+        AutosaveJournal journal(myDir);
+        journal_dir = journal.getDirectory();
+        journal.recordSystemChange(myScore, 0);
+
+        REQUIRE(boost::filesystem::exists(journal_dir));
+    }
+
+    REQUIRE(!boost::filesystem::exists(journal_dir));
+}
+
+TEST_CASE_FIXTURE(JournalFixture, "App/AutosaveJournal/RepeatedScoreChanges")
+{
+    AutosaveJournal journal(myDir);
+    journal.recordSystemChange(myScore, 0);
+
+    // Each checkpoint after the first updates the previous snapshot.
+    System system;
+    system.insertStaff(Staff(5));
+    myScore.insertSystem(system, 1);
+    journal.recordScoreChange(myScore);
+    journal.waitForCheckpoint();
+
+    myScore.removeSystem(0);
+    myScore.setLineSpacing(12);
+    journal.recordScoreChange(myScore);
+    myScore.getSystems()[1].insertStaff(Staff(4));
+    journal.recordSystemChange(myScore, 1);
+    journal.waitForCheckpoint();
+
+    Score recovered;
+    AutosaveJournal::recover(journal.getDirectory(), recovered);
+    REQUIRE(recovered == myScore);
+}
+
+TEST_CASE_FIXTURE(JournalFixture, "App/AutosaveJournal/FindOrphanedJournals")
+{
+    namespace fs = boost::filesystem;
+
+    // Simulate journals that were left behind after a crash.
+    auto createOrphan = [&](const std::string &name) {
+        const fs::path dir = myDir / name;
+        fs::create_directories(dir);
+        fs::ofstream lock_file(dir / "lock");
+        return dir;
+    };
+
+    const fs::path empty_journal = createOrphan("empty");
+    const fs::path journal_dir = createOrphan("journal");
+    {
+        AutosaveJournal journal(myDir / "source");
+        journal.recordSystemChange(myScore, 0);
+        journal.waitForCheckpoint();
+
+        for (auto &entry : fs::directory_iterator(journal.getDirectory()))
+        {
+            if (entry.path().filename() != "lock")
+                fs::copy_file(entry.path(),
+                              journal_dir / entry.path().filename());
+        }
+    }
+
+    // The journal without a checkpoint can't be recovered, so it should be
+    // deleted rather than reported.
+    const std::vector<fs::path> journals =
+        AutosaveJournal::findOrphanedJournals(myDir);
+    REQUIRE(journals == std::vector<fs::path>{ journal_dir });
+    REQUIRE(!fs::exists(empty_journal));
+
+    Score recovered;
+    AutosaveJournal::recover(journal_dir, recovered);
+    REQUIRE(recovered == myScore);
+}
+
+TEST_CASE_FIXTURE(JournalFixture, "App/AutosaveJournal/FailedCheckpoint")
+{
+    namespace fs = boost::filesystem;
+
+    AutosaveJournal journal(myDir);
+
+    // Block the first checkpoint from being written.
+    const fs::path blocker =
+        journal.getDirectory() / "checkpoint-0.json.tmp";
+    fs::create_directories(blocker);
+
+    journal.recordSystemChange(myScore, 0);
+    REQUIRE_THROWS(journal.waitForCheckpoint());
+
+    // The next checkpoint reports the failure, and writes the same
+    // generation again.
+    fs::remove(blocker);
+    myScore.getSystems()[1].insertStaff(Staff(7));
+    journal.recordSystemChange(myScore, 1);
+    REQUIRE_THROWS(journal.checkpoint(myScore));
+    journal.waitForCheckpoint();
+
+    REQUIRE(fs::exists(journal.getDirectory() / "checkpoint-0.json"));
+    REQUIRE(!fs::exists(journal.getDirectory() / "checkpoint-1.json"));
+
+    Score recovered;
+    AutosaveJournal::recover(journal.getDirectory(), recovered);
+    REQUIRE(recovered == myScore);
+}
+
+TEST_CASE_FIXTURE(JournalFixture, "App/AutosaveJournal/InvalidRecordSize")
+{
+    AutosaveJournal journal(myDir);
+    journal.recordSystemChange(myScore, 0);
+    journal.waitForCheckpoint();
+
+    Score expected;
+    expected.insertSystem(myScore.getSystems()[0]);
+    expected.insertSystem(myScore.getSystems()[1]);
+
+    // Append a record header whose size is far larger than the file.
+    boost::filesystem::path segment;
+    for (auto &entry :
+         boost::filesystem::directory_iterator(journal.getDirectory()))
+    {
+        if (entry.path().extension() == ".log")
+            segment = entry.path();
+    }
+    REQUIRE(!segment.empty());
+    {
+        boost::filesystem::ofstream output(
+            segment, std::ios::out | std::ios::binary | std::ios::app);
+        const char header[12] = { '\xf0', '\xff', '\xff', '\xff' };
+        output.write(header, sizeof(header));
+    }
+
+    Score recovered;
+    AutosaveJournal::recover(journal.getDirectory(), recovered);
+    REQUIRE(recovered == expected);
+}
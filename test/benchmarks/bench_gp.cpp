@@ -0,0 +1,66 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// Measures the import time for Guitar Pro 3-5 files.
+/// Usage: pte_bench_gp [--iterations N] [files or directories...]
+/// By default, the files from the test suite are used.
+
+#include "benchutil.h"
+
+#include <formats/guitar_pro/document.h>
+#include <formats/guitar_pro/guitarproimporter.h>
+#include <formats/guitar_pro/inputstream.h>
+#include <score/score.h>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace fs = boost::filesystem;
+
+int main(int argc, char *argv[])
+{
+    GuitarProImporter importer;
+    std::vector<BenchUtil::Stage> stages;
+
+    // Parse the file after reading it through a stream.
+    stages.push_back({ "Stream", [](const fs::path &path) {
+        fs::ifstream in(path, std::ios::binary | std::ios::in);
+        Gp::InputStream stream(in);
+        Gp::Document document;
+        document.load(stream);
+    } });
+
+    // Parse the file directly from a memory-mapped view.
+    stages.push_back({ "Mapped", [](const fs::path &path) {
+        boost::iostreams::mapped_file_source file(path);
+        Gp::InputStream stream(
+            reinterpret_cast<const std::byte *>(file.data()),
+            file.size());
+        Gp::Document document;
+        document.load(stream);
+    } });
+
+    // Run the full import, including the conversion to a score.
+    stages.push_back({ "Import", [&](const fs::path &path) {
+        Score score;
+        importer.load(path, score);
+    } });
+
+    return BenchUtil::runFileBenchmark(argc, argv, PTE_GP_CORPUS_DIR,
+                                       { ".gp3", ".gp4", ".gp5" },
+                                       "Guitar Pro", stages);
+}
@@ -0,0 +1,48 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// Measures the probe and import times for Guitar Pro 7 files.
+/// Usage: pte_bench_gp7 [--iterations N] [files or directories...]
+/// By default, the files from the test suite are used.
+
+#include "benchutil.h"
+
+#include <formats/gp7/gp7importer.h>
+#include <formats/scoremetadata.h>
+#include <score/score.h>
+
+namespace fs = boost::filesystem;
+
+int main(int argc, char *argv[])
+{
+    Gp7Importer importer;
+    std::vector<BenchUtil::Stage> stages;
+
+    // Read only the header, as the file browser does.
+    stages.push_back({ "Probe", [&](const fs::path &path) {
+        importer.probe(path);
+    } });
+
+    // Run the full import, including the conversion to a score.
+    stages.push_back({ "Import", [&](const fs::path &path) {
+        Score score;
+        importer.load(path, score);
+    } });
+
+    return BenchUtil::runFileBenchmark(argc, argv, PTE_GP7_CORPUS_DIR,
+                                       { ".gp" }, "Guitar Pro 7", stages);
+}
@@ -0,0 +1,222 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// Measures the decompression throughput for .gpx files.
+/// Usage: pte_bench_gpx [--iterations N] [files or directories...]
+/// By default, the files from the test suite are used.
+
+#include "benchutil.h"
+
+#include <formats/gpx/filesystem.h>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+/// The original bit-at-a-time decompressor, which is used as a baseline.
+namespace Reference
+{
+class BitStream
+{
+public:
+    BitStream(std::istream &stream) : myPosition(0)
+    {
+        // Copy data from the stream into an internal buffer.
+        stream.seekg(0, std::ios::end);
+        myData.resize(stream.tellg());
+
+        stream.seekg(0, std::ios::beg);
+        stream.read(&myData[0], myData.size());
+    }
+
+    uint32_t readInt()
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            value |= static_cast<uint32_t>(
+                         static_cast<uint8_t>(myData[myPosition / 8 + i]))
+                     << (8 * i);
+        }
+
+        myPosition += 32;
+        return value;
+    }
+
+    bool readBit()
+    {
+        if (myPosition / 8 >= myData.size())
+            return 0;
+
+        uint8_t byte = static_cast<uint8_t>(myData[myPosition / 8]);
+        byte >>= (7 - (myPosition % 8));
+        ++myPosition;
+        return byte & 0x01;
+    }
+
+    int32_t readBits(int n, bool reversed = false)
+    {
+        int32_t value = 0;
+
+        if (reversed)
+        {
+            for (int i = 0; i < n; ++i)
+                value |= (readBit() << i);
+        }
+        else
+        {
+            for (int i = n - 1; i >= 0; --i)
+                value |= (readBit() << i);
+        }
+
+        return value;
+    }
+
+    size_t getLocation() const { return myPosition / 8; }
+
+    bool isAtEnd() const { return getLocation() >= (myData.size() - 1); }
+
+private:
+    std::string myData;
+    size_t myPosition;
+};
+
+std::vector<std::byte> decompress(const std::string &data)
+{
+    std::istringstream stream(data);
+    BitStream input(stream);
+    input.readInt();
+    const uint32_t length = input.readInt();
+
+    std::vector<std::byte> output;
+    output.reserve(length);
+
+    while (!input.isAtEnd() && input.getLocation() < length)
+    {
+        if (!input.readBit())
+        {
+            const int32_t raw_length = input.readBits(2, true);
+            for (int32_t i = 0; i < raw_length; ++i)
+            {
+                output.push_back(
+                    std::byte{ static_cast<uint8_t>(input.readBits(8)) });
+            }
+        }
+        else
+        {
+            const int32_t p = input.readBits(4);
+            const int32_t offset = input.readBits(p, true);
+            const size_t start = output.size() - offset;
+            const int32_t length =
+                std::clamp<int32_t>(input.readBits(p, true), 0, offset);
+
+            std::copy(output.begin() + start, output.begin() + start + length,
+                      std::back_inserter(output));
+        }
+    }
+
+    return output;
+}
+} // namespace Reference
+
+std::vector<std::string> loadFiles(const std::vector<fs::path> &inputs)
+{
+    std::vector<std::string> files;
+    for (const fs::path &path : BenchUtil::findFiles(inputs, { ".gpx" }))
+    {
+        fs::ifstream file(path, std::ios::in | std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        files.push_back(contents.str());
+    }
+
+    return files;
+}
+
+/// Runs the decompressor over all of the files, and returns the throughput
+/// in MB/s of decompressed data.
+template <typename Decompressor>
+double measure(const std::vector<std::string> &files, int iterations,
+               Decompressor &&decompress)
+{
+    size_t total_bytes = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        for (const std::string &file : files)
+            total_bytes += decompress(file).size();
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    return (total_bytes / (1024.0 * 1024.0)) / elapsed.count();
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const BenchUtil::Options options =
+        BenchUtil::parseArgs(argc, argv, PTE_GPX_CORPUS_DIR, 20);
+    const std::vector<std::string> files = loadFiles(options.myInputs);
+    if (files.empty())
+    {
+        std::cerr << "No .gpx files were found." << std::endl;
+        return 1;
+    }
+
+    auto decompress = [](const std::string &data) {
+        std::istringstream stream(data);
+        return Gpx::FileSystem::decompress(stream);
+    };
+
+    // Check that the optimized decompressor produces the same output.
+    for (const std::string &file : files)
+    {
+        if (decompress(file) != Reference::decompress(file))
+        {
+            std::cerr << "Error: decompressed data does not match."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Decompressing " << files.size() << " file(s), "
+              << options.myIterations << " iteration(s)" << std::endl;
+
+    const double baseline = measure(files, options.myIterations,
+                                    &Reference::decompress);
+    const double current = measure(files, options.myIterations, decompress);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  bit-at-a-time:  " << baseline << " MB/s" << std::endl;
+    std::cout << "  word-at-a-time: " << current << " MB/s ("
+              << current / baseline << "x)" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// Measures the layout time for staves that are dense with symbols drawn
+/// above the tab staff (let ring, vibrato, bends, etc).
+/// Usage: pte_bench_layout [--iterations N] [positions...]
+
+#include <painters/layoutinfo.h>
+#include <painters/verticallayout.h>
+#include <score/score.h>
+#include <score/scorelocation.h>
+#include <score/staff.h>
+#include <score/system.h>
+#include <score/voice.h>
+
+#include <QGuiApplication>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Options
+{
+    int myIterations = 200;
+    std::vector<int> myPositionCounts;
+};
+
+Options parseArgs(int argc, char *argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc)
+            options.myIterations = std::max(1, std::stoi(argv[++i]));
+        else if (arg.rfind("-", 0) != 0)
+            options.myPositionCounts.push_back(std::max(1, std::stoi(arg)));
+    }
+
+    if (options.myPositionCounts.empty())
+        options.myPositionCounts = { 32, 128, 512, 2048 };
+
+    return options;
+}
+
+/// Builds a score with a single staff where every position has several
+/// symbols that are grouped across consecutive notes, as well as a mixture of
+/// bends and volume swells.
+void buildScore(Score &score, int num_positions)
+{
+    System system;
+    Staff staff(6);
+    Voice &voice = staff.getVoices()[0];
+
+    for (int i = 0; i < num_positions; ++i)
+    {
+        Position pos(i);
+        pos.setProperty(Position::LetRing);
+        pos.setProperty(i % 2 ? Position::Vibrato : Position::WideVibrato);
+        if (i % 3 != 0)
+            pos.setProperty(Position::PalmMuting);
+        if (i % 5 == 0)
+            pos.setProperty(Position::TremoloPicking);
+        if (i % 7 == 0)
+        {
+            pos.setVolumeSwell(
+                VolumeSwell(VolumeLevel::Off, VolumeLevel::f, 2));
+        }
+
+        Note note(i % 6, 5);
+        if (i % 2 == 0)
+        {
+            // Alternate between bends that are held over several notes and
+            // bends that end immediately.
+            note.setBend(Bend(i % 4 ? Bend::NormalBend : Bend::BendAndHold, 4,
+                              0, i % 4 ? 0 : 2));
+        }
+        pos.insertNote(note);
+
+        voice.insertPosition(pos);
+
+        if (i > 0 && i % 8 == 0)
+            system.insertBarline(Barline(i, Barline::SingleBar));
+    }
+
+    system.getBarlines().back().setPosition(num_positions);
+    system.insertStaff(staff);
+    score.insertSystem(system);
+}
+
+/// Returns the average time in microseconds for running the function.
+template <typename Function>
+double measure(int iterations, Function &&f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f();
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / iterations;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // The standard notation layout requires font metrics.
+    QGuiApplication app(argc, argv);
+    const Options options = parseArgs(argc, argv);
+
+    std::cout << std::right << std::setw(10) << "Positions" << std::setw(16)
+              << "Stacking (us)" << std::setw(16) << "Layout (us)"
+              << std::setw(10) << "Height" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (int num_positions : options.myPositionCounts)
+    {
+        Score score;
+        buildScore(score, num_positions);
+        const ScoreLocation location(score, 0, 0);
+
+        // Stack overlapping groups of varying lengths, from single notes up
+        // to let ring or vibrato groups that span half of the staff.
+        int height = 0;
+        const double stacking_time = measure(options.myIterations, [&]() {
+            VerticalLayout layout;
+            for (int length : { 1, 2, 4, 16, num_positions / 2 })
+            {
+                for (int i = 0; i + length <= num_positions; ++i)
+                    height = std::max(height, layout.addBox(i, i + length, 1));
+            }
+        });
+
+        const double layout_time = measure(options.myIterations, [&]() {
+            LayoutInfo layout(location);
+        });
+
+        std::cout << std::setw(10) << num_positions << std::setw(16)
+                  << stacking_time << std::setw(16) << layout_time
+                  << std::setw(10) << height << std::endl;
+    }
+
+    return 0;
+}
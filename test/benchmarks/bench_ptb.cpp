@@ -0,0 +1,49 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// Measures the import time for Power Tab 1.7 files.
+/// Usage: pte_bench_ptb [--iterations N] [files or directories...]
+/// By default, the files from the test suite are used.
+
+#include "benchutil.h"
+
+#include <formats/powertab_old/powertabdocument/powertabdocument.h>
+#include <formats/powertab_old/powertaboldimporter.h>
+#include <score/score.h>
+
+namespace fs = boost::filesystem;
+
+int main(int argc, char *argv[])
+{
+    PowerTabOldImporter importer;
+    std::vector<BenchUtil::Stage> stages;
+
+    // Read the legacy document.
+    stages.push_back({ "Load", [](const fs::path &path) {
+        PowerTabDocument::Document document;
+        document.Load(path);
+    } });
+
+    // Run the full import, including the conversion to a score.
+    stages.push_back({ "Import", [&](const fs::path &path) {
+        Score score;
+        importer.load(path, score);
+    } });
+
+    return BenchUtil::runFileBenchmark(argc, argv, PTE_PTB_CORPUS_DIR,
+                                       { ".ptb" }, "Power Tab", stages);
+}
@@ -0,0 +1,483 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// Measures the time taken to render scores, split by the phases recorded by
+/// RenderProfiler, along with the number of items and memory allocations for
+/// each system. The scores are rendered with Qt's offscreen platform.
+/// Usage: pte_bench_render [--iterations N] [--systems N] [--json FILE]
+///                         [files or directories...]
+/// By default, a synthetic score and the files from the test suite are used.
+
+#include <app/pubsub/clickpubsub.h>
+#include <app/settingsmanager.h>
+#include <app/viewoptions.h>
+#include <formats/fileformatmanager.h>
+#include <painters/glyphcache.h>
+#include <painters/renderprofiler.h>
+#include <painters/systemrenderer.h>
+#include <score/dynamic.h>
+#include <score/instrument.h>
+#include <score/player.h>
+#include <score/playerchange.h>
+#include <score/score.h>
+#include <score/staff.h>
+#include <score/system.h>
+#include <score/textitem.h>
+#include <score/voice.h>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/prettywriter.h>
+
+#include <QApplication>
+#include <QFontDatabase>
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+std::atomic<uint64_t> theAllocationCount(0);
+std::atomic<uint64_t> theAllocatedBytes(0);
+} // namespace
+
+// Count every allocation made while rendering. The other forms of operator
+// new and delete call these by default.
+void *operator new(std::size_t size)
+{
+    ++theAllocationCount;
+    theAllocatedBytes += size;
+
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+struct Options
+{
+    int myIterations = 5;
+    int myNumSystems = 40;
+    std::optional<fs::path> myJsonFile;
+    std::vector<fs::path> myInputs;
+};
+
+Options parseArgs(int argc, char *argv[])
+{
+    Options options;
+    bool use_corpus = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc)
+            options.myIterations = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--systems" && i + 1 < argc)
+            options.myNumSystems = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc)
+            options.myJsonFile = fs::path(argv[++i]);
+        else
+        {
+            options.myInputs.push_back(arg);
+            use_corpus = false;
+        }
+    }
+
+    if (use_corpus)
+        options.myInputs.push_back(PTE_RENDER_CORPUS_DIR);
+
+    return options;
+}
+
+/// Builds a score with two staves per system, where the notes use a mixture
+/// of durations (for beaming), have symbols that are grouped across
+/// consecutive notes, and have bends, dynamics, and text.
+void buildScore(Score &score, int num_systems)
+{
+    const int num_bars = 4;
+    const int positions_per_bar = 16;
+
+    Player player;
+    score.insertPlayer(player);
+    score.insertInstrument(Instrument());
+
+    for (int s = 0; s < num_systems; ++s)
+    {
+        System system;
+
+        for (int staff_index = 0; staff_index < 2; ++staff_index)
+        {
+            Staff staff(6);
+            Voice &voice = staff.getVoices()[0];
+
+            for (int i = 0; i < num_bars * positions_per_bar; ++i)
+            {
+                Position pos(i, (i % 4 == 3) ? Position::QuarterNote
+                                 : (i % 2)   ? Position::SixteenthNote
+                                             : Position::EighthNote);
+                if (i % 16 < 6)
+                    pos.setProperty(Position::LetRing);
+                if (i % 12 < 4)
+                    pos.setProperty(Position::PalmMuting);
+                if (i % 9 == 0)
+                    pos.setProperty(Position::Vibrato);
+                if (i % 13 == 0)
+                    pos.setProperty(Position::Staccato);
+
+                Note note(i % 6, (i * 3) % 15);
+                if (i % 10 == 0)
+                    note.setBend(Bend(Bend::NormalBend, 4));
+                if (i % 7 == 0)
+                    note.setProperty(Note::HammerOnOrPullOff);
+                pos.insertNote(note);
+
+                // Add a chord to some positions.
+                if (i % 5 == 0)
+                    pos.insertNote(Note((i + 2) % 6, (i * 3 + 2) % 15));
+
+                voice.insertPosition(pos);
+            }
+
+            if (staff_index == 0)
+                staff.insertDynamic(Dynamic(0, VolumeLevel::mf));
+
+            system.insertStaff(staff);
+        }
+
+        for (int bar = 1; bar < num_bars; ++bar)
+        {
+            system.insertBarline(
+                Barline(bar * positions_per_bar, Barline::SingleBar));
+        }
+        system.getBarlines().back().setPosition(num_bars *
+                                                positions_per_bar);
+
+        if (s == 0)
+        {
+            PlayerChange change(0);
+            change.insertActivePlayer(0, ActivePlayer(0, 0));
+            system.insertPlayerChange(change);
+        }
+
+        system.insertTextItem(TextItem(8, "Synthetic"));
+        score.insertSystem(system);
+    }
+}
+
+std::vector<fs::path> findFiles(const std::vector<fs::path> &inputs,
+                                const FileFormatManager &manager)
+{
+    std::vector<fs::path> paths;
+    for (const fs::path &input : inputs)
+    {
+        if (fs::is_directory(input))
+        {
+            for (const fs::directory_entry &entry :
+                 fs::recursive_directory_iterator(input))
+            {
+                if (fs::is_regular_file(entry.status()) &&
+                    manager.findImportFormat(entry.path()))
+                {
+                    paths.push_back(entry.path());
+                }
+            }
+        }
+        else
+            paths.push_back(input);
+    }
+
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+int countItems(const QGraphicsItem *item)
+{
+    int count = 1;
+    for (const QGraphicsItem *child : item->childItems())
+        count += countItems(child);
+
+    return count;
+}
+
+struct SystemStats
+{
+    int myItems = 0;
+    uint64_t myAllocations = 0;
+    uint64_t myAllocatedBytes = 0;
+    /// The average time to render the system and add it to the scene.
+    double myTime = 0;
+};
+
+struct ScoreStats
+{
+    std::string myName;
+    /// The average time to render the score.
+    double myTime = 0;
+    std::vector<SystemStats> mySystems;
+    /// The phase statistics, averaged over the iterations.
+    std::vector<RenderProfiler::PhaseStats> myPhases;
+};
+
+/// Renders the score into a scene. The first iteration is not measured, so
+/// that the glyph cache and fonts are already loaded.
+ScoreStats renderScore(const std::string &name, const Score &score,
+                       int iterations)
+{
+    using Clock = std::chrono::steady_clock;
+    using Microseconds = std::chrono::duration<double, std::micro>;
+
+    const ViewOptions view_options;
+    auto click_pubsub = std::make_shared<ClickPubSub>();
+    const int num_systems = static_cast<int>(score.getSystems().size());
+
+    ScoreStats stats;
+    stats.myName = name;
+    stats.mySystems.resize(num_systems);
+
+    for (int iteration = 0; iteration <= iterations; ++iteration)
+    {
+        const bool measured = iteration > 0;
+        RenderProfiler::setEnabled(measured);
+
+        QGraphicsScene scene;
+        const Clock::time_point start = Clock::now();
+
+        for (int i = 0; i < num_systems; ++i)
+        {
+            const uint64_t allocations = theAllocationCount;
+            const uint64_t allocated_bytes = theAllocatedBytes;
+            const Clock::time_point system_start = Clock::now();
+
+            SystemRenderer render(click_pubsub, score, view_options);
+            QGraphicsItem *system = render(score.getSystems()[i], i);
+            {
+                RenderProfiler::ScopedTimer timer(
+                    RenderProfiler::Phase::SceneInsertion);
+                scene.addItem(system);
+            }
+
+            const Microseconds elapsed = Clock::now() - system_start;
+            if (measured)
+            {
+                SystemStats &system_stats = stats.mySystems[i];
+                system_stats.myTime += elapsed.count() / iterations;
+                system_stats.myAllocations =
+                    theAllocationCount - allocations;
+                system_stats.myAllocatedBytes =
+                    theAllocatedBytes - allocated_bytes;
+                system_stats.myItems = countItems(system);
+            }
+        }
+
+        if (measured)
+        {
+            const Microseconds elapsed = Clock::now() - start;
+            stats.myTime += elapsed.count() / iterations;
+        }
+    }
+
+    RenderProfiler::setEnabled(false);
+
+    for (int i = 0; i < RenderProfiler::NUM_PHASES; ++i)
+    {
+        RenderProfiler::PhaseStats phase =
+            RenderProfiler::getStats(static_cast<RenderProfiler::Phase>(i));
+        phase.myCalls /= iterations;
+        phase.myTotalTime /= iterations;
+        phase.mySelfTime /= iterations;
+        stats.myPhases.push_back(phase);
+    }
+    RenderProfiler::resetStats();
+
+    return stats;
+}
+
+double toMilliseconds(std::chrono::nanoseconds time)
+{
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+void printStats(const ScoreStats &stats)
+{
+    uint64_t total_allocations = 0;
+    int total_items = 0;
+    for (const SystemStats &system : stats.mySystems)
+    {
+        total_allocations += system.myAllocations;
+        total_items += system.myItems;
+    }
+
+    std::cout << stats.myName << ": " << stats.mySystems.size()
+              << " systems, " << total_items << " items, "
+              << total_allocations << " allocations, " << stats.myTime / 1000
+              << " ms" << std::endl;
+
+    for (int i = 0; i < RenderProfiler::NUM_PHASES; ++i)
+    {
+        const RenderProfiler::PhaseStats &phase = stats.myPhases[i];
+        std::cout << "  " << std::left << std::setw(22)
+                  << RenderProfiler::getPhaseName(
+                         static_cast<RenderProfiler::Phase>(i))
+                  << std::right << std::setw(8) << phase.myCalls
+                  << std::setw(12) << toMilliseconds(phase.mySelfTime)
+                  << std::setw(12) << toMilliseconds(phase.myTotalTime)
+                  << std::endl;
+    }
+}
+
+void writeJson(const Options &options, const std::vector<ScoreStats> &scores)
+{
+    fs::ofstream out(*options.myJsonFile);
+    rapidjson::OStreamWrapper stream(out);
+    rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(stream);
+
+    writer.StartObject();
+    writer.Key("iterations");
+    writer.Int(options.myIterations);
+    writer.Key("scores");
+    writer.StartArray();
+
+    for (const ScoreStats &stats : scores)
+    {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(stats.myName.c_str());
+        writer.Key("time_ms");
+        writer.Double(stats.myTime / 1000);
+
+        writer.Key("phases");
+        writer.StartObject();
+        for (int i = 0; i < RenderProfiler::NUM_PHASES; ++i)
+        {
+            const RenderProfiler::PhaseStats &phase = stats.myPhases[i];
+            writer.Key(RenderProfiler::getPhaseName(
+                static_cast<RenderProfiler::Phase>(i)));
+            writer.StartObject();
+            writer.Key("calls");
+            writer.Uint64(phase.myCalls);
+            writer.Key("self_ms");
+            writer.Double(toMilliseconds(phase.mySelfTime));
+            writer.Key("total_ms");
+            writer.Double(toMilliseconds(phase.myTotalTime));
+            writer.EndObject();
+        }
+        writer.EndObject();
+
+        writer.Key("systems");
+        writer.StartArray();
+        for (const SystemStats &system : stats.mySystems)
+        {
+            writer.StartObject();
+            writer.Key("items");
+            writer.Int(system.myItems);
+            writer.Key("allocations");
+            writer.Uint64(system.myAllocations);
+            writer.Key("allocated_bytes");
+            writer.Uint64(system.myAllocatedBytes);
+            writer.Key("time_us");
+            writer.Double(system.myTime);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.EndObject();
+    }
+
+    writer.EndArray();
+    writer.EndObject();
+    out << std::endl;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const Options options = parseArgs(argc, argv);
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QFontDatabase::addApplicationFont(":fonts/emmentaler-13.otf");
+    QFontDatabase::addApplicationFont(":fonts/LiberationSans-Regular.ttf");
+    QFontDatabase::addApplicationFont(":fonts/LiberationSerif-Regular.ttf");
+
+    SettingsManager settings_manager;
+    FileFormatManager manager(settings_manager);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  " << std::left << std::setw(22) << "Phase" << std::right
+              << std::setw(8) << "Calls" << std::setw(12) << "Self (ms)"
+              << std::setw(12) << "Total (ms)" << std::endl;
+
+    std::vector<ScoreStats> scores;
+
+    if (options.myNumSystems > 0)
+    {
+        Score score;
+        buildScore(score, options.myNumSystems);
+        scores.push_back(
+            renderScore("synthetic", score, options.myIterations));
+        printStats(scores.back());
+    }
+
+    for (const fs::path &path : findFiles(options.myInputs, manager))
+    {
+        try
+        {
+            std::optional<FileFormat> format = manager.findImportFormat(path);
+            if (!format)
+                throw std::runtime_error("Unsupported file type.");
+
+            Score score;
+            manager.importFile(score, path, *format);
+            scores.push_back(renderScore(path.filename().string(), score,
+                                         options.myIterations));
+            printStats(scores.back());
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error reading " << path.string() << ": " << e.what()
+                      << std::endl;
+        }
+    }
+
+    if (options.myJsonFile)
+        writeJson(options, scores);
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BENCHMARKS_BENCHUTIL_H
+#define BENCHMARKS_BENCHUTIL_H
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// Helpers that are shared by the file format benchmarks.
+namespace BenchUtil
+{
+namespace fs = boost::filesystem;
+
+struct Options
+{
+    int myIterations = 100;
+    std::vector<fs::path> myInputs;
+};
+
+/// Parses "[--iterations N] [files or directories...]". If no inputs are
+/// given, the default input (e.g. the test suite's files) is used.
+inline Options parseArgs(int argc, char *argv[],
+                         const fs::path &default_input,
+                         int default_iterations = 100)
+{
+    Options options;
+    options.myIterations = default_iterations;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc)
+            options.myIterations = std::max(1, std::stoi(argv[++i]));
+        else
+            options.myInputs.push_back(arg);
+    }
+
+    if (options.myInputs.empty())
+        options.myInputs.push_back(default_input);
+
+    return options;
+}
+
+/// Returns the input files, along with the files with one of the given
+/// extensions (e.g. ".ptb") that are found by searching the input
+/// directories. The files are sorted by path.
+inline std::vector<fs::path> findFiles(
+    const std::vector<fs::path> &inputs,
+    const std::vector<std::string> &extensions)
+{
+    std::vector<fs::path> paths;
+    for (const fs::path &input : inputs)
+    {
+        if (fs::is_directory(input))
+        {
+            for (const fs::directory_entry &entry :
+                 fs::recursive_directory_iterator(input))
+            {
+                if (fs::is_regular_file(entry.status()) &&
+                    std::find(extensions.begin(), extensions.end(),
+                              entry.path().extension().string()) !=
+                        extensions.end())
+                {
+                    paths.push_back(entry.path());
+                }
+            }
+        }
+        else
+            paths.push_back(input);
+    }
+
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+/// Returns the average time in microseconds for running the function.
+template <typename Function>
+double measure(int iterations, Function &&f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f();
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / iterations;
+}
+
+/// A stage of reading a file (e.g. parsing or a full import) that is timed
+/// separately.
+struct Stage
+{
+    std::string myName;
+    std::function<void(const fs::path &)> myRun;
+};
+
+/// Times each stage for every file found from the command line, and prints
+/// the average times for each file along with the totals.
+/// @param format_name The name of the file format, for error messages.
+/// @return The exit code for main().
+inline int runFileBenchmark(int argc, char *argv[],
+                            const fs::path &default_input,
+                            const std::vector<std::string> &extensions,
+                            const std::string &format_name,
+                            const std::vector<Stage> &stages)
+{
+    const Options options = parseArgs(argc, argv, default_input);
+    const std::vector<fs::path> files = findFiles(options.myInputs, extensions);
+    if (files.empty())
+    {
+        std::cerr << "No " << format_name << " files were found." << std::endl;
+        return 1;
+    }
+
+    const int name_width = 32;
+    const int size_width = 10;
+    const int time_width = 16;
+
+    std::cout << std::left << std::setw(name_width) << "File" << std::right
+              << std::setw(size_width) << "Bytes";
+    for (const Stage &stage : stages)
+        std::cout << std::setw(time_width) << stage.myName + " (us)";
+    std::cout << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    std::vector<double> totals(stages.size(), 0.0);
+    for (const fs::path &path : files)
+    {
+        try
+        {
+            std::vector<double> times;
+            for (const Stage &stage : stages)
+            {
+                times.push_back(measure(options.myIterations,
+                                        [&]() { stage.myRun(path); }));
+            }
+
+            std::cout << std::left << std::setw(name_width)
+                      << path.filename().string() << std::right
+                      << std::setw(size_width) << fs::file_size(path);
+            for (size_t i = 0; i < times.size(); ++i)
+            {
+                std::cout << std::setw(time_width) << times[i];
+                totals[i] += times[i];
+            }
+            std::cout << std::endl;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error reading " << path.string() << ": " << e.what()
+                      << std::endl;
+        }
+    }
+
+    std::cout << std::left << std::setw(name_width + size_width) << "Total"
+              << std::right;
+    for (double total : totals)
+        std::cout << std::setw(time_width) << total;
+    std::cout << std::endl;
+
+    return 0;
+}
+} // namespace BenchUtil
+
+#endif
@@ -18,7 +18,10 @@
 #include <doctest/doctest.h>
 
 #include <app/appinfo.h>
+#include <formats/fileformat.h>
 #include <formats/gp7/gp7importer.h>
+#include <formats/gp7/parser.h>
+#include <formats/scoremetadata.h>
 #include <score/generalmidi.h>
 #include <score/keysignature.h>
 #include <score/note.h>
@@ -865,3 +868,72 @@ TEST_CASE("Formats/Gp7Import/Harmonics")
                        Octave::Octave15ma);
     }
 }
+
+TEST_CASE("Formats/Gp7Import/Probe")
+{
+    Gp7Importer importer;
+    const std::string filename = AppInfo::getAbsolutePath("data/tracks.gp");
+
+    Score score;
+    importer.load(filename, score);
+    const ScoreMetadata expected = ScoreMetadata::fromScore(score);
+
+    ScoreMetadata metadata;
+    REQUIRE_NOTHROW(metadata = importer.probe(filename));
+
+    REQUIRE(metadata.myScoreInfo == score.getScoreInfo());
+    REQUIRE(metadata.myInstruments.size() == 4);
+    REQUIRE(metadata.myInstruments[0].myName == "Jazz Guitar");
+    REQUIRE(metadata.myInstruments[0].myStringCount == 6);
+    REQUIRE(metadata.myBarCount == expected.myBarCount);
+    REQUIRE(metadata.myDuration);
+    REQUIRE(metadata.myDuration->count() ==
+            doctest::Approx(expected.myDuration->count()));
+}
+
+TEST_CASE("Formats/Gp7Import/Parser")
+{
+    auto parse = [](const char *xml) {
+        pugi::xml_document doc;
+        REQUIRE(doc.load_string(xml, Gp7::PARSE_OPTIONS));
+        return Gp7::parse(doc, Gp7::Version::V7);
+    };
+
+    SUBCASE("Id lists")
+    {
+        Gp7::Document doc = parse(
+            "<GPIF><Bars><Bar id=\"1\"><Clef>F4</Clef>"
+            "<Voices>3 -1 -1 -1</Voices></Bar></Bars></GPIF>");
+
+        REQUIRE_THROWS_AS(doc.myBars.at(0), std::out_of_range);
+        const Gp7::Bar &bar = doc.myBars.at(1);
+        REQUIRE(bar.myClefType == Gp7::Bar::ClefType::F4);
+        REQUIRE(bar.myVoiceIds == std::vector<int>{ 3, -1, -1, -1 });
+    }
+
+    SUBCASE("Invalid id list")
+    {
+        REQUIRE_THROWS_AS(parse("<GPIF><Voices><Voice id=\"0\">"
+                                "<Beats>0 x</Beats></Voice></Voices></GPIF>"),
+                          FileFormatException);
+    }
+
+    SUBCASE("Sparse ids")
+    {
+        Gp7::Document doc = parse(
+            "<GPIF><Voices><Voice id=\"100000\"><Beats>0</Beats></Voice>"
+            "<Voice id=\"2\"><Beats>1 2</Beats></Voice></Voices></GPIF>");
+
+        REQUIRE(doc.myVoices.at(100000).myBeatIds == std::vector<int>{ 0 });
+        REQUIRE(doc.myVoices.at(2).myBeatIds == std::vector<int>{ 1, 2 });
+        REQUIRE_THROWS_AS(doc.myVoices.at(1), std::out_of_range);
+        REQUIRE_THROWS_AS(doc.myVoices.at(99999), std::out_of_range);
+    }
+
+    SUBCASE("Invalid id")
+    {
+        REQUIRE_THROWS_AS(parse("<GPIF><Voices><Voice id=\"-1\">"
+                                "<Beats>0</Beats></Voice></Voices></GPIF>"),
+                          FileFormatException);
+    }
+}
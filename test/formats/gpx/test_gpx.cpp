@@ -18,9 +18,69 @@
 #include <doctest/doctest.h>
 
 #include <app/appinfo.h>
+#include <boost/filesystem/fstream.hpp>
+#include <formats/fileformat.h>
+#include <formats/gpx/bitstream.h>
+#include <formats/gpx/filesystem.h>
 #include <formats/gpx/gpximporter.h>
+#include <formats/scoremetadata.h>
 #include <score/score.h>
 
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+/// Compresses the data into a BCFZ archive, using only uncompressed chunks.
+std::string compress(const std::vector<uint8_t> &data)
+{
+    std::vector<bool> bits;
+    auto writeBits = [&](uint32_t value, int n) {
+        for (int i = n - 1; i >= 0; --i)
+            bits.push_back((value >> i) & 1);
+    };
+
+    for (size_t i = 0; i < data.size(); i += 3)
+    {
+        const uint32_t n = static_cast<uint32_t>(
+            std::min<size_t>(3, data.size() - i));
+
+        // Chunk type, followed by the length in reversed bit order.
+        writeBits(0, 1);
+        writeBits(((n & 1) << 1) | (n >> 1), 2);
+        for (size_t j = i; j < i + n; ++j)
+            writeBits(data[j], 8);
+    }
+
+    // The expected length is only used as a hint, so leave plenty of room.
+    std::string output("BCFZ");
+    const uint32_t length = static_cast<uint32_t>(2 * data.size());
+    for (int i = 0; i < 4; ++i)
+        output += static_cast<char>((length >> (8 * i)) & 0xff);
+
+    for (size_t i = 0; i < bits.size(); i += 8)
+    {
+        uint8_t byte = 0;
+        for (size_t j = i; j < i + 8; ++j)
+        {
+            const bool bit = j < bits.size() && bits[j];
+            byte = static_cast<uint8_t>((byte << 1) | bit);
+        }
+        output += static_cast<char>(byte);
+    }
+
+    // Padding, since the last byte of the stream is not read.
+    output += std::string(4, '\0');
+    return output;
+}
+
+void writeUInt(std::vector<uint8_t> &data, size_t offset, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        data[offset + i] = static_cast<uint8_t>((value >> (8 * i)) & 0xff);
+}
+} // namespace
+
 TEST_CASE("Formats/GpxImport/Text")
 {
     Score score;
@@ -33,3 +93,112 @@ TEST_CASE("Formats/GpxImport/Text")
     REQUIRE(system.getTextItems()[0].getPosition() == 9);
     REQUIRE(system.getTextItems()[0].getContents() == "foo");
 }
+
+TEST_CASE("Formats/GpxImport/Probe")
+{
+    GpxImporter importer;
+    const std::string filename = AppInfo::getAbsolutePath("data/text.gpx");
+
+    Score score;
+    importer.load(filename, score);
+    const ScoreMetadata expected = ScoreMetadata::fromScore(score);
+
+    ScoreMetadata metadata;
+    REQUIRE_NOTHROW(metadata = importer.probe(filename));
+
+    REQUIRE(metadata.myScoreInfo == score.getScoreInfo());
+    REQUIRE(metadata.myInstruments.size() == score.getPlayers().size());
+    REQUIRE(metadata.myBarCount == expected.myBarCount);
+    REQUIRE(metadata.myDuration);
+    REQUIRE(metadata.myDuration->count() ==
+            doctest::Approx(expected.myDuration->count()));
+}
+
+TEST_CASE("Formats/GpxImport/BitStream")
+{
+    std::vector<std::byte> bytes;
+    for (uint8_t b : { 0x42, 0x43, 0x46, 0x5a, 0b10110010, 0xff, 0x01, 0x80,
+                       0x12, 0x34, 0x56 })
+    {
+        bytes.push_back(std::byte{ b });
+    }
+
+    Gpx::BitStream stream(bytes);
+    REQUIRE(stream.readInt() == 0x5a464342);
+    REQUIRE(stream.getLocation() == 4);
+
+    REQUIRE(stream.readBit() == true);
+    REQUIRE(stream.readBits(3) == 0b011);
+    REQUIRE(stream.readBits(3, Gpx::BitStream::Reversed) == 0b100);
+
+    // Read bytes that are not aligned to a byte boundary.
+    std::byte unaligned[3];
+    stream.readBytes(unaligned, 3);
+    REQUIRE(unaligned[0] == std::byte{ 0x7f });
+    REQUIRE(unaligned[1] == std::byte{ 0x80 });
+    REQUIRE(unaligned[2] == std::byte{ 0xc0 });
+    REQUIRE(stream.getLocation() == 7);
+
+    REQUIRE(stream.readBits(24) == 0x091a2b);
+    REQUIRE(stream.isAtEnd());
+
+    // Reading past the end produces zeros.
+    REQUIRE(stream.readBits(32) == 0);
+    REQUIRE(stream.getLocation() == bytes.size());
+}
+
+TEST_CASE("Formats/GpxImport/FileSystem")
+{
+    boost::filesystem::ifstream file(AppInfo::getAbsolutePath("data/text.gpx"),
+                                     std::ios::binary | std::ios::in);
+    Gpx::FileSystem fs(file);
+
+    const Gpx::FileSystem::FileView score = fs.getFileContents("score.gpif");
+    REQUIRE(score.mySize == 10083);
+    const std::string contents(reinterpret_cast<const char *>(score.myData),
+                               score.mySize);
+    REQUIRE(contents.find("<GPIF>") != std::string::npos);
+
+    // A file that spans several sectors.
+    REQUIRE(fs.getFileContents("BinaryStylesheet").mySize == 12204);
+
+    REQUIRE_THROWS_AS(fs.getFileContents("missing.xml"), FileFormatException);
+}
+
+TEST_CASE("Formats/GpxImport/UntrustedLength")
+{
+    // The expected length in the header is far larger than the data could
+    // possibly decompress to.
+    std::string data("BCFZ\xff\xff\xff\xff", 8);
+    // A one byte literal, followed by empty literals.
+    data += std::string("\x40\x00\x00\x00\x00\x00\x00\x00", 8);
+    std::istringstream stream(data);
+
+    std::vector<std::byte> output;
+    REQUIRE_NOTHROW(output = Gpx::FileSystem::decompress(stream));
+    REQUIRE(output.size() < data.size() * 8);
+}
+
+TEST_CASE("Formats/GpxImport/InvalidSectors")
+{
+    const size_t sector_size = 0x1000;
+    const size_t header_size = 4;
+
+    // Create a filesystem with a single file entry in the second sector.
+    std::vector<uint8_t> data(header_size + 2 * sector_size, 0);
+    writeUInt(data, 0, 0x53464342);
+
+    const size_t entry = header_size + sector_size;
+    writeUInt(data, entry, 2);
+    const std::string filename = "score.gpif";
+    std::copy(filename.begin(), filename.end(), data.begin() + entry + 4);
+    writeUInt(data, entry + 0x8C, sector_size);
+
+    // Adjacent sectors whose offsets overflow a 32-bit integer.
+    writeUInt(data, entry + 0x94, 0xfffff);
+    writeUInt(data, entry + 0x98, 0x100000);
+
+    std::istringstream stream(compress(data));
+    Gpx::FileSystem fs(stream);
+    REQUIRE_THROWS_AS(fs.getFileContents(filename), FileFormatException);
+}
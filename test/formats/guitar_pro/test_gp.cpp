@@ -18,7 +18,10 @@
 #include <doctest/doctest.h>
 
 #include <app/appinfo.h>
+#include <formats/fileformat.h>
 #include <formats/guitar_pro/guitarproimporter.h>
+#include <formats/guitar_pro/inputstream.h>
+#include <formats/scoremetadata.h>
 #include <score/score.h>
 
 static void loadTest(GuitarProImporter &importer, const char *filename,
@@ -502,3 +505,72 @@ TEST_CASE("Formats/GuitarPro/Bends")
         REQUIRE(note.getBend().getBentPitch() == 4);
     }
 }
+
+TEST_CASE("Formats/GuitarPro/Probe")
+{
+    GuitarProImporter importer;
+    const std::string filename =
+        AppInfo::getAbsolutePath("data/time_signatures.gp5");
+
+    Score score;
+    importer.load(filename, score);
+    const ScoreMetadata expected = ScoreMetadata::fromScore(score);
+
+    ScoreMetadata metadata;
+    REQUIRE_NOTHROW(metadata = importer.probe(filename));
+
+    REQUIRE(metadata.myScoreInfo == score.getScoreInfo());
+    REQUIRE(metadata.myInstruments.size() == score.getPlayers().size());
+    for (size_t i = 0; i < metadata.myInstruments.size(); ++i)
+    {
+        const Player &player = score.getPlayers()[i];
+        REQUIRE(metadata.myInstruments[i].myName == player.getDescription());
+        REQUIRE(metadata.myInstruments[i].myStringCount ==
+                player.getTuning().getStringCount());
+    }
+    REQUIRE(metadata.myBarCount == expected.myBarCount);
+    REQUIRE(metadata.myDuration);
+    REQUIRE(metadata.myDuration->count() ==
+            doctest::Approx(expected.myDuration->count()));
+}
+
+TEST_CASE("Formats/GuitarPro/InputStream")
+{
+    using namespace std::string_literals;
+
+    // A version string, followed by a length-prefixed string and an integer.
+    std::string data;
+    const std::string version = "FICHIER GUITAR PRO v5.00";
+    data += static_cast<char>(version.size());
+    data += version;
+    data.resize(31, '\0');
+    data += "\x0a\x00\x00\x00\x09The title"s;
+    data += "\x2a\x00\x00\x00"s;
+
+    auto bytes = reinterpret_cast<const std::byte *>(data.data());
+
+    SUBCASE("Read values")
+    {
+        Gp::InputStream stream(bytes, data.size());
+        REQUIRE(stream.version() == Gp::Version5_0);
+        REQUIRE(stream.readString() == "The title");
+        REQUIRE(stream.read<uint32_t>() == 42);
+        REQUIRE_THROWS_AS(stream.readBool(), FileFormatException);
+    }
+
+    SUBCASE("Truncated string")
+    {
+        Gp::InputStream stream(bytes, data.size() - 8);
+        REQUIRE_THROWS_AS(stream.readString(), FileFormatException);
+    }
+
+    SUBCASE("Unsupported version")
+    {
+        std::string invalid = data;
+        invalid[21] = '9';
+        REQUIRE_THROWS_AS(
+            Gp::InputStream(reinterpret_cast<const std::byte *>(invalid.data()),
+                            invalid.size()),
+            FileFormatException);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <doctest/doctest.h>
+
+#include <app/appinfo.h>
+#include <app/settingsmanager.h>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <formats/midi/midiexporter.h>
+#include <formats/powertab/powertabimporter.h>
+#include <score/score.h>
+#include <sstream>
+#include <util/scopeexit.h>
+
+static uint32_t readUInt32(const std::string &data, size_t offset)
+{
+    uint32_t val = 0;
+    for (size_t i = 0; i < 4; ++i)
+        val = (val << 8) | static_cast<uint8_t>(data[offset + i]);
+
+    return val;
+}
+
+TEST_CASE("Formats/MidiExport/Chunks")
+{
+    Score score;
+    PowerTabImporter importer;
+    importer.load(AppInfo::getAbsolutePath("data/test_viewfilter.pt2"), score);
+
+    SettingsManager settings_manager;
+    MidiExporter exporter(settings_manager);
+    std::ostringstream os;
+    exporter.save(os, score);
+    const std::string data = os.str();
+
+    REQUIRE(data.size() >= 14);
+    REQUIRE(data.substr(0, 4) == "MThd");
+    REQUIRE(readUInt32(data, 4) == 6);
+    const int num_tracks = (static_cast<uint8_t>(data[10]) << 8) |
+                           static_cast<uint8_t>(data[11]);
+    REQUIRE(num_tracks > 0);
+
+    // Each track chunk's length should match its contents, with no data
+    // after the last track.
+    size_t offset = 14;
+    for (int i = 0; i < num_tracks; ++i)
+    {
+        REQUIRE(offset + 8 <= data.size());
+        REQUIRE(data.substr(offset, 4) == "MTrk");
+        const uint32_t length = readUInt32(data, offset + 4);
+        offset += 8 + length;
+
+        // Every track ends with an end of track meta event.
+        REQUIRE(offset <= data.size());
+        const std::string track_end("\xff\x2f\x00", 3);
+        REQUIRE(data.substr(offset - 3, 3) == track_end);
+    }
+    REQUIRE(offset == data.size());
+
+    SUBCASE("File")
+    {
+        namespace fs = boost::filesystem;
+
+        const fs::path path = fs::temp_directory_path() /
+                              fs::unique_path("pte-midi-%%%%-%%%%.mid");
+        Util::ScopeExit cleanup([&]() { fs::remove(path); });
+        exporter.save(path, score);
+
+        fs::ifstream file(path, std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        REQUIRE(contents.str() == data);
+    }
+}
@@ -0,0 +1,139 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <doctest/doctest.h>
+
+#include <app/appinfo.h>
+#include <formats/fileformat.h>
+#include <formats/midi/midiimporter.h>
+#include <formats/scoremetadata.h>
+#include <score/note.h>
+#include <score/score.h>
+
+// The file has a guitar track, a bass track, and a drum track, in 3/4 time
+// at 100 bpm with two sharps.
+TEST_CASE("Formats/MidiImport/Notes")
+{
+    Score score;
+    MidiImporter importer;
+    REQUIRE_NOTHROW(
+        importer.load(AppInfo::getAbsolutePath("data/notes.mid"), score));
+
+    // The drum track is not imported.
+    REQUIRE(score.getPlayers().size() == 2);
+    REQUIRE(score.getPlayers()[0].getDescription() == "Guitar");
+    REQUIRE(score.getPlayers()[0].getTuning().getStringCount() == 6);
+    // Tracks without a name use the instrument's name.
+    REQUIRE(score.getPlayers()[1].getDescription() == "Electric Bass (finger)");
+    REQUIRE(score.getPlayers()[1].getTuning().getStringCount() == 4);
+    REQUIRE(score.getInstruments().size() == 2);
+    REQUIRE(score.getInstruments()[0].getMidiPreset() == 25);
+    REQUIRE(score.getInstruments()[1].getMidiPreset() == 33);
+
+    REQUIRE(score.getSystems().size() == 1);
+    const System &system = score.getSystems()[0];
+    REQUIRE(system.getBarlines().size() == 4);
+    REQUIRE(system.getBarlines().back().getBarType() == Barline::DoubleBarFine);
+
+    const Barline &first_bar = system.getBarlines()[0];
+    REQUIRE(first_bar.getTimeSignature().getBeatsPerMeasure() == 3);
+    REQUIRE(first_bar.getTimeSignature().getBeatValue() == 4);
+    REQUIRE(first_bar.getTimeSignature().isVisible());
+    REQUIRE(first_bar.getKeySignature().getNumAccidentals() == 2);
+    REQUIRE(first_bar.getKeySignature().usesSharps());
+
+    REQUIRE(system.getTempoMarkers().size() == 1);
+    REQUIRE(system.getTempoMarkers()[0].getBeatsPerMinute() == 100);
+
+    REQUIRE(system.getStaves()[0].getClefType() == Staff::TrebleClef);
+    REQUIRE(system.getStaves()[1].getClefType() == Staff::BassClef);
+
+    const Voice &guitar = system.getStaves()[0].getVoices()[0];
+    std::vector<const Position *> positions;
+    for (const Position &pos : guitar.getPositions())
+        positions.push_back(&pos);
+    REQUIRE(positions.size() == 11);
+
+    // A chord, which is assigned to separate strings.
+    REQUIRE(positions[0]->getDurationType() == Position::QuarterNote);
+    REQUIRE(positions[0]->getNotes().size() == 3);
+    REQUIRE(positions[0]->getNotes()[0].getString() == 0);
+    REQUIRE(positions[0]->getNotes()[0].getFretNumber() == 3);
+    REQUIRE(positions[0]->getNotes()[2].getString() == 2);
+    REQUIRE(positions[0]->getNotes()[2].getFretNumber() == 5);
+
+    // Slightly late sixteenth notes are quantized.
+    for (int i = 1; i <= 4; ++i)
+    {
+        REQUIRE(positions[i]->getDurationType() == Position::SixteenthNote);
+        REQUIRE(positions[i]->getNotes().size() == 1);
+    }
+
+    // Eighth note triplets.
+    REQUIRE(guitar.getIrregularGroupings().size() == 1);
+    const IrregularGrouping &group = guitar.getIrregularGroupings()[0];
+    REQUIRE(group.getPosition() == positions[5]->getPosition());
+    REQUIRE(group.getLength() == 3);
+    REQUIRE(group.getNotesPlayed() == 3);
+    REQUIRE(group.getNotesPlayedOver() == 2);
+    REQUIRE(positions[5]->getDurationType() == Position::EighthNote);
+
+    // A note that is held across the barline.
+    REQUIRE(positions[8]->getDurationType() == Position::HalfNote);
+    REQUIRE(positions[8]->hasProperty(Position::Dotted));
+    REQUIRE(!positions[8]->getNotes()[0].hasProperty(Note::Tied));
+    REQUIRE(positions[9]->getDurationType() == Position::HalfNote);
+    REQUIRE(positions[9]->getNotes()[0].hasProperty(Note::Tied));
+    REQUIRE(positions[10]->getDurationType() == Position::QuarterNote);
+
+    // A note below the bass's range is moved up an octave, and the last bar
+    // is filled with a rest.
+    const Voice &bass = system.getStaves()[1].getVoices()[0];
+    REQUIRE(bass.getPositions().size() == 3);
+    REQUIRE(bass.getPositions()[0].getNotes()[0].getString() == 3);
+    REQUIRE(bass.getPositions()[0].getNotes()[0].getFretNumber() == 0);
+    REQUIRE(bass.getPositions()[1].getNotes()[0].getString() == 3);
+    REQUIRE(bass.getPositions()[1].getNotes()[0].getFretNumber() == 4);
+    REQUIRE(bass.getPositions()[2].isRest());
+}
+
+TEST_CASE("Formats/MidiImport/Probe")
+{
+    MidiImporter importer;
+    const ScoreMetadata metadata =
+        importer.probe(AppInfo::getAbsolutePath("data/notes.mid"));
+
+    REQUIRE(metadata.myInstruments.size() == 2);
+    REQUIRE(metadata.myInstruments[0].myName == "Guitar");
+    REQUIRE(metadata.myInstruments[1].myStringCount == 4);
+    REQUIRE(metadata.myBarCount == 3);
+    REQUIRE(metadata.myDuration);
+    REQUIRE(metadata.myDuration->count() == doctest::Approx(5.4));
+}
+
+TEST_CASE("Formats/MidiImport/Invalid")
+{
+    MidiImporter importer;
+    REQUIRE(importer.canRead(std::string_view("MThd\0\0\0\x06", 8)));
+    REQUIRE(!importer.canRead("RIFF"));
+
+    // A Power Tab file is not a MIDI file.
+    Score score;
+    REQUIRE_THROWS_AS(
+        importer.load(AppInfo::getAbsolutePath("data/notes.ptb"), score),
+        FileFormatException);
+}
@@ -21,6 +21,7 @@
 #include <formats/powertab/powertabimporter.h>
 #include <formats/powertab_old/powertaboldimporter.h>
 #include <formats/powertab_old/powertabdocument/powertabdocument.h>
+#include <formats/scoremetadata.h>
 #include <score/score.h>
 
 static void loadTest(FileFormatImporter &importer, const char *filename,
@@ -394,3 +395,23 @@ TEST_CASE("Formats/PowerTabOldImport/VolumeSwells")
     REQUIRE(swell.getEndVolume() == VolumeLevel::fff);
     REQUIRE(swell.getDuration() == 2);
 }
+
+TEST_CASE("Formats/PowerTabOldImport/Probe")
+{
+    PowerTabOldImporter importer;
+    ScoreMetadata metadata;
+    REQUIRE_NOTHROW(metadata = importer.probe(
+                        AppInfo::getAbsolutePath("data/guitars.ptb")));
+
+    // Two players from the guitar score and one from the bass score.
+    REQUIRE(metadata.myInstruments.size() == 3);
+    REQUIRE(metadata.myInstruments[0].myName == "First Player");
+    REQUIRE(metadata.myInstruments[1].myName == "Second Player");
+    REQUIRE(metadata.myInstruments[1].myStringCount == 7);
+    REQUIRE(metadata.myInstruments[2].myStringCount == 4);
+
+    REQUIRE_NOTHROW(metadata = importer.probe(
+                        AppInfo::getAbsolutePath("data/song_header.ptb")));
+    REQUIRE(metadata.myScoreInfo.getSongData().getTitle() == "Some Title");
+    REQUIRE(metadata.myScoreInfo.getSongData().getArtist() == "Some Artist");
+}
@@ -17,7 +17,17 @@
 
 #include <doctest/doctest.h>
 
+#include <app/appinfo.h>
+#include <app/settingsmanager.h>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <formats/fileformat.h>
+#include <formats/fileformatmanager.h>
+#include <score/score.h>
+#include <util/scopeexit.h>
+
+#include <atomic>
+#include <iterator>
 
 TEST_CASE("Formats/FileFormat/FileFilterSingle")
 {
@@ -32,3 +42,157 @@ TEST_CASE("Formats/FileFormat/FileFilterMulti")
 
     CHECK(format.fileFilter() == "Test Format (*.gp3 *.gp4 *.gp5)");
 }
+
+TEST_CASE("Formats/FileFormatManager/DetectFormat")
+{
+    SettingsManager settings_manager;
+    FileFormatManager manager(settings_manager);
+
+    auto detect = [&](const char *filename) {
+        return manager.detectFormat(AppInfo::getAbsolutePath(filename));
+    };
+
+    CHECK(detect("data/test_viewfilter.pt2") == manager.findFormat("pt2"));
+    CHECK(detect("data/guitars.ptb") == manager.findFormat("ptb"));
+    CHECK(detect("data/time_signatures.gp5") == manager.findFormat("gp5"));
+    CHECK(detect("data/text.gpx") == manager.findFormat("gpx"));
+    CHECK(detect("data/tracks.gp") == manager.findFormat("gp"));
+    CHECK(detect("data/notes.mid") == manager.findFormat("mid"));
+    CHECK(!detect("data/does_not_exist.pt2"));
+}
+
+TEST_CASE("Formats/FileFormatManager/DetectMislabeledFormat")
+{
+    namespace fs = boost::filesystem;
+
+    SettingsManager settings_manager;
+    FileFormatManager manager(settings_manager);
+
+    const fs::path dir = fs::temp_directory_path() /
+                         fs::unique_path("pte-detect-%%%%-%%%%");
+    fs::create_directories(dir);
+    Util::ScopeExit cleanup([&]() { fs::remove_all(dir); });
+
+    SUBCASE("Wrong extension")
+    {
+        // A Guitar Pro 6 file with a Power Tab extension.
+        const fs::path path = dir / "text.pt2";
+        fs::copy_file(AppInfo::getAbsolutePath("data/text.gpx"), path);
+
+        CHECK(manager.detectFormat(path) == manager.findFormat("gpx"));
+        CHECK(manager.findImportFormat(path) == manager.findFormat("gpx"));
+    }
+
+    SUBCASE("Unrecognized contents")
+    {
+        const fs::path path = dir / "notes.gp5";
+        {
+            fs::ofstream file(path);
+            file << "Not a Guitar Pro file";
+        }
+
+        CHECK(!manager.detectFormat(path));
+        // Fall back to the file extension.
+        CHECK(manager.findImportFormat(path) == manager.findFormat("gp5"));
+    }
+
+    SUBCASE("Other zip archive")
+    {
+        // A zip file that doesn't contain a score (e.g. a .docx file) should
+        // not be mistaken for a Guitar Pro 7 file.
+        const fs::path path = dir / "document.docx";
+        {
+            const std::string name = "word/document.xml";
+            fs::ofstream file(path, std::ios::out | std::ios::binary);
+            file << std::string("PK\x03\x04", 4) << std::string(22, '\0')
+                 << static_cast<char>(name.size()) << std::string(3, '\0')
+                 << name;
+        }
+
+        CHECK(!manager.detectFormat(path));
+        CHECK(!manager.findImportFormat(path));
+    }
+
+    SUBCASE("Empty file")
+    {
+        const fs::path path = dir / "empty";
+        fs::ofstream file(path);
+        file.close();
+
+        CHECK(!manager.detectFormat(path));
+        CHECK(!manager.findImportFormat(path));
+    }
+}
+
+TEST_CASE("Formats/FileFormatManager/ExportFile")
+{
+    namespace fs = boost::filesystem;
+
+    SettingsManager settings_manager;
+    FileFormatManager manager(settings_manager);
+    const FileFormat format = *manager.findExportFormat("pt2");
+
+    const fs::path dir = fs::temp_directory_path() /
+                         fs::unique_path("pte-export-%%%%-%%%%");
+    fs::create_directories(dir);
+    Util::ScopeExit cleanup([&]() { fs::remove_all(dir); });
+
+    const fs::path path = dir / "test.pt2";
+    {
+        fs::ofstream file(path);
+        file << "Existing file";
+    }
+
+    auto readFile = [&]() {
+        fs::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file),
+                           std::istreambuf_iterator<char>());
+    };
+
+    // The temporary file should never be left behind.
+    auto numFiles = [&]() {
+        return std::distance(fs::directory_iterator(dir),
+                             fs::directory_iterator());
+    };
+
+    Score score;
+    score.insertSystem(System());
+
+    SUBCASE("Replaces the existing file")
+    {
+        CHECK(manager.exportFile(score, path, format));
+        CHECK(readFile() != "Existing file");
+        CHECK(numFiles() == 1);
+
+        Score imported;
+        manager.importFile(imported, path, format);
+        CHECK(imported.getSystems().size() == 1);
+    }
+
+    SUBCASE("Keeps the file's permissions")
+    {
+        const fs::perms perms =
+            fs::owner_read | fs::owner_write | fs::group_read;
+        fs::permissions(path, perms);
+
+        CHECK(manager.exportFile(score, path, format));
+        CHECK(readFile() != "Existing file");
+        CHECK(fs::status(path).permissions() == perms);
+    }
+
+    SUBCASE("Cancelled")
+    {
+        std::atomic<bool> cancelled(true);
+        CHECK(!manager.exportFile(score, path, format, &cancelled));
+        CHECK(readFile() == "Existing file");
+        CHECK(numFiles() == 1);
+    }
+
+    SUBCASE("Failed write")
+    {
+        CHECK_THROWS(
+            manager.exportFile(score, dir / "missing" / "test.pt2", format));
+        CHECK(readFile() == "Existing file");
+        CHECK(numFiles() == 1);
+    }
+}
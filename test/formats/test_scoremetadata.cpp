@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2020 Cameron White
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+  
+#include <doctest/doctest.h>
+
+#include <app/appinfo.h>
+#include <app/settingsmanager.h>
+#include <formats/fileformatmanager.h>
+#include <formats/powertab/powertabimporter.h>
+#include <formats/scoremetadata.h>
+#include <score/score.h>
+
+TEST_CASE("Formats/ScoreMetadata/Duration")
+{
+    DurationEstimator duration;
+    REQUIRE(duration.getDuration().count() == doctest::Approx(0));
+
+    // Two bars of 4/4 at the default tempo of 120 bpm.
+    duration.addBar(4, 4);
+    duration.addBar(4, 4);
+    REQUIRE(duration.getDuration().count() == doctest::Approx(4));
+
+    // A bar of 6/8 at a dotted quarter note = 60.
+    duration.setTempo(60, TempoMarker::QuarterDotted);
+    duration.addBar(6, 8);
+    REQUIRE(duration.getDuration().count() == doctest::Approx(6));
+}
+
+TEST_CASE("Formats/ScoreMetadata/FromScore")
+{
+    Score score;
+
+    Player player;
+    player.setDescription("Bass");
+    Tuning tuning;
+    tuning.setNotes({ 28, 33, 38, 43 });
+    player.setTuning(tuning);
+    score.insertPlayer(player);
+
+    System system;
+    system.insertBarline(Barline(10, Barline::SingleBar));
+    TempoMarker tempo(10);
+    tempo.setBeatsPerMinute(60);
+    system.insertTempoMarker(tempo);
+    score.insertSystem(system);
+
+    const ScoreMetadata metadata = ScoreMetadata::fromScore(score);
+    REQUIRE(metadata.myInstruments.size() == 1);
+    REQUIRE(metadata.myInstruments[0].myName == "Bass");
+    REQUIRE(metadata.myInstruments[0].myStringCount == 4);
+    REQUIRE(metadata.myBarCount == 2);
+    // One bar at 120 bpm, and then one at 60 bpm.
+    REQUIRE(metadata.myDuration);
+    REQUIRE(metadata.myDuration->count() == doctest::Approx(6));
+}
+
+TEST_CASE("Formats/ScoreMetadata/PowerTabProbe")
+{
+    PowerTabImporter importer;
+    const std::string filename =
+        AppInfo::getAbsolutePath("data/test_viewfilter.pt2");
+
+    Score score;
+    importer.load(filename, score);
+    const ScoreMetadata expected = ScoreMetadata::fromScore(score);
+
+    ScoreMetadata metadata;
+    REQUIRE_NOTHROW(metadata = importer.probe(filename));
+
+    REQUIRE(metadata.myScoreInfo == score.getScoreInfo());
+    REQUIRE(metadata.myInstruments.size() == expected.myInstruments.size());
+    for (size_t i = 0; i < metadata.myInstruments.size(); ++i)
+    {
+        REQUIRE(metadata.myInstruments[i].myName ==
+                expected.myInstruments[i].myName);
+        REQUIRE(metadata.myInstruments[i].myStringCount ==
+                expected.myInstruments[i].myStringCount);
+    }
+    REQUIRE(metadata.myBarCount == expected.myBarCount);
+    REQUIRE(metadata.myDuration);
+    REQUIRE(metadata.myDuration->count() ==
+            doctest::Approx(expected.myDuration->count()));
+}
+
+TEST_CASE("Formats/ScoreMetadata/ProbeDirectory")
+{
+    SettingsManager settings_manager;
+    FileFormatManager manager(settings_manager);
+
+    const auto results =
+        manager.probeDirectory(AppInfo::getAbsolutePath("data"));
+    REQUIRE(!results.empty());
+
+    // The results should be sorted by filename.
+    for (size_t i = 1; i < results.size(); ++i)
+        REQUIRE(results[i - 1].myFilename < results[i].myFilename);
+
+    auto it = std::find_if(results.begin(), results.end(), [](auto &&result) {
+        return result.myFilename.filename() == "score_info.gp";
+    });
+    REQUIRE(it != results.end());
+    REQUIRE(it->myMetadata);
+    REQUIRE(it->myMetadata->myScoreInfo.getSongData().getTitle() ==
+            "The title");
+}
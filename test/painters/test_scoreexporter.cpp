@@ -0,0 +1,137 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <doctest/doctest.h>
+
+#include <app/viewoptions.h>
+#include <painters/scoreexporter.h>
+#include <QFileInfo>
+#include <QGraphicsRectItem>
+#include <QImage>
+#include <QPageLayout>
+#include <QPageSize>
+#include <memory>
+#include <QTemporaryDir>
+#include <score/score.h>
+
+namespace
+{
+/// Creates a block with the given size, stacked below the previous block.
+std::unique_ptr<QGraphicsRectItem> makeItem(double y, double width,
+                                            double height)
+{
+    auto item = std::make_unique<QGraphicsRectItem>(0, 0, width, height);
+    // Don't include the pen in the bounding rectangle.
+    item->setPen(Qt::NoPen);
+    item->setPos(0, y);
+    return item;
+}
+} // namespace
+
+TEST_CASE("Painters/ScoreExporter/Paginate")
+{
+    SUBCASE("No items")
+    {
+        auto pages = paginate({}, QSizeF(100, 100));
+        REQUIRE(pages.size() == 1);
+        REQUIRE(pages[0].empty());
+    }
+
+    SUBCASE("Scaling and spacing")
+    {
+        auto first = makeItem(0, 200, 100);
+        auto second = makeItem(150, 200, 100);
+
+        // The items are scaled to half their size to fit the page's width,
+        // and the spacing between them is scaled too.
+        auto pages =
+            paginate({ first.get(), second.get() }, QSizeF(100, 200));
+        REQUIRE(pages.size() == 1);
+        REQUIRE(pages[0].size() == 2);
+
+        REQUIRE(pages[0][0].myItem == first.get());
+        REQUIRE(pages[0][0].mySource == QRectF(0, 0, 200, 100));
+        REQUIRE(pages[0][0].myTarget == QRectF(0, 0, 100, 50));
+
+        REQUIRE(pages[0][1].myItem == second.get());
+        REQUIRE(pages[0][1].mySource == QRectF(0, 150, 200, 100));
+        REQUIRE(pages[0][1].myTarget == QRectF(0, 75, 100, 50));
+    }
+
+    SUBCASE("Page breaks")
+    {
+        auto first = makeItem(0, 200, 80);
+        auto second = makeItem(150, 200, 80);
+        auto third = makeItem(250, 200, 80);
+
+        auto pages = paginate({ first.get(), second.get(), third.get() },
+                              QSizeF(100, 100));
+        REQUIRE(pages.size() == 2);
+        REQUIRE(pages[0].size() == 1);
+        REQUIRE(pages[1].size() == 2);
+
+        // The new page starts at the top, and the following items keep their
+        // spacing.
+        REQUIRE(pages[1][0].myItem == second.get());
+        REQUIRE(pages[1][0].myTarget == QRectF(0, 0, 100, 40));
+        REQUIRE(pages[1][1].myTarget == QRectF(0, 50, 100, 40));
+    }
+
+    SUBCASE("Item taller than the page")
+    {
+        auto item = makeItem(0, 100, 400);
+
+        // The item is scaled to fit the page's height instead.
+        auto pages = paginate({ item.get() }, QSizeF(100, 100));
+        REQUIRE(pages.size() == 1);
+        REQUIRE(pages[0][0].myTarget == QRectF(0, 0, 25, 100));
+    }
+}
+
+TEST_CASE("Painters/ScoreExporter/ExportPng")
+{
+    Score score;
+    System system;
+    system.insertStaff(Staff(6));
+    for (int i = 0; i < 30; ++i)
+        score.insertSystem(system);
+
+    const QPageLayout page_layout(
+        QPageSize(QPageSize::Letter), QPageLayout::Portrait,
+        QMarginsF(15, 15, 15, 15), QPageLayout::Millimeter);
+    const ScoreExporter exporter(score, ViewOptions(), page_layout);
+    // The systems don't fit on a single page.
+    REQUIRE(exporter.getPageCount() > 1);
+
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString base_name = dir.filePath("score");
+    const int width = 400;
+    REQUIRE_NOTHROW(exporter.exportPng(base_name, width, 2));
+
+    for (int page = 1; page <= exporter.getPageCount(); ++page)
+    {
+        QImage image(ScoreExporter::getPageFilename(base_name, page, "png"));
+        REQUIRE(!image.isNull());
+        REQUIRE(image.width() == width);
+        REQUIRE(image.height() > width);
+    }
+
+    const QString extra_page = ScoreExporter::getPageFilename(
+        base_name, exporter.getPageCount() + 1, "png");
+    REQUIRE(!QFileInfo::exists(extra_page));
+}
@@ -0,0 +1,136 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <painters/verticallayout.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+/// The original implementation of VerticalLayout, which stored the height at
+/// every position in a dense array.
+class DenseLayout
+{
+public:
+    int addBox(int left, int right, int height)
+    {
+        myHeights.resize(std::max<size_t>(myHeights.size(), right + 1));
+        // An empty range stacks on top of the height at that position.
+        const int newHeight =
+            (right > left ? *std::max_element(myHeights.begin() + left,
+                                              myHeights.begin() + right)
+                          : myHeights[left]) +
+            height;
+        std::fill_n(myHeights.begin() + left, right - left, newHeight);
+        return newHeight;
+    }
+
+private:
+    std::vector<int> myHeights;
+};
+} // namespace
+
+TEST_CASE("Painters/VerticalLayout/Stacking")
+{
+    VerticalLayout layout;
+
+    REQUIRE(layout.addBox(0, 4, 5) == 5);
+    REQUIRE(layout.addBox(2, 6, 3) == 8);
+    // Adjacent boxes don't overlap.
+    REQUIRE(layout.addBox(6, 8, 2) == 2);
+    REQUIRE(layout.addBox(0, 2, 1) == 6);
+    REQUIRE(layout.addBox(0, 8, 1) == 9);
+}
+
+TEST_CASE("Painters/VerticalLayout/EmptyRange")
+{
+    VerticalLayout layout;
+
+    // An empty range uses the height at its position, but doesn't raise it.
+    REQUIRE(layout.addBox(3, 3, 2) == 2);
+    REQUIRE(layout.addBox(3, 4, 1) == 1);
+    REQUIRE(layout.addBox(3, 3, 2) == 3);
+    REQUIRE(layout.addBox(4, 4, 2) == 2);
+}
+
+TEST_CASE("Painters/VerticalLayout/Edges")
+{
+    VerticalLayout layout;
+
+    // Boxes at the first and last positions of the dense layout.
+    REQUIRE(layout.addBox(0, 1, 2) == 2);
+    REQUIRE(layout.addBox(1022, 1023, 3) == 3);
+    REQUIRE(layout.addBox(0, 1023, 1) == 4);
+    REQUIRE(layout.addBox(1023, 1023, 1) == 1);
+
+    // Switching to the tree keeps the heights, including the last position.
+    REQUIRE(layout.addBox(1024, 1024, 1) == 1);
+    REQUIRE(layout.addBox(1022, 1022, 1) == 5);
+    REQUIRE(layout.addBox(1022, 1025, 1) == 5);
+    REQUIRE(layout.addBox(2047, 2048, 1) == 1);
+}
+
+TEST_CASE("Painters/VerticalLayout/Growth")
+{
+    VerticalLayout layout;
+
+    REQUIRE(layout.addBox(10, 20, 2) == 2);
+    REQUIRE(layout.addBox(0, 31, 3) == 5);
+
+    // Growing the tree should keep the existing heights.
+    REQUIRE(layout.addBox(30, 100, 1) == 6);
+    REQUIRE(layout.addBox(15, 16, 1) == 6);
+    REQUIRE(layout.addBox(0, 1, 1) == 6);
+    REQUIRE(layout.addBox(99, 1000, 1) == 7);
+    REQUIRE(layout.addBox(500, 501, 1) == 8);
+    REQUIRE(layout.addBox(1000, 1001, 1) == 1);
+
+    // Growing past the dense layout should keep the existing heights.
+    REQUIRE(layout.addBox(5000, 5001, 1) == 1);
+    REQUIRE(layout.addBox(500, 501, 1) == 9);
+    REQUIRE(layout.addBox(0, 5001, 1) == 10);
+    REQUIRE(layout.addBox(10000, 10000, 1) == 1);
+}
+
+TEST_CASE("Painters/VerticalLayout/MatchesDenseLayout")
+{
+    std::mt19937 generator(42);
+
+    for (int max_position : { 8, 31, 32, 33, 100, 500, 1023, 1024, 3000 })
+    {
+        VerticalLayout layout;
+        DenseLayout expected;
+
+        std::uniform_int_distribution<int> position_dist(0, max_position);
+        std::uniform_int_distribution<int> height_dist(0, 5);
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            int left = position_dist(generator);
+            int right = position_dist(generator);
+            if (right < left)
+                std::swap(left, right);
+            const int height = height_dist(generator);
+
+            REQUIRE(layout.addBox(left, right, height) ==
+                    expected.addBox(left, right, height));
+        }
+    }
+}
@@ -80,6 +80,72 @@ TEST_CASE("Score/Score/ViewFilters")
     REQUIRE(score.getViewFilters()[0] == filter1);
 }
 
+TEST_CASE("Score/Score/Clone")
+{
+    Score score;
+    score.insertSystem(System());
+    score.insertPlayer(Player());
+
+    Score copy = score.clone();
+    REQUIRE(copy == score);
+
+    // The copy should be unaffected by further edits to the original score.
+    score.removeSystem(0);
+    REQUIRE(copy.getSystems().size() == 1);
+    REQUIRE(score.getSystems().size() == 0);
+}
+
+TEST_CASE("Score/Score/CopyChangesFrom")
+{
+    // Create systems that can be told apart by their number of strings.
+    auto makeSystem = [](int num_strings) {
+        System system;
+        system.insertStaff(Staff(num_strings));
+        return system;
+    };
+
+    Score score;
+    for (int i = 4; i < 8; ++i)
+        score.insertSystem(makeSystem(i));
+
+    Score snapshot;
+    snapshot.copyChangesFrom(score);
+    REQUIRE(snapshot == score);
+
+    SUBCASE("Insert system")
+    {
+        score.insertSystem(makeSystem(8), 0);
+        score.insertSystem(makeSystem(9), 3);
+    }
+
+    SUBCASE("Remove system")
+    {
+        score.removeSystem(1);
+        score.removeSystem(2);
+    }
+
+    SUBCASE("Modify system")
+    {
+        score.getSystems()[2].insertStaff(Staff(5));
+    }
+
+    SUBCASE("Remove all systems")
+    {
+        while (!score.getSystems().empty())
+            score.removeSystem(0);
+    }
+
+    SUBCASE("Other changes")
+    {
+        score.insertPlayer(Player());
+        score.insertInstrument(Instrument());
+        score.setLineSpacing(12);
+    }
+
+    snapshot.copyChangesFrom(score);
+    REQUIRE(snapshot == score);
+}
+
 // Verify that we don't rely on the order of JSON keys (see bug #294).
 TEST_CASE("Score/Score/Deserialization")
 {
@@ -17,6 +17,7 @@
   
 #include <doctest/doctest.h>
 
+#include <score/serialization.h>
 #include <score/system.h>
 
 TEST_CASE("Score/System/Staves")
@@ -203,3 +204,62 @@ TEST_CASE("Score/System/TextItems")
     REQUIRE(system.getTextItems().size() == 1);
     REQUIRE(system.getTextItems()[0] == text1);
 }
+
+TEST_CASE("Score/System/ContentHash")
+{
+    System system;
+    system.insertStaff(Staff(6));
+    const size_t original_hash = ScoreUtils::hash(system);
+
+    System copy(system);
+    REQUIRE(ScoreUtils::hash(copy) == original_hash);
+
+    SUBCASE("Barlines")
+    {
+        copy.insertBarline(Barline(3, Barline::SingleBar));
+        REQUIRE(ScoreUtils::hash(copy) != original_hash);
+    }
+
+    SUBCASE("Notes")
+    {
+        Position pos(1);
+        pos.insertNote(Note(2, 5));
+        copy.getStaves()[0].getVoices()[0].insertPosition(pos);
+        const size_t new_hash = ScoreUtils::hash(copy);
+        REQUIRE(new_hash != original_hash);
+
+        copy.getStaves()[0].getVoices()[0].getPositions()[0].getNotes()[0]
+            .setFretNumber(6);
+        REQUIRE(ScoreUtils::hash(copy) != new_hash);
+    }
+
+    SUBCASE("Text Items")
+    {
+        copy.insertTextItem(TextItem(3, "foo"));
+        REQUIRE(ScoreUtils::hash(copy) != original_hash);
+    }
+}
+
+TEST_CASE("Score/System/ContentDigest")
+{
+    System system;
+    system.insertStaff(Staff(6));
+    const ScoreUtils::Digest original = ScoreUtils::digest(system);
+    REQUIRE(original.myHash == ScoreUtils::hash(system));
+
+    System copy(system);
+    REQUIRE(ScoreUtils::digest(copy) == original);
+
+    Position pos(1);
+    pos.insertNote(Note(2, 5));
+    copy.getStaves()[0].getVoices()[0].insertPosition(pos);
+    const ScoreUtils::Digest new_digest = ScoreUtils::digest(copy);
+    REQUIRE(new_digest != original);
+    REQUIRE(new_digest.myCheck != original.myCheck);
+    REQUIRE(new_digest.mySize > original.mySize);
+
+    // Changing a value without adding any values changes the second hash.
+    copy.getStaves()[0].getVoices()[0].getPositions()[0].getNotes()[0]
+        .setFretNumber(6);
+    REQUIRE(ScoreUtils::digest(copy).myCheck != new_digest.myCheck);
+}
@@ -17,13 +17,17 @@
 
 #define DOCTEST_CONFIG_IMPLEMENT
 #include <doctest/doctest.h>
-#include <QCoreApplication>
+#include <QApplication>
 
 int main(int argc, char *argv[])
 {
-    // Initialize QCoreApplication for any tests that use
-    // QCoreApplication::applicationDirPath().
-    QCoreApplication app(argc, argv);
+    // Initialize a QApplication for any tests that use
+    // QCoreApplication::applicationDirPath(), or that draw the score. Use the
+    // offscreen platform so that a display isn't required.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
 
     return doctest::Context(argc, argv).run();
 }
@@ -0,0 +1,109 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <doctest/doctest.h>
+
+#include <util/displacements.h>
+#include <vector>
+
+TEST_CASE("Util/Displacements/Shift")
+{
+    Util::Displacements<double> displacements(10);
+    REQUIRE(displacements.empty());
+
+    displacements.shift(4, 10);
+    REQUIRE(!displacements.empty());
+    REQUIRE(displacements.get(3) == 0);
+    REQUIRE(displacements.get(4) == 10);
+    REQUIRE(displacements.get(9) == 10);
+
+    displacements.shift(6, -15);
+    REQUIRE(displacements.get(5) == 10);
+    REQUIRE(displacements.get(6) == -5);
+
+    SUBCASE("Reset")
+    {
+        displacements.reset(5);
+        REQUIRE(displacements.get(4) == 10);
+        REQUIRE(displacements.get(5) == 0);
+        REQUIRE(displacements.get(6) == -5);
+
+        displacements.reset(4);
+        for (int i = 6; i < 10; ++i)
+            displacements.reset(i);
+        REQUIRE(displacements.empty());
+    }
+
+    SUBCASE("Cancel")
+    {
+        displacements.shift(4, -10);
+        REQUIRE(displacements.get(5) == 0);
+        REQUIRE(displacements.get(6) == -15);
+
+        displacements.shift(6, 15);
+        REQUIRE(displacements.empty());
+    }
+
+    SUBCASE("Out of range")
+    {
+        displacements.shift(10, 5);
+        displacements.reset(10);
+        REQUIRE(displacements.get(9) == -5);
+    }
+}
+
+TEST_CASE("Util/Displacements/FindOverlapping")
+{
+    // A long list of items, which were all moved down after the first item
+    // grew.
+    const size_t num_items = 10000;
+    Util::FenwickTree<double> sizes(std::vector<double>(num_items, 100));
+    Util::Displacements<double> displacements(num_items);
+    displacements.shift(1, 50);
+
+    auto find = [&](double top, double bottom) {
+        std::vector<size_t> items;
+        displacements.findOverlapping(
+            sizes, top, bottom, [&](size_t i) { items.push_back(i); });
+        return items;
+    };
+
+    // Only the items that are currently within the range are visited, rather
+    // than every displaced item.
+    REQUIRE(find(0, 0).empty());
+    REQUIRE(find(500, 699) == std::vector<size_t>{ 5, 6, 7 });
+    REQUIRE(find(550, 649) == std::vector<size_t>{ 6 });
+
+    // Items that have been moved are skipped.
+    displacements.reset(6);
+    REQUIRE(find(500, 699) == std::vector<size_t>{ 5, 7 });
+
+    // Each run is searched separately.
+    displacements.shift(7, 250);
+    REQUIRE(find(500, 699) == std::vector<size_t>{ 5, 8, 9 });
+
+    REQUIRE(find(999500, 999650) == std::vector<size_t>{ 9998, 9999 });
+    REQUIRE(find(999800, 1000000).empty());
+}
+
+TEST_CASE("Util/Displacements/Empty")
+{
+    Util::Displacements<double> displacements;
+    REQUIRE(displacements.empty());
+    displacements.shift(0, 10);
+    REQUIRE(displacements.empty());
+}
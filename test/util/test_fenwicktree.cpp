@@ -0,0 +1,62 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <doctest/doctest.h>
+
+#include <util/fenwicktree.h>
+
+TEST_CASE("Util/FenwickTree/PrefixSums")
+{
+    Util::FenwickTree<double> tree({ 10, 20, 30, 40, 50 });
+
+    REQUIRE(tree.size() == 5);
+    REQUIRE(tree.getPrefixSum(0) == 0);
+    REQUIRE(tree.getPrefixSum(1) == 10);
+    REQUIRE(tree.getPrefixSum(3) == 60);
+    REQUIRE(tree.getTotal() == 150);
+
+    SUBCASE("Update")
+    {
+        tree.set(1, 5);
+        REQUIRE(tree.get(1) == 5);
+        REQUIRE(tree.getPrefixSum(1) == 10);
+        REQUIRE(tree.getPrefixSum(2) == 15);
+        REQUIRE(tree.getPrefixSum(4) == 85);
+        REQUIRE(tree.getTotal() == 135);
+    }
+
+    SUBCASE("Find")
+    {
+        REQUIRE(tree.find(0) == 0);
+        REQUIRE(tree.find(9.5) == 0);
+        REQUIRE(tree.find(10) == 1);
+        REQUIRE(tree.find(59) == 2);
+        REQUIRE(tree.find(60) == 3);
+        REQUIRE(tree.find(149) == 4);
+        REQUIRE(tree.find(150) == 5);
+        REQUIRE(tree.find(1000) == 5);
+    }
+}
+
+TEST_CASE("Util/FenwickTree/Empty")
+{
+    Util::FenwickTree<int> tree;
+
+    REQUIRE(tree.size() == 0);
+    REQUIRE(tree.getTotal() == 0);
+    REQUIRE(tree.find(10) == 0);
+}
@@ -0,0 +1,75 @@
+/*
+  * Copyright (C) 2020 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <util/parallel.h>
+#include <vector>
+
+TEST_CASE("Util/ParallelFor/Basic")
+{
+    std::vector<int> values(100, 0);
+    Util::parallelFor(values.size(), [&](size_t i) { values[i] = int(i); },
+                      4);
+
+    for (size_t i = 0; i < values.size(); ++i)
+        REQUIRE(values[i] == int(i));
+}
+
+TEST_CASE("Util/ParallelFor/Exception")
+{
+    REQUIRE_THROWS_AS(Util::parallelFor(10,
+                                        [](size_t i) {
+                                            if (i == 5)
+                                                throw std::runtime_error("");
+                                        },
+                                        4),
+                      std::runtime_error);
+}
+
+TEST_CASE("Util/ParallelFor/Nested")
+{
+    REQUIRE(!Util::isParallelWorker());
+
+    // The inner loops should run on the outer loop's worker threads.
+    std::atomic<int> num_mismatches(0);
+    std::atomic<int> num_calls(0);
+    Util::parallelFor(
+        4,
+        [&](size_t) {
+            if (!Util::isParallelWorker())
+                ++num_mismatches;
+
+            const std::thread::id outer_id = std::this_thread::get_id();
+            Util::parallelFor(
+                8,
+                [&](size_t) {
+                    if (std::this_thread::get_id() != outer_id)
+                        ++num_mismatches;
+                    ++num_calls;
+                },
+                4);
+        },
+        4);
+
+    REQUIRE(num_mismatches == 0);
+    REQUIRE(num_calls == 32);
+    REQUIRE(!Util::isParallelWorker());
+}